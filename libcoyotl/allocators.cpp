@@ -0,0 +1,224 @@
+//---------------------------------------------------------------------
+//  Algorithmic Conjurings @ http://www.coyotegulch.com
+//
+//  allocators.cpp (libcoyotl)
+//
+//  Storage policies for libcoyotl containers: plain new[], aligned,
+//  huge-page and monotonic arena allocation.
+//---------------------------------------------------------------------
+//
+//  Copyright 1990-2005 Scott Robert Ladd
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the
+//      Free Software Foundation, Inc.
+//      59 Temple Place - Suite 330
+//      Boston, MA 02111-1307, USA.
+//
+//-----------------------------------------------------------------------
+//
+//  For more information on this software package, please visit
+//  Scott's web site, Coyote Gulch Productions, at:
+//
+//      http://www.coyotegulch.com
+//
+//-----------------------------------------------------------------------
+
+// Standard C library
+#include <cstdlib>
+#include <cstring>
+#include <sys/mman.h>
+
+// libcoyotl
+#include "allocators.h"
+
+using namespace libcoyotl;
+
+// size of a transparent huge page on x86-64 and most other 64-bit platforms
+static const size_t HUGE_PAGE_SIZE = 2097152;
+
+// round a size up to a multiple of a power of two
+static inline size_t round_up(size_t a_value, size_t a_multiple)
+{
+    return (a_value + a_multiple - 1) & ~(a_multiple - 1);
+}
+
+//--------------------------------------------------------------------------
+//  Allocate aligned raw storage
+void * libcoyotl::aligned_alloc_bytes(size_t a_bytes, size_t a_alignment)
+{
+    void * result = NULL;
+
+    // posix_memalign requires at least pointer alignment
+    if (a_alignment < sizeof(void *))
+        a_alignment = sizeof(void *);
+
+    if (posix_memalign(&result,a_alignment,a_bytes == 0 ? 1 : a_bytes) != 0)
+        throw std::bad_alloc();
+
+    return result;
+}
+
+//--------------------------------------------------------------------------
+//  Release aligned raw storage
+void libcoyotl::aligned_free_bytes(void * a_raw) throw()
+{
+    free(a_raw);
+}
+
+//--------------------------------------------------------------------------
+//  Map memory backed by huge pages
+void * libcoyotl::huge_page_alloc_bytes(size_t a_bytes)
+{
+    // the rounded length must not wrap around
+    if (a_bytes > SIZE_MAX - HUGE_PAGE_SIZE)
+        throw std::bad_alloc();
+
+    size_t length = round_up(a_bytes == 0 ? 1 : a_bytes,HUGE_PAGE_SIZE);
+
+    void * result = mmap(NULL,length,PROT_READ | PROT_WRITE,MAP_PRIVATE | MAP_ANONYMOUS,-1,0);
+
+    if (result == MAP_FAILED)
+        throw std::bad_alloc();
+
+#if defined(MADV_HUGEPAGE)
+    // only a hint; the mapping works with ordinary pages if this fails
+    madvise(result,length,MADV_HUGEPAGE);
+#endif
+
+    return result;
+}
+
+//--------------------------------------------------------------------------
+//  Unmap memory from huge_page_alloc_bytes
+void libcoyotl::huge_page_free_bytes(void * a_raw, size_t a_bytes) throw()
+{
+    if (a_raw != NULL)
+        munmap(a_raw,round_up(a_bytes == 0 ? 1 : a_bytes,HUGE_PAGE_SIZE));
+}
+
+//--------------------------------------------------------------------------
+//  Resize a huge page mapping
+void * libcoyotl::huge_page_realloc_bytes(void * a_raw, size_t a_old_bytes, size_t a_new_bytes)
+{
+    if (a_new_bytes > SIZE_MAX - HUGE_PAGE_SIZE)
+        throw std::bad_alloc();
+
+    size_t old_length = round_up(a_old_bytes == 0 ? 1 : a_old_bytes,HUGE_PAGE_SIZE);
+    size_t new_length = round_up(a_new_bytes == 0 ? 1 : a_new_bytes,HUGE_PAGE_SIZE);
+
+    if (old_length == new_length)
+        return a_raw;
+
+#if defined(MREMAP_MAYMOVE)
+    void * result = mremap(a_raw,old_length,new_length,MREMAP_MAYMOVE);
+
+    if (result == MAP_FAILED)
+        throw std::bad_alloc();
+
+#if defined(MADV_HUGEPAGE)
+    madvise(result,new_length,MADV_HUGEPAGE);
+#endif
+#else
+    void * result = huge_page_alloc_bytes(a_new_bytes);
+    memcpy(result,a_raw,(a_old_bytes < a_new_bytes) ? a_old_bytes : a_new_bytes);
+    huge_page_free_bytes(a_raw,a_old_bytes);
+#endif
+
+    return result;
+}
+
+//--------------------------------------------------------------------------
+//  Arena constructor
+monotonic_arena::monotonic_arena(size_t a_block_size)
+  : m_blocks(NULL),
+    m_current(NULL),
+    m_end(NULL),
+    m_block_size(a_block_size),
+    m_bytes_used(0)
+{
+    // nada
+}
+
+//--------------------------------------------------------------------------
+//  Arena destructor
+monotonic_arena::~monotonic_arena() throw()
+{
+    reset();
+}
+
+//--------------------------------------------------------------------------
+//  Allocate raw memory from the arena
+void * monotonic_arena::allocate(size_t a_bytes, size_t a_alignment)
+{
+    // align the current position
+    char * result = reinterpret_cast<char *>(round_up(reinterpret_cast<size_t>(m_current),a_alignment));
+
+    if ((m_current == NULL) || (result > m_end) || (a_bytes > size_t(m_end - result)))
+    {
+        // start a new block large enough for this request
+        size_t header = round_up(sizeof(block),a_alignment);
+
+        if (a_bytes > SIZE_MAX - header)
+            throw std::bad_alloc();
+
+        size_t size = header + a_bytes;
+
+        if (size < m_block_size)
+            size = m_block_size;
+
+        size_t block_align = (a_alignment < sizeof(void *)) ? sizeof(void *) : a_alignment;
+        block * new_block = static_cast<block *>(aligned_alloc_bytes(size,block_align));
+
+        new_block->m_next = m_blocks;
+        m_blocks = new_block;
+
+        result = reinterpret_cast<char *>(new_block) + header;
+        m_end  = reinterpret_cast<char *>(new_block) + size;
+    }
+
+    m_current = result + a_bytes;
+    m_bytes_used += a_bytes;
+
+    return result;
+}
+
+//--------------------------------------------------------------------------
+//  Grow the most recent allocation in place
+bool monotonic_arena::extend(void * a_raw, size_t a_old_bytes, size_t a_new_bytes) throw()
+{
+    char * start = static_cast<char *>(a_raw);
+
+    if ((start + a_old_bytes != m_current) || (a_new_bytes > size_t(m_end - start)))
+        return false;
+
+    m_current = start + a_new_bytes;
+    m_bytes_used += a_new_bytes - a_old_bytes;
+    return true;
+}
+
+//--------------------------------------------------------------------------
+//  Release all memory
+void monotonic_arena::reset() throw()
+{
+    while (m_blocks != NULL)
+    {
+        block * next = m_blocks->m_next;
+        aligned_free_bytes(m_blocks);
+        m_blocks = next;
+    }
+
+    m_current    = NULL;
+    m_end        = NULL;
+    m_bytes_used = 0;
+}
@@ -0,0 +1,469 @@
+//---------------------------------------------------------------------
+//  Algorithmic Conjurings @ http://www.coyotegulch.com
+//
+//  allocators.h (libcoyotl)
+//
+//  Storage policies for libcoyotl containers: plain new[], aligned,
+//  huge-page and monotonic arena allocation.
+//---------------------------------------------------------------------
+//
+//  Copyright 1990-2005 Scott Robert Ladd
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the
+//      Free Software Foundation, Inc.
+//      59 Temple Place - Suite 330
+//      Boston, MA 02111-1307, USA.
+//
+//-----------------------------------------------------------------------
+//
+//  For more information on this software package, please visit
+//  Scott's web site, Coyote Gulch Productions, at:
+//
+//      http://www.coyotegulch.com
+//
+//-----------------------------------------------------------------------
+
+#if !defined(LIBCOYOTL_ALLOCATORS_H)
+#define LIBCOYOTL_ALLOCATORS_H
+
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <stdint.h>
+
+namespace libcoyotl
+{
+    //--------------------------------------------------
+    // An allocator provides three member templates:
+    //
+    //     template <typename Type> Type * allocate(size_t n);
+    //     template <typename Type> void deallocate(Type * p, size_t n);
+    //     template <typename Type> Type * reallocate(Type * p, size_t n, size_t m);
+    //
+    // allocate returns n default-initialized elements, just as new Type[n]
+    // does; deallocate destroys the elements and releases their storage,
+    // and must accept a NULL pointer. reallocate is only used for trivial
+    // types: it resizes a block of n elements to m, extending it in place
+    // when it can, and otherwise moving the contents bitwise. Allocators are
+    // copied along with the containers that use them.
+
+    //! Size in bytes of an array of elements
+    /*!
+        Computes <i>a_length * sizeof(Type)</i>, throwing
+        <i>std::bad_alloc</i> when the product does not fit in a size_t.
+        \param a_length - Number of elements
+        \return Number of bytes
+    */
+    template <typename Type>
+    size_t element_bytes(size_t a_length)
+    {
+        if (a_length > SIZE_MAX / sizeof(Type))
+            throw std::bad_alloc();
+
+        return a_length * sizeof(Type);
+    }
+
+    //! Destroys elements in reverse order of construction
+    /*!
+        Calls the destructor of each element in a range, last to first.
+        \param a_first - First element
+        \param a_length - Number of elements
+    */
+    template <typename Type>
+    void destroy_elements(Type * a_first, size_t a_length)
+    {
+        while (a_length > 0)
+        {
+            --a_length;
+            a_first[a_length].~Type();
+        }
+    }
+
+    //! Default-initializes elements in raw storage
+    /*!
+        Constructs <i>a_length</i> elements in uninitialized storage, as
+        <i>new Type[n]</i> would. If a constructor throws, the elements
+        already built are destroyed before the exception propagates.
+        \param a_raw - Suitably sized and aligned raw storage
+        \param a_length - Number of elements
+        \return Pointer to the first element
+    */
+    template <typename Type>
+    Type * construct_elements(void * a_raw, size_t a_length)
+    {
+        Type * first = static_cast<Type *>(a_raw);
+        size_t n = 0;
+
+        try
+        {
+            for ( ; n < a_length; ++n)
+                new (static_cast<void *>(first + n)) Type;
+        }
+        catch (...)
+        {
+            destroy_elements(first,n);
+            throw;
+        }
+
+        return first;
+    }
+
+    //! Resizes a block of trivial elements by allocating and copying
+    /*!
+        The general case of <i>reallocate</i>, for allocators that cannot
+        resize in place: allocates <i>a_new_length</i> elements, copies the
+        common prefix bitwise, and releases the old block.
+        \param a_allocator - The allocator owning the block
+        \param a_elements - Existing block, or NULL
+        \param a_old_length - Number of elements in the existing block
+        \param a_new_length - Number of elements required
+        \return The new block
+    */
+    template <typename Type, typename Allocator>
+    Type * relocate_elements(Allocator & a_allocator, Type * a_elements, size_t a_old_length, size_t a_new_length)
+    {
+        Type * result = a_allocator.template allocate<Type>(a_new_length);
+
+        if (a_elements != NULL)
+        {
+            size_t count = (a_old_length < a_new_length) ? a_old_length : a_new_length;
+            memcpy(static_cast<void *>(result),a_elements,count * sizeof(Type));
+            a_allocator.deallocate(a_elements,a_old_length);
+        }
+
+        return result;
+    }
+
+    //! The default allocator, using new[] and delete[]
+    /*!
+        Allocates elements exactly as libcoyotl containers always have.
+    */
+    class new_allocator
+    {
+    public:
+        //! Allocate elements
+        template <typename Type>
+        Type * allocate(size_t a_length)
+        {
+            return new Type [a_length];
+        }
+
+        //! Destroy and release elements
+        template <typename Type>
+        void deallocate(Type * a_elements, size_t) throw()
+        {
+            delete [] a_elements;
+        }
+
+        //! Resize a block of trivial elements
+        template <typename Type>
+        Type * reallocate(Type * a_elements, size_t a_old_length, size_t a_new_length)
+        {
+            return relocate_elements(*this,a_elements,a_old_length,a_new_length);
+        }
+    };
+
+    //! Allocates raw storage with a given alignment
+    /*!
+        Returns memory aligned to <i>a_alignment</i> bytes, a power of two;
+        throws <i>std::bad_alloc</i> on failure.
+        \param a_bytes - Number of bytes
+        \param a_alignment - Required alignment
+        \return Pointer to aligned storage
+    */
+    void * aligned_alloc_bytes(size_t a_bytes, size_t a_alignment);
+
+    //! Releases storage from <i>aligned_alloc_bytes</i>
+    void aligned_free_bytes(void * a_raw) throw();
+
+    //! Allocator returning aligned storage
+    /*!
+        Aligns the first element on an <i>Alignment</i>-byte boundary (a cache
+        line, by default), allowing vector kernels to use aligned loads and
+        keeping arrays from sharing cache lines.
+    */
+    template <size_t Alignment = 64>
+    class aligned_allocator
+    {
+    public:
+        //! Alignment of the first element, in bytes
+        static const size_t alignment = Alignment;
+
+        //! Allocate elements
+        template <typename Type>
+        Type * allocate(size_t a_length)
+        {
+            if (a_length == 0)
+                return NULL;
+
+            size_t align = (Alignment < alignof(Type)) ? alignof(Type) : Alignment;
+            void * raw = aligned_alloc_bytes(element_bytes<Type>(a_length),align);
+
+            try
+            {
+                return construct_elements<Type>(raw,a_length);
+            }
+            catch (...)
+            {
+                aligned_free_bytes(raw);
+                throw;
+            }
+        }
+
+        //! Destroy and release elements
+        template <typename Type>
+        void deallocate(Type * a_elements, size_t a_length) throw()
+        {
+            if (a_elements != NULL)
+            {
+                destroy_elements(a_elements,a_length);
+                aligned_free_bytes(a_elements);
+            }
+        }
+
+        //! Resize a block of trivial elements
+        template <typename Type>
+        Type * reallocate(Type * a_elements, size_t a_old_length, size_t a_new_length)
+        {
+            // realloc would not preserve the alignment
+            return relocate_elements(*this,a_elements,a_old_length,a_new_length);
+        }
+    };
+
+    //! Maps anonymous memory backed by huge pages, where available
+    /*!
+        Rounds the request up to a multiple of the huge page size (2 MB),
+        maps it, and advises the kernel to back it with transparent huge
+        pages. Throws <i>std::bad_alloc</i> on failure.
+        \param a_bytes - Number of bytes
+        \return Pointer to page-aligned storage
+    */
+    void * huge_page_alloc_bytes(size_t a_bytes);
+
+    //! Releases storage from <i>huge_page_alloc_bytes</i>
+    void huge_page_free_bytes(void * a_raw, size_t a_bytes) throw();
+
+    //! Resizes storage from <i>huge_page_alloc_bytes</i>
+    /*!
+        Grows or shrinks a mapping, in place when the rounded size does not
+        change and otherwise by remapping its pages (on Linux), so contents
+        are never copied. Throws <i>std::bad_alloc</i> on failure.
+        \param a_raw - Existing mapping
+        \param a_old_bytes - Size originally requested for the mapping
+        \param a_new_bytes - Size now required
+        \return Pointer to the (possibly moved) mapping
+    */
+    void * huge_page_realloc_bytes(void * a_raw, size_t a_old_bytes, size_t a_new_bytes);
+
+    //! Allocator for large arrays, backed by huge pages
+    /*!
+        Large arrays that are scanned repeatedly incur far fewer TLB misses
+        on 2 MB pages. Every allocation consumes at least one huge page, so
+        this allocator is only appropriate for big arrays.
+    */
+    class huge_page_allocator
+    {
+    public:
+        //! Allocate elements
+        template <typename Type>
+        Type * allocate(size_t a_length)
+        {
+            if (a_length == 0)
+                return NULL;
+
+            void * raw = huge_page_alloc_bytes(element_bytes<Type>(a_length));
+
+            try
+            {
+                return construct_elements<Type>(raw,a_length);
+            }
+            catch (...)
+            {
+                huge_page_free_bytes(raw,a_length * sizeof(Type));
+                throw;
+            }
+        }
+
+        //! Destroy and release elements
+        template <typename Type>
+        void deallocate(Type * a_elements, size_t a_length) throw()
+        {
+            if (a_elements != NULL)
+            {
+                destroy_elements(a_elements,a_length);
+                huge_page_free_bytes(a_elements,a_length * sizeof(Type));
+            }
+        }
+
+        //! Resize a block of trivial elements
+        template <typename Type>
+        Type * reallocate(Type * a_elements, size_t a_old_length, size_t a_new_length)
+        {
+            if (a_elements == NULL)
+                return allocate<Type>(a_new_length);
+
+            return static_cast<Type *>(huge_page_realloc_bytes(a_elements,a_old_length * sizeof(Type),element_bytes<Type>(a_new_length)));
+        }
+    };
+
+    //! A monotonic memory arena
+    /*!
+        Hands out memory by advancing a pointer through large blocks,
+        allocating a new block only when the current one is exhausted.
+        Individual allocations are never freed; all memory is returned at
+        once by <i>reset</i> or by destroying the arena. Thousands of small
+        arrays can thus share a handful of system allocations.
+    */
+    class monotonic_arena
+    {
+    public:
+        //! Constructor
+        /*!
+            Creates an empty arena; no memory is allocated until first use.
+            \param a_block_size - Minimum size of each block obtained from the system
+        */
+        monotonic_arena(size_t a_block_size = 1048576);
+
+        //! Destructor
+        /*!
+            Releases every block owned by the arena.
+        */
+        ~monotonic_arena() throw();
+
+        //! Allocate raw memory
+        /*!
+            Returns <i>a_bytes</i> of storage aligned to <i>a_alignment</i>
+            (a power of two). Throws <i>std::bad_alloc</i> on failure.
+            \param a_bytes - Number of bytes
+            \param a_alignment - Required alignment
+            \return Pointer to storage owned by the arena
+        */
+        void * allocate(size_t a_bytes, size_t a_alignment);
+
+        //! Grow the most recent allocation in place
+        /*!
+            If <i>a_raw</i> is the most recent allocation and its block has
+            room, extends it to <i>a_new_bytes</i>.
+            \param a_raw - Memory returned by <i>allocate</i>
+            \param a_old_bytes - Current size of the allocation
+            \param a_new_bytes - Size required
+            \return <i>true</i> if the allocation was extended
+        */
+        bool extend(void * a_raw, size_t a_old_bytes, size_t a_new_bytes) throw();
+
+        //! Release all memory
+        /*!
+            Frees every block; all memory handed out by the arena becomes
+            invalid.
+        */
+        void reset() throw();
+
+        //! Bytes handed out
+        /*!
+            Returns the number of bytes allocated since construction or the
+            last <i>reset</i>, excluding alignment padding.
+            \return Number of bytes allocated
+        */
+        size_t get_bytes_used() const
+        {
+            return m_bytes_used;
+        }
+
+    private:
+        // arenas are not copyable
+        monotonic_arena(const monotonic_arena &);
+        monotonic_arena & operator = (const monotonic_arena &);
+
+        // header at the start of each block
+        struct block
+        {
+            block * m_next;
+        };
+
+        // blocks, most recent first
+        block * m_blocks;
+
+        // free space in the current block
+        char * m_current;
+        char * m_end;
+
+        // minimum block size
+        size_t m_block_size;
+
+        // bytes handed out
+        size_t m_bytes_used;
+    };
+
+    //! Allocator drawing from a monotonic arena
+    /*!
+        Elements are destroyed when their container releases them, but the
+        memory is only reclaimed when the arena is reset or destroyed. The
+        arena must outlive every container using it.
+    */
+    class arena_allocator
+    {
+    public:
+        //! Constructor
+        /*!
+            Creates an allocator drawing from <i>a_arena</i>.
+            \param a_arena - Source of memory
+        */
+        arena_allocator(monotonic_arena & a_arena)
+          : m_arena(&a_arena)
+        {
+            // nada
+        }
+
+        //! Allocate elements
+        template <typename Type>
+        Type * allocate(size_t a_length)
+        {
+            if (a_length == 0)
+                return NULL;
+
+            return construct_elements<Type>(m_arena->allocate(element_bytes<Type>(a_length),alignof(Type)),a_length);
+        }
+
+        //! Destroy elements; memory stays with the arena
+        template <typename Type>
+        void deallocate(Type * a_elements, size_t a_length) throw()
+        {
+            if (a_elements != NULL)
+                destroy_elements(a_elements,a_length);
+        }
+
+        //! Resize a block of trivial elements, in place if it is the arena's latest
+        template <typename Type>
+        Type * reallocate(Type * a_elements, size_t a_old_length, size_t a_new_length)
+        {
+            if ((a_elements != NULL) && m_arena->extend(a_elements,a_old_length * sizeof(Type),element_bytes<Type>(a_new_length)))
+                return a_elements;
+
+            return relocate_elements(*this,a_elements,a_old_length,a_new_length);
+        }
+
+        //! Get the arena
+        monotonic_arena & get_arena() const
+        {
+            return *m_arena;
+        }
+
+    private:
+        // source of memory
+        monotonic_arena * m_arena;
+    };
+
+} // end namespace libcoyotl
+
+#endif
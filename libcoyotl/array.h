@@ -43,10 +43,14 @@
 #endif
 
 #include <cstddef>   // for size_t
-#include <algorithm> // for lexicographical_compare
+#include <type_traits> // for is_trivial
 
 #include "validator.h" // validation functions
 #include "realutil.h"  // need min_of function
+#include "allocators.h" // storage policies
+#include "array_kernels.h" // copy, fill and compare
+#include "array_view.h"    // non-owning views
+#include "array_expr.h"    // element-wise arithmetic
 
 #if defined(LIBCOYOTL_BOUNDS_CHECKING)
 #include <stdexcept>
@@ -67,8 +71,15 @@ namespace libcoyotl
         applications and largely incompatible with the STL. The std::vector
         includes dyanmic array features that simply aren't necessary for
         many applications.
+
+        Storage comes from an <i>Allocator</i> (see allocators.h); the
+        default, <i>new_allocator</i>, uses new[] and delete[].
+
+        An array may hold more storage than it has elements, so that
+        <i>append</i> can grow it geometrically in amortized constant time
+        per element; <i>capacity</i> reports the storage held.
     */
-    template <typename Type>
+    template <typename Type, typename Allocator = new_allocator>
     class array
     {
     public:
@@ -105,12 +116,16 @@ namespace libcoyotl
         //! Constant reverse iterator type
         typedef const Type * const_reverse_iterator;
 
+        //! Storage policy
+        typedef Allocator    allocator_type;
+
         //! Default constructor
         /*!
             Constructs an array with <i>a_length</i> uninitialized elements.
             /param a_length number of elements in the array
+            /param a_allocator source of storage
         */
-        array(size_t a_length);
+        array(size_t a_length, const Allocator & a_allocator = Allocator());
 
         //! Initialization constructor
         /*!
@@ -118,15 +133,26 @@ namespace libcoyotl
             given value.
             /param a_length number of elements in the array
             /param a_init_value initial value of all array elements
+            /param a_allocator source of storage
         */
-        array(size_t a_length, const Type & a_init_value);
+        array(size_t a_length, const Type & a_init_value, const Allocator & a_allocator = Allocator());
 
         //! Copy constructor
         /*!
-            Creates a new array identical to an existing one.
+            Creates a new array identical to an existing one, drawing storage
+            from a copy of the source's allocator.
             \param a_source - The a_source object
         */
-        array(const array<Type> & a_source);
+        array(const array<Type,Allocator> & a_source);
+
+        //! Move constructor
+        /*!
+            Creates a new array that takes ownership of the elements of an
+            existing array, without allocating or copying. The source is left
+            with no elements.
+            \param a_source - The source object
+        */
+        array(array<Type,Allocator> && a_source) throw();
 
         //! Create from C-style array
         /*!
@@ -134,8 +160,33 @@ namespace libcoyotl
             C-style array.
             /param a_length number of elements in the array
             /param a_carray pointer to an array of with a_length elements
+            /param a_allocator source of storage
         */
-        array(size_t a_length, const Type * a_carray);
+        array(size_t a_length, const Type * a_carray, const Allocator & a_allocator = Allocator());
+
+        //! Create from an expression
+        /*!
+            Constructs a new array holding the values of an element-wise
+            expression (see array_expr.h), computed in a single loop.
+            \param a_expr - An expression over arrays of equal, non-zero length
+            \param a_allocator - Source of storage
+        */
+        template <class Expr>
+        array(const array_expression<Expr> & a_expr, const Allocator & a_allocator = Allocator())
+          : m_array(NULL),
+            m_size(a_expr.self().size()),
+            m_capacity(0),
+            m_allocator(a_allocator)
+        {
+            // an array cannot be empty, and has no elements to give
+            // an empty expression
+            validate_not(m_size,size_t(0),LIBCOYOTL_LOCATION);
+
+            // allocate array and compute elements
+            m_capacity = m_size;
+            m_array = m_allocator.template allocate<Type>(m_capacity);
+            evaluate(m_array,m_size,a_expr);
+        }
 
         //! Virtual destructor
         /*!
@@ -147,12 +198,46 @@ namespace libcoyotl
         */
         virtual ~array() throw();
 
+        //! Adopt an existing buffer
+        /*!
+            A "named constructor" that creates an array owning an existing
+            buffer of elements, without copying them. The buffer must have been
+            obtained from <i>a_allocator</i> (with the default allocator, from
+            <i>new Type[]</i>); the array releases it when destroyed. The
+            array's capacity is <i>a_length</i>.
+            \param a_length - Number of elements in the buffer
+            \param a_buffer - Buffer of <i>a_length</i> elements
+            \param a_allocator - The allocator that provided <i>a_buffer</i>
+            \return A new array owning <i>a_buffer</i>
+        */
+        static array adopt(size_t a_length, Type * a_buffer, const Allocator & a_allocator = Allocator());
+
+        //! Release ownership of the elements
+        /*!
+            Returns the underlying buffer to the caller, who becomes responsible
+            for releasing it through the array's allocator (with the default
+            allocator, <i>delete []</i>). The buffer holds <i>capacity()</i>
+            elements, which may exceed <i>size()</i> after appending. The array
+            is left with no elements.
+            \return The buffer formerly owned by this array
+        */
+        Type * release() throw();
+
         //! Assignment operator
         /*!
             Assigns an existing object the state of another.
             \param a_source - The source object
         */
-        array & operator = (const array<Type> & a_source) throw();
+        array & operator = (const array<Type,Allocator> & a_source) throw();
+
+        //! Move assignment operator
+        /*!
+            Releases the target's elements and takes ownership of the source's
+            elements, without copying; unlike copy assignment, the target takes
+            on the length of the source. The source is left with no elements.
+            \param a_source - The source object
+        */
+        array & operator = (array<Type,Allocator> && a_source) throw();
 
         //! Assign value to all elements
         /*!
@@ -170,6 +255,28 @@ namespace libcoyotl
         */
         array & operator = (const Type * a_carray) throw();
 
+        //! Assign from an expression
+        /*!
+            Computes an element-wise expression (see array_expr.h) into the
+            array in a single fused loop, without temporaries; the array may
+            appear in the expression. Large arrays are computed in parallel.
+            \param a_expr - An expression over arrays of the target's length
+            \return A reference to the target array
+        */
+        template <class Expr>
+        array & operator = (const array_expression<Expr> & a_expr)
+        {
+            evaluate(m_array,m_size,a_expr);
+            return *this;
+        }
+
+        //! Get the allocator
+        /*!
+            Returns the allocator that provides this array's storage.
+            \return The array's allocator
+        */
+        const Allocator & get_allocator() const throw();
+
         //! Conversion to C-style array
         /*!
             Returns a pointer to the internal C-style array encapsulated by
@@ -179,6 +286,40 @@ namespace libcoyotl
         */
         const Type * c_array() const throw();
 
+        //! View of all elements
+        /*!
+            Returns a non-owning view of the array's elements, without copying
+            them. The view is invalidated when the array's storage is released
+            or reallocated (by <i>append</i> or <i>reserve</i>).
+            \return A view of all elements
+        */
+        array_view<Type> view() throw();
+
+        //! Read-only view of all elements
+        /*!
+            Returns a read-only, non-owning view of the array's elements.
+            \return A read-only view of all elements
+        */
+        array_view<const Type> view() const throw();
+
+        //! View of a subrange
+        /*!
+            Returns a non-owning view of consecutive elements of the array.
+            \param a_offset - Index of the first element in the view
+            \param a_length - Number of elements in the view
+            \return A view of the subrange
+        */
+        array_view<Type> view(size_t a_offset, size_t a_length);
+
+        //! Read-only view of a subrange
+        /*!
+            Returns a read-only, non-owning view of consecutive elements of the array.
+            \param a_offset - Index of the first element in the view
+            \param a_length - Number of elements in the view
+            \return A read-only view of the subrange
+        */
+        array_view<const Type> view(size_t a_offset, size_t a_length) const;
+
         //! Element access
         /*!
             Returns a reference to a specific element in an array.
@@ -198,10 +339,41 @@ namespace libcoyotl
         //! Appending arrays
         /*!
             Appends the <i>a_other</i> array to the target, extending the length
-            of the target by the length of <i>a_other</i>.
+            of the target by the length of <i>a_other</i>. When the capacity is
+            exhausted, it grows to at least twice its former value, so a
+            sequence of appends costs amortized constant time per element. An
+            array may be appended to itself.
             \param a_array - Array to be appended to the target
         */
-        void append(const array<Type> & a_array);
+        void append(const array<Type,Allocator> & a_array);
+
+        //! Appending an element
+        /*!
+            Appends a single value to the target, extending its length by one
+            and growing its capacity geometrically as needed.
+            \param a_value - Value to be appended to the target
+        */
+        void append(const Type & a_value);
+
+        //! Reserve storage
+        /*!
+            Ensures that the array can hold at least <i>a_capacity</i> elements
+            without reallocating. Storage for trivial element types is resized
+            in place when the allocator can do so (see <i>reallocate</i> in
+            allocators.h), and is otherwise moved bitwise; other types are
+            move-assigned into the new storage. Invalidates iterators and
+            pointers when the storage moves.
+            \param a_capacity - Number of elements required
+        */
+        void reserve(size_t a_capacity);
+
+        //! Allocated capacity
+        /*!
+            Returns the number of elements for which storage has been allocated,
+            which is never less than <i>size()</i>.
+            \return Number of elements the array can hold without reallocating
+        */
+        size_t capacity() const throw();
 
         //! Obtain beginning-of-sequence iterator
         /*!
@@ -262,11 +434,13 @@ namespace libcoyotl
         //! Equals operator
         /*!
             Compares corresponding elements of the target array to the argument array,
-            checking for equality.
+            checking for equality; arrays of different lengths are unequal.
+            Integral and pointer elements are compared with <i>memcmp</i>, and
+            floating-point elements with vectorized kernels.
             \param a_comparand - Comparand array
             \return <i>true</i> all corresponding elements are equal, <i>false</i> otherwise.
         */
-        bool operator == (const array<Type> & a_comparand) const throw();
+        bool operator == (const array<Type,Allocator> & a_comparand) const throw();
 
         //! Inequality operator
         /*!
@@ -275,16 +449,18 @@ namespace libcoyotl
             \param a_comparand - Comparand array
             \return <i>true</i> if any elements of the target are not equal to corresponding elements in the comparand; <i>false</i> otherwise.
         */
-        bool operator != (const array<Type> & a_comparand) const throw();
+        bool operator != (const array<Type,Allocator> & a_comparand) const throw();
 
         //! Less-than operator
         /*!
-            Compares corresponding elements of the target array and the comparand array,
-            checking that all target elements are less than comparand elements.
+            Compares the target array and the comparand array lexicographically:
+            the first pair of elements that differ decides, and a proper prefix
+            orders before the longer array. Elements of integral, pointer and
+            floating-point types are scanned with vectorized kernels.
             \param a_comparand - Comparand array
-            \return <i>true</i> if all elements of the target are less than corresponding elements in the comparand; <i>false</i> otherwise.
+            \return <i>true</i> if the target orders before the comparand; <i>false</i> otherwise.
         */
-        bool operator <  (const array<Type> & a_comparand) const throw();
+        bool operator <  (const array<Type,Allocator> & a_comparand) const throw();
 
         //! Less-than-or-equal-to operator
         /*!
@@ -293,7 +469,7 @@ namespace libcoyotl
             \param a_comparand - Comparand array
             \return <i>true</i> if all elements of the target are less than or equal to corresponding elements in the comparand; <i>false</i> otherwise.
         */
-        bool operator <= (const array<Type> & a_comparand) const throw();
+        bool operator <= (const array<Type,Allocator> & a_comparand) const throw();
 
         //! Greater-than operator
         /*!
@@ -302,7 +478,7 @@ namespace libcoyotl
             \param a_comparand - Comparand array
             \return <i>true</i> if all elements of the target are greater than corresponding elements in the comparand; <i>false</i> otherwise.
         */
-        bool operator >  (const array<Type> & a_comparand) const throw();
+        bool operator >  (const array<Type,Allocator> & a_comparand) const throw();
 
         //! Greater-than-or-equal-to operator
         /*!
@@ -311,15 +487,16 @@ namespace libcoyotl
             \param a_comparand - Comparand array
             \return <i>true</i> if all elements of the target are greater than or equal to corresponding elements in the comparand; <i>false</i> otherwise.
         */
-        bool operator >= (const array<Type> & a_comparand) const throw();
+        bool operator >= (const array<Type,Allocator> & a_comparand) const throw();
 
-        //! Exchanges the corresponding elements of two arrays
+        //! Exchanges the contents of two arrays
         /*!
-            Exchanges the corresponding elements of two arrays; used by various
+            Exchanges the contents of two arrays by swapping their underlying
+            buffers, so the cost does not depend on length; used by various
             Standard C++ algorithms.
             \param a_source - Another array
         */
-        void swap(array<Type> & a_source) throw();
+        void swap(array<Type,Allocator> & a_source) throw();
         
         //! Number of elements
         /*!
@@ -339,9 +516,10 @@ namespace libcoyotl
 
         //! Empty container check
         /*!
-            Always false, as an array is never "empty".
-            Required by Standard C++ algorithms and container definitions.
-            \return Always false
+            An array is only "empty" after its elements have been moved away
+            or released. Required by Standard C++ algorithms and container
+            definitions.
+            \return <i>true</i> if the array has no elements
         */
         bool empty() const throw();
 
@@ -352,7 +530,25 @@ namespace libcoyotl
         //! Length of the array
         size_t m_size;
 
+        //! Number of elements allocated
+        size_t m_capacity;
+
+        //! Source of storage
+        Allocator m_allocator;
+
     private:
+        // selects the adopting constructor
+        struct adopt_tag { };
+
+        // adopting constructor, used by adopt()
+        array(Type * a_buffer, size_t a_length, const Allocator & a_allocator, adopt_tag);
+
+        // grow storage for trivial types, using the allocator's reallocate
+        void grow(size_t a_capacity, std::true_type);
+
+        // grow storage for other types, moving elements
+        void grow(size_t a_capacity, std::false_type);
+
         // assign a single a_value to all elements
         void assign_value(const Type & a_value) throw();
 
@@ -360,104 +556,114 @@ namespace libcoyotl
         void copy_carray(const Type * a_carray) throw();
 
         // copy elements from another array
-        void copy_array(const array<Type> & a_source) throw();
+        void copy_array(const array<Type,Allocator> & a_source) throw();
     };
 
     // assign a single a_value to all elements
-    template <typename Type>
-    void array<Type>::assign_value(const Type & a_value) throw()
+    template <typename Type, typename Allocator>
+    void array<Type,Allocator>::assign_value(const Type & a_value) throw()
     {
-        Type * element_ptr = m_array;
-
-        for (size_t n = 0; n < m_size; ++n)
-        {
-            *element_ptr = a_value;
-            ++element_ptr;
-        }
+        fill_elements(m_array,m_size,a_value);
     }
 
     // copy elements from a c-style array
-    template <typename Type>
-    void array<Type>::copy_carray(const Type * a_carray) throw()
+    template <typename Type, typename Allocator>
+    void array<Type,Allocator>::copy_carray(const Type * a_carray) throw()
     {
-        // use pointers for speed
-        Type * target_ptr = m_array;
-        const Type * carray_ptr  = a_carray;
-
-        for (size_t n = 0; n < m_size; ++n)
-        {
-            *target_ptr = *carray_ptr;
-            ++target_ptr;
-            ++carray_ptr;
-        }
+        copy_elements(m_array,a_carray,m_size);
     }
 
     // copy elements from another array
-    template <typename Type>
-    void array<Type>::copy_array(const array<Type> & a_source) throw()
+    template <typename Type, typename Allocator>
+    void array<Type,Allocator>::copy_array(const array<Type,Allocator> & a_source) throw()
     {
-        // find minimum a_length between the two arrays
-        size_t copy_length = min_of(m_size,a_source.m_size);
-
-        // use pointers for speed
-        Type * target_ptr = m_array;
-        const Type * source_ptr = a_source.m_array;
-
-        for (size_t n = 0; n < copy_length; ++n)
-        {
-            *target_ptr = *source_ptr;
-            ++target_ptr;
-            ++source_ptr;
-        }
+        // copy the minimum a_length between the two arrays
+        if (this != &a_source)
+            copy_elements(m_array,a_source.m_array,min_of(m_size,a_source.m_size));
     }
 
     // default constructor
-    template <typename Type>
-    array<Type>::array(size_t a_length)
+    template <typename Type, typename Allocator>
+    array<Type,Allocator>::array(size_t a_length, const Allocator & a_allocator)
       : m_array(NULL),
-        m_size(a_length)
+        m_size(a_length),
+        m_capacity(0),
+        m_allocator(a_allocator)
     {
         // enforce lower limit on a_length
         enforce_lower_limit(m_size,size_t(1));
 
         // allocate array
-        m_array = new Type [m_size];
+        m_capacity = m_size;
+        m_array = m_allocator.template allocate<Type>(m_capacity);
     }
 
     // a_value constructor
-    template <typename Type>
-    array<Type>::array(size_t a_length, const Type & a_init_value)
+    template <typename Type, typename Allocator>
+    array<Type,Allocator>::array(size_t a_length, const Type & a_init_value, const Allocator & a_allocator)
       : m_array(NULL),
-        m_size(a_length)
+        m_size(a_length),
+        m_capacity(0),
+        m_allocator(a_allocator)
     {
         // enforce lower limit on a_length
         enforce_lower_limit(m_size,size_t(1));
 
         // allocate array
-        m_array = new Type [m_size];
+        m_capacity = m_size;
+        m_array = m_allocator.template allocate<Type>(m_capacity);
 
         // assign values
         assign_value(a_init_value);
     }
 
     // copy constructor
-    template <typename Type>
-    array<Type>::array(const array<Type> & a_source)
+    template <typename Type, typename Allocator>
+    array<Type,Allocator>::array(const array<Type,Allocator> & a_source)
       : m_array(NULL),
-        m_size(a_source.m_size)
+        m_size(a_source.m_size),
+        m_capacity(0),
+        m_allocator(a_source.m_allocator)
     {
         // allocate array
-        m_array = new Type [m_size];
+        m_capacity = m_size;
+        m_array = m_allocator.template allocate<Type>(m_capacity);
 
         // copy a_source array
         copy_array(a_source);
     }
 
+    // move constructor
+    template <typename Type, typename Allocator>
+    array<Type,Allocator>::array(array<Type,Allocator> && a_source) throw()
+      : m_array(a_source.m_array),
+        m_size(a_source.m_size),
+        m_capacity(a_source.m_capacity),
+        m_allocator(a_source.m_allocator)
+    {
+        a_source.m_array    = NULL;
+        a_source.m_size     = 0;
+        a_source.m_capacity = 0;
+    }
+
+    // adopting constructor
+    template <typename Type, typename Allocator>
+    array<Type,Allocator>::array(Type * a_buffer, size_t a_length, const Allocator & a_allocator, adopt_tag)
+      : m_array(a_buffer),
+        m_size(a_length),
+        m_capacity(a_length),
+        m_allocator(a_allocator)
+    {
+        // nada
+    }
+
     // construct from C-style array
-    template <typename Type>
-    array<Type>::array(size_t a_length, const Type * a_carray)
+    template <typename Type, typename Allocator>
+    array<Type,Allocator>::array(size_t a_length, const Type * a_carray, const Allocator & a_allocator)
       : m_array(NULL),
-        m_size(a_length)
+        m_size(a_length),
+        m_capacity(0),
+        m_allocator(a_allocator)
     {
         // validate a_source
         validate_not(a_carray,(const Type *)NULL,LIBCOYOTL_LOCATION);
@@ -466,230 +672,346 @@ namespace libcoyotl
         enforce_lower_limit(m_size,size_t(1));
 
         // allocate array
-        m_array = new Type [m_size];
+        m_capacity = m_size;
+        m_array = m_allocator.template allocate<Type>(m_capacity);
 
         // copy elements of c array
         copy_carray(a_carray);
     }
 
     // destructor
-    template <typename Type>
-    array<Type>::~array() throw()
+    template <typename Type, typename Allocator>
+    array<Type,Allocator>::~array() throw()
     {
         // clean up resources
-        delete [] m_array;
-        m_array  = NULL;
-        m_size = 0;
+        m_allocator.deallocate(m_array,m_capacity);
+        m_array    = NULL;
+        m_size     = 0;
+        m_capacity = 0;
+    }
+
+    // adopt an existing buffer
+    template <typename Type, typename Allocator>
+    array<Type,Allocator> array<Type,Allocator>::adopt(size_t a_length, Type * a_buffer, const Allocator & a_allocator)
+    {
+        // validate buffer
+        validate_not(a_buffer,(Type *)NULL,LIBCOYOTL_LOCATION);
+
+        return array<Type,Allocator>(a_buffer,a_length,a_allocator,adopt_tag());
+    }
+
+    // release ownership of the elements
+    template <typename Type, typename Allocator>
+    Type * array<Type,Allocator>::release() throw()
+    {
+        Type * result = m_array;
+        m_array    = NULL;
+        m_size     = 0;
+        m_capacity = 0;
+        return result;
     }
 
     // assignment operator
-    template <typename Type>
-    array<Type> & array<Type>::operator = (const array<Type> & a_source) throw()
+    template <typename Type, typename Allocator>
+    array<Type,Allocator> & array<Type,Allocator>::operator = (const array<Type,Allocator> & a_source) throw()
     {
         copy_array(a_source);
         return *this;
     }
 
+    // move assignment operator
+    template <typename Type, typename Allocator>
+    array<Type,Allocator> & array<Type,Allocator>::operator = (array<Type,Allocator> && a_source) throw()
+    {
+        if (this != &a_source)
+        {
+            m_allocator.deallocate(m_array,m_capacity);
+            m_array     = a_source.m_array;
+            m_size      = a_source.m_size;
+            m_capacity  = a_source.m_capacity;
+            m_allocator = a_source.m_allocator;
+            a_source.m_array    = NULL;
+            a_source.m_size     = 0;
+            a_source.m_capacity = 0;
+        }
+
+        return *this;
+    }
+
     // assign all operator
-    template <typename Type>
-    array<Type> & array<Type>::operator = (const Type & a_value) throw()
+    template <typename Type, typename Allocator>
+    array<Type,Allocator> & array<Type,Allocator>::operator = (const Type & a_value) throw()
     {
         assign_value(a_value);
         return *this;
     }
 
     // assign from C-style array
-    template <typename Type>
-    array<Type> & array<Type>::operator = (const Type * a_source) throw()
+    template <typename Type, typename Allocator>
+    array<Type,Allocator> & array<Type,Allocator>::operator = (const Type * a_source) throw()
     {
         copy_carray(a_source);
         return *this;
     }
 
+    // get the allocator
+    template <typename Type, typename Allocator>
+    inline const Allocator & array<Type,Allocator>::get_allocator() const throw()
+    {
+        return m_allocator;
+    }
+
     // conversion to C-style array
-    template <typename Type>
-    inline const Type * array<Type>::c_array() const throw()
+    template <typename Type, typename Allocator>
+    inline const Type * array<Type,Allocator>::c_array() const throw()
     {
         return m_array;
     }
 
+    // views
+    template <typename Type, typename Allocator>
+    inline array_view<Type> array<Type,Allocator>::view() throw()
+    {
+        return array_view<Type>(m_array,m_size);
+    }
+
+    template <typename Type, typename Allocator>
+    inline array_view<const Type> array<Type,Allocator>::view() const throw()
+    {
+        return array_view<const Type>(m_array,m_size);
+    }
+
+    template <typename Type, typename Allocator>
+    inline array_view<Type> array<Type,Allocator>::view(size_t a_offset, size_t a_length)
+    {
+        return view().subview(a_offset,a_length);
+    }
+
+    template <typename Type, typename Allocator>
+    inline array_view<const Type> array<Type,Allocator>::view(size_t a_offset, size_t a_length) const
+    {
+        return view().subview(a_offset,a_length);
+    }
+
     // element access
-    template <typename Type>
-    inline Type & array<Type>::operator [] (size_t n) throw(LIBCOYOTL_ARRAY_EXCEPTIONS)
+    template <typename Type, typename Allocator>
+    inline Type & array<Type,Allocator>::operator [] (size_t n) throw(LIBCOYOTL_ARRAY_EXCEPTIONS)
     {
         LIBCOYOTL_ARRAY_CHECK_INDEX(n)
         return m_array[n];
     }
 
-    template <typename Type>
-    inline Type array<Type>::operator [] (size_t n) const throw(LIBCOYOTL_ARRAY_EXCEPTIONS)
+    template <typename Type, typename Allocator>
+    inline Type array<Type,Allocator>::operator [] (size_t n) const throw(LIBCOYOTL_ARRAY_EXCEPTIONS)
     {
         LIBCOYOTL_ARRAY_CHECK_INDEX(n)
         return m_array[n];
     }
 
-    // appending
-    template <typename Type>
-    void array<Type>::append(const array<Type> & other)
+    // grow storage for trivial types, using the allocator's reallocate
+    template <typename Type, typename Allocator>
+    void array<Type,Allocator>::grow(size_t a_capacity, std::true_type)
     {
-        size_t new_size = m_size + other.m_size;
-        Type * new_array = new Type[new_size];
+        m_array = m_allocator.reallocate(m_array,m_capacity,a_capacity);
+        m_capacity = a_capacity;
+    }
+
+    // grow storage for other types, moving elements
+    template <typename Type, typename Allocator>
+    void array<Type,Allocator>::grow(size_t a_capacity, std::false_type)
+    {
+        Type * new_array = m_allocator.template allocate<Type>(a_capacity);
 
         Type * target = new_array;
-        Type * a_source = m_array;
-        size_t n;
+        Type * source = m_array;
 
-        // copy from this array
-        for (n = 0; n < m_size; ++n)
+        for (size_t n = 0; n < m_size; ++n)
         {
-            *target = *a_source;
+            *target = static_cast<Type &&>(*source);
             ++target;
-            ++a_source;
+            ++source;
         }
 
-        // copy from other array
-        a_source = other.m_array;
+        m_allocator.deallocate(m_array,m_capacity);
+        m_array    = new_array;
+        m_capacity = a_capacity;
+    }
+
+    // reserve storage
+    template <typename Type, typename Allocator>
+    void array<Type,Allocator>::reserve(size_t a_capacity)
+    {
+        if (a_capacity > m_capacity)
+            grow(a_capacity,typename std::is_trivial<Type>::type());
+    }
 
-        for (n = 0; n < other.m_size; ++n)
+    // allocated capacity
+    template <typename Type, typename Allocator>
+    inline size_t array<Type,Allocator>::capacity() const throw()
+    {
+        return m_capacity;
+    }
+
+    // appending
+    template <typename Type, typename Allocator>
+    void array<Type,Allocator>::append(const array<Type,Allocator> & other)
+    {
+        // capture the length first, in case other is this array
+        size_t count = other.m_size;
+        size_t new_size = m_size + count;
+
+        // grow geometrically
+        if (new_size > m_capacity)
+            reserve(max_of(new_size,2 * m_capacity));
+
+        // copy from other array; its buffer is read after any reallocation
+        copy_elements(m_array + m_size,other.m_array,count);
+        m_size = new_size;
+    }
+
+    template <typename Type, typename Allocator>
+    void array<Type,Allocator>::append(const Type & a_value)
+    {
+        if (m_size == m_capacity)
         {
-            *target = *a_source;
-            ++target;
-            ++a_source;
+            // a_value may refer to an element of this array
+            Type temp(a_value);
+            reserve(max_of(m_size + 1,2 * m_capacity));
+            m_array[m_size] = static_cast<Type &&>(temp);
         }
+        else
+            m_array[m_size] = a_value;
 
-        // set this to use new array, destroying old one
-        m_size = new_size;
-        delete [] m_array;
-        m_array = new_array;
+        ++m_size;
     }
 
     // iterator functions
-    template <typename Type>
-    inline typename array<Type>::iterator array<Type>::begin() throw()
+    template <typename Type, typename Allocator>
+    inline typename array<Type,Allocator>::iterator array<Type,Allocator>::begin() throw()
     {
         return &(m_array[0]);
     }
 
-    template <typename Type>
-    inline typename array<Type>::const_iterator array<Type>::begin() const throw()
+    template <typename Type, typename Allocator>
+    inline typename array<Type,Allocator>::const_iterator array<Type,Allocator>::begin() const throw()
     {
         return &(m_array[0]);
     }
 
-    template <typename Type>
-    inline typename array<Type>::iterator array<Type>::end() throw()
+    template <typename Type, typename Allocator>
+    inline typename array<Type,Allocator>::iterator array<Type,Allocator>::end() throw()
     {
         return &(m_array[m_size]);
     }
 
-    template <typename Type>
-    inline typename array<Type>::const_iterator array<Type>::end() const throw()
+    template <typename Type, typename Allocator>
+    inline typename array<Type,Allocator>::const_iterator array<Type,Allocator>::end() const throw()
     {
         return &(m_array[m_size]);
     }
 
-    template <typename Type>
-    inline typename array<Type>::reverse_iterator array<Type>::rbegin() throw()
+    template <typename Type, typename Allocator>
+    inline typename array<Type,Allocator>::reverse_iterator array<Type,Allocator>::rbegin() throw()
     {
         return end();
     }
 
-    template <typename Type>
-    inline typename array<Type>::const_reverse_iterator array<Type>::rbegin() const throw()
+    template <typename Type, typename Allocator>
+    inline typename array<Type,Allocator>::const_reverse_iterator array<Type,Allocator>::rbegin() const throw()
     {
         return end();
     }
 
-    template <typename Type>
-    inline typename array<Type>::reverse_iterator array<Type>::rend() throw()
+    template <typename Type, typename Allocator>
+    inline typename array<Type,Allocator>::reverse_iterator array<Type,Allocator>::rend() throw()
     {
         return begin();
     }
 
-    template <typename Type>
-    inline typename array<Type>::const_reverse_iterator array<Type>::rend() const throw()
+    template <typename Type, typename Allocator>
+    inline typename array<Type,Allocator>::const_reverse_iterator array<Type,Allocator>::rend() const throw()
     {
         return begin();
     }
 
     // comparisons (required by std. container definition)
-    template <typename Type>
-    inline bool array<Type>::operator == (const array<Type> & a_array) const throw()
+    template <typename Type, typename Allocator>
+    inline bool array<Type,Allocator>::operator == (const array<Type,Allocator> & a_array) const throw()
     {
-        return equal(begin(),end(),a_array.begin());
+        return (m_size == a_array.m_size) && equal_elements(m_array,a_array.m_array,m_size);
     }
 
-    template <typename Type>
-    inline bool array<Type>::operator != (const array<Type> & a_array) const throw()
+    template <typename Type, typename Allocator>
+    inline bool array<Type,Allocator>::operator != (const array<Type,Allocator> & a_array) const throw()
     {
         return !(*this == a_array);
     }
 
-    template <typename Type>
-    inline bool array<Type>::operator < (const array<Type> & a_array) const throw()
+    template <typename Type, typename Allocator>
+    inline bool array<Type,Allocator>::operator < (const array<Type,Allocator> & a_array) const throw()
     {
-        return lexicographical_compare(begin(),end(),a_array.begin(),a_array.end());
+        return less_elements<Type>(m_array,m_size,a_array.m_array,a_array.m_size);
     }
 
-    template <typename Type>
-    inline bool array<Type>::operator > (const array<Type> & a_array) const throw()
+    template <typename Type, typename Allocator>
+    inline bool array<Type,Allocator>::operator > (const array<Type,Allocator> & a_array) const throw()
     {
         return (a_array < *this);
     }
 
-    template <typename Type>
-    inline bool array<Type>::operator <= (const array<Type> & a_array) const throw()
+    template <typename Type, typename Allocator>
+    inline bool array<Type,Allocator>::operator <= (const array<Type,Allocator> & a_array) const throw()
     {
         return !(*this > a_array);
     }
 
-    template <typename Type>
-    inline bool array<Type>::operator >= (const array<Type> & a_array) const throw()
+    template <typename Type, typename Allocator>
+    inline bool array<Type,Allocator>::operator >= (const array<Type,Allocator> & a_array) const throw()
     {
         return !(*this < a_array);
     }
 
     // swap (required by std. container definition)
-    template <typename Type>
-    void array<Type>::swap(array<Type> & a_source) throw()
+    template <typename Type, typename Allocator>
+    void array<Type,Allocator>::swap(array<Type,Allocator> & a_source) throw()
     {
-        // in this case, both arrays must be the same a_length
-        validate_equals(m_size,a_source.m_size,LIBCOYOTL_LOCATION);
+        // exchange buffers; no elements are copied
+        Type * temp_array = m_array;
+        m_array = a_source.m_array;
+        a_source.m_array = temp_array;
 
-        // use pointers for copy
-        Type * target_ptr = m_array;
-        Type * source_ptr = a_source.m_array;
+        size_t temp_size = m_size;
+        m_size = a_source.m_size;
+        a_source.m_size = temp_size;
 
-        for (size_t n = 0; n < m_size; ++n)
-        {
-            Type temp   = *target_ptr;
-            *target_ptr = *source_ptr;
-            *source_ptr = temp;
+        size_t temp_capacity = m_capacity;
+        m_capacity = a_source.m_capacity;
+        a_source.m_capacity = temp_capacity;
 
-            ++target_ptr;
-            ++source_ptr;
-        }
+        Allocator temp_allocator = m_allocator;
+        m_allocator = a_source.m_allocator;
+        a_source.m_allocator = temp_allocator;
     }
 
     // number of elements
-    template <typename Type>
-    inline size_t array<Type>::size() const throw()
+    template <typename Type, typename Allocator>
+    inline size_t array<Type,Allocator>::size() const throw()
     {
         return m_size;
     }
 
     // max_size (required by std. container definition)
-    template <typename Type>
-    inline size_t array<Type>::max_size() const throw()
+    template <typename Type, typename Allocator>
+    inline size_t array<Type,Allocator>::max_size() const throw()
     {
         return m_size;
     }
 
-    // empty (always false; required by std. container definition)
-    template <typename Type>
-    inline bool array<Type>::empty() const throw()
+    // empty (only after a move or release; required by std. container definition)
+    template <typename Type, typename Allocator>
+    inline bool array<Type,Allocator>::empty() const throw()
     {
-        return false;
+        return (m_size == 0);
     }
 
 };
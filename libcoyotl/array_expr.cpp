@@ -0,0 +1,61 @@
+//---------------------------------------------------------------------
+//  Algorithmic Conjurings @ http://www.coyotegulch.com
+//
+//  array_expr.cpp (libcoyotl)
+//
+//  Expression templates for fused, temporary-free element-wise
+//  arithmetic and reductions on arrays.
+//---------------------------------------------------------------------
+//
+//  Copyright 1990-2005 Scott Robert Ladd
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the
+//      Free Software Foundation, Inc.
+//      59 Temple Place - Suite 330
+//      Boston, MA 02111-1307, USA.
+//
+//-----------------------------------------------------------------------
+//
+//  For more information on this software package, please visit
+//  Scott's web site, Coyote Gulch Productions, at:
+//
+//      http://www.coyotegulch.com
+//
+//-----------------------------------------------------------------------
+
+// Standard C++ library
+#include <atomic>
+
+// libcoyotl
+#include "array_expr.h"
+
+using namespace libcoyotl;
+
+// elements at which evaluation goes parallel; large enough that
+// thread start-up is a small fraction of the work
+static std::atomic<size_t> s_threshold(262144);
+
+//--------------------------------------------------------------------------
+//  Get the parallel evaluation threshold
+size_t libcoyotl::get_expression_threshold()
+{
+    return s_threshold.load(std::memory_order_relaxed);
+}
+
+//--------------------------------------------------------------------------
+//  Set the parallel evaluation threshold
+void libcoyotl::set_expression_threshold(size_t a_threshold)
+{
+    s_threshold.store(a_threshold,std::memory_order_relaxed);
+}
@@ -0,0 +1,603 @@
+//---------------------------------------------------------------------
+//  Algorithmic Conjurings @ http://www.coyotegulch.com
+//
+//  array_expr.h (libcoyotl)
+//
+//  Expression templates for fused, temporary-free element-wise
+//  arithmetic and reductions on arrays.
+//---------------------------------------------------------------------
+//
+//  Copyright 1990-2005 Scott Robert Ladd
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the
+//      Free Software Foundation, Inc.
+//      59 Temple Place - Suite 330
+//      Boston, MA 02111-1307, USA.
+//
+//-----------------------------------------------------------------------
+//
+//  For more information on this software package, please visit
+//  Scott's web site, Coyote Gulch Productions, at:
+//
+//      http://www.coyotegulch.com
+//
+//-----------------------------------------------------------------------
+
+#if !defined(LIBCOYOTL_ARRAY_EXPR_H)
+#define LIBCOYOTL_ARRAY_EXPR_H
+
+#include <cmath>
+#include <cstddef>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "validator.h"  // validation functions
+#include "array_view.h" // non-owning views
+
+namespace libcoyotl
+{
+    //--------------------------------------------------
+    // Arithmetic on arrays builds a tree of lightweight expression
+    // objects instead of computing temporaries; assigning an expression
+    // to an array, or reducing it with sum, dot or norm, evaluates the
+    // whole tree in a single loop over the elements. Expressions refer
+    // to their operands' storage, so they must be evaluated before any
+    // of those arrays are destroyed or reallocated.
+
+    //! Get the parallel evaluation threshold
+    /*!
+        Expressions with at least this many elements are evaluated by
+        several threads. The default is 262144 elements.
+        \return Minimum number of elements for parallel evaluation
+    */
+    size_t get_expression_threshold();
+
+    //! Set the parallel evaluation threshold
+    /*!
+        Sets the number of elements at which expressions are evaluated in
+        parallel; zero disables parallel evaluation.
+        \param a_threshold - Minimum number of elements for parallel evaluation
+    */
+    void set_expression_threshold(size_t a_threshold);
+
+    //! Base of all array expressions
+    /*!
+        A curiously-recurring template base that identifies expression
+        types. Every <i>Derived</i> provides <i>value_type</i>, a constant
+        <i>is_scalar</i> (true when every operand is a scalar, which
+        matches any length), <i>size()</i> (zero for a scalar) and an
+        <i>operator []</i> computing one element. An array operand may be
+        empty, so a size of zero alone does not make a scalar.
+    */
+    template <class Derived>
+    class array_expression
+    {
+    public:
+        //! The expression as its derived type
+        const Derived & self() const throw()
+        {
+            return static_cast<const Derived &>(*this);
+        }
+    };
+
+    //! Expression leaf referring to contiguous elements
+    template <typename Type>
+    class expr_leaf : public array_expression< expr_leaf<Type> >
+    {
+    public:
+        //! Type of an element
+        typedef Type value_type;
+
+        //! Refers to array elements
+        static const bool is_scalar = false;
+
+        //! Constructor
+        expr_leaf(const Type * a_data, size_t a_length) throw()
+          : m_data(a_data),
+            m_size(a_length)
+        {
+            // nada
+        }
+
+        //! Number of elements
+        size_t size() const throw() { return m_size; }
+
+        //! Element value
+        Type operator [] (size_t n) const throw() { return m_data[n]; }
+
+    private:
+        const Type * m_data;
+        size_t       m_size;
+    };
+
+    //! Expression leaf referring to strided elements
+    template <typename Type>
+    class expr_strided_leaf : public array_expression< expr_strided_leaf<Type> >
+    {
+    public:
+        //! Type of an element
+        typedef Type value_type;
+
+        //! Refers to array elements
+        static const bool is_scalar = false;
+
+        //! Constructor
+        explicit expr_strided_leaf(const array_view<const Type> & a_view) throw()
+          : m_view(a_view)
+        {
+            // nada
+        }
+
+        //! Number of elements
+        size_t size() const throw() { return m_view.size(); }
+
+        //! Element value
+        Type operator [] (size_t n) const throw() { return m_view[n]; }
+
+    private:
+        array_view<const Type> m_view;
+    };
+
+    //! Expression leaf holding a scalar, which matches any length
+    template <typename Type>
+    class expr_scalar : public array_expression< expr_scalar<Type> >
+    {
+    public:
+        //! Type of an element
+        typedef Type value_type;
+
+        //! Matches any length
+        static const bool is_scalar = true;
+
+        //! Constructor
+        explicit expr_scalar(const Type & a_value) throw()
+          : m_value(a_value)
+        {
+            // nada
+        }
+
+        //! Number of elements; zero matches any length
+        size_t size() const throw() { return 0; }
+
+        //! Element value
+        Type operator [] (size_t) const throw() { return m_value; }
+
+    private:
+        Type m_value;
+    };
+
+    //! Element-wise binary operation
+    template <class Op, class Left, class Right>
+    class expr_binary : public array_expression< expr_binary<Op,Left,Right> >
+    {
+    public:
+        //! Type of an element
+        typedef decltype(Op::apply(std::declval<typename Left::value_type>(),std::declval<typename Right::value_type>())) value_type;
+
+        //! A scalar only if both operands are
+        static const bool is_scalar = Left::is_scalar && Right::is_scalar;
+
+        //! Constructor; operands must have the same length unless one is a scalar
+        expr_binary(const Left & a_left, const Right & a_right)
+          : m_left(a_left),
+            m_right(a_right)
+        {
+            if (!Left::is_scalar && !Right::is_scalar)
+                validate_equals(m_right.size(),m_left.size(),LIBCOYOTL_LOCATION);
+        }
+
+        //! Number of elements
+        size_t size() const throw() { return Left::is_scalar ? m_right.size() : m_left.size(); }
+
+        //! Element value
+        value_type operator [] (size_t n) const throw() { return Op::apply(m_left[n],m_right[n]); }
+
+    private:
+        Left  m_left;
+        Right m_right;
+    };
+
+    //! Element-wise unary operation
+    template <class Op, class Operand>
+    class expr_unary : public array_expression< expr_unary<Op,Operand> >
+    {
+    public:
+        //! Type of an element
+        typedef decltype(Op::apply(std::declval<typename Operand::value_type>())) value_type;
+
+        //! A scalar only if the operand is
+        static const bool is_scalar = Operand::is_scalar;
+
+        //! Constructor
+        explicit expr_unary(const Operand & a_operand)
+          : m_operand(a_operand)
+        {
+            // nada
+        }
+
+        //! Number of elements
+        size_t size() const throw() { return m_operand.size(); }
+
+        //! Element value
+        value_type operator [] (size_t n) const throw() { return Op::apply(m_operand[n]); }
+
+    private:
+        Operand m_operand;
+    };
+
+    //--------------------------------------------------
+    // element-wise operations
+
+    struct expr_add      { template <typename A, typename B> static auto apply(A a, B b) -> decltype(a + b) { return a + b; } };
+    struct expr_subtract { template <typename A, typename B> static auto apply(A a, B b) -> decltype(a - b) { return a - b; } };
+    struct expr_multiply { template <typename A, typename B> static auto apply(A a, B b) -> decltype(a * b) { return a * b; } };
+    struct expr_divide   { template <typename A, typename B> static auto apply(A a, B b) -> decltype(a / b) { return a / b; } };
+    struct expr_negate   { template <typename A> static auto apply(A a) -> decltype(-a) { return -a; } };
+    struct expr_abs      { template <typename A> static A apply(A a) { return (a < A(0)) ? -a : a; } };
+    struct expr_sqrt     { template <typename A> static auto apply(A a) -> decltype(std::sqrt(a)) { return std::sqrt(a); } };
+
+    //--------------------------------------------------
+    // conversion of operands to expressions
+
+    // detects containers with contiguous elements: c_array() and size()
+    template <class Type, class Enable = void>
+    struct is_expr_container : public std::false_type { };
+
+    template <class Type>
+    struct is_expr_container<Type, typename std::enable_if<
+        std::is_pointer<decltype(std::declval<const Type &>().c_array())>::value
+        && std::is_integral<decltype(std::declval<const Type &>().size())>::value>::type>
+      : public std::true_type { };
+
+    //! Conversion of an operand to an expression
+    /*!
+        Expressions stand for themselves; arrays, fixed_arrays, small_arrays
+        and views become leaves; arithmetic values become scalars. Any other
+        type is not an operand.
+    */
+    template <class Type, class Enable = void>
+    struct expr_operand
+    {
+        //! Is Type an operand?
+        static const bool is_operand = false;
+
+        //! Is Type a scalar?
+        static const bool is_scalar = false;
+    };
+
+    template <class Type>
+    struct expr_operand<Type, typename std::enable_if<std::is_base_of<array_expression<Type>,Type>::value>::type>
+    {
+        static const bool is_operand = true;
+        static const bool is_scalar  = false;
+        typedef Type type;
+        static const Type & make(const Type & a_expr) { return a_expr; }
+    };
+
+    template <class Type>
+    struct expr_operand<Type, typename std::enable_if<is_expr_container<Type>::value>::type>
+    {
+        static const bool is_operand = true;
+        static const bool is_scalar  = false;
+        typedef expr_leaf<typename Type::value_type> type;
+        static type make(const Type & a_array) { return type(a_array.c_array(),a_array.size()); }
+    };
+
+    template <class Type>
+    struct expr_operand< array_view<Type> >
+    {
+        static const bool is_operand = true;
+        static const bool is_scalar  = false;
+        typedef expr_strided_leaf<typename std::remove_const<Type>::type> type;
+        static type make(const array_view<Type> & a_view) { return type(a_view); }
+    };
+
+    template <class Type>
+    struct expr_operand<Type, typename std::enable_if<std::is_arithmetic<Type>::value>::type>
+    {
+        static const bool is_operand = true;
+        static const bool is_scalar  = true;
+        typedef expr_scalar<Type> type;
+        static type make(const Type & a_value) { return type(a_value); }
+    };
+
+    // result of a binary operator; it has no type unless the operands
+    // qualify, which removes the operators from overload resolution
+    // for unrelated types such as std::string
+    template <class Op, class Left, class Right,
+              bool Enable = expr_operand<Left>::is_operand && expr_operand<Right>::is_operand
+                            && !(expr_operand<Left>::is_scalar && expr_operand<Right>::is_scalar)>
+    struct expr_binary_result
+    {
+        // nada
+    };
+
+    template <class Op, class Left, class Right>
+    struct expr_binary_result<Op,Left,Right,true>
+    {
+        typedef expr_binary<Op,typename expr_operand<Left>::type,typename expr_operand<Right>::type> type;
+    };
+
+    // result of a unary operator, if the operand qualifies
+    template <class Op, class Operand,
+              bool Enable = expr_operand<Operand>::is_operand && !expr_operand<Operand>::is_scalar>
+    struct expr_unary_result
+    {
+        // nada
+    };
+
+    template <class Op, class Operand>
+    struct expr_unary_result<Op,Operand,true>
+    {
+        typedef expr_unary<Op,typename expr_operand<Operand>::type> type;
+    };
+
+    // element type of a reduction, if the operand qualifies
+    template <class Operand,
+              bool Enable = expr_operand<Operand>::is_operand && !expr_operand<Operand>::is_scalar>
+    struct expr_reduction_result
+    {
+        // nada
+    };
+
+    template <class Operand>
+    struct expr_reduction_result<Operand,true>
+    {
+        typedef typename expr_operand<Operand>::type::value_type type;
+    };
+
+    //--------------------------------------------------
+    // operators and functions building expressions
+
+    //! Element-wise addition
+    template <class Left, class Right>
+    inline typename expr_binary_result<expr_add,Left,Right>::type operator + (const Left & a_left, const Right & a_right)
+    {
+        return typename expr_binary_result<expr_add,Left,Right>::type(expr_operand<Left>::make(a_left),expr_operand<Right>::make(a_right));
+    }
+
+    //! Element-wise subtraction
+    template <class Left, class Right>
+    inline typename expr_binary_result<expr_subtract,Left,Right>::type operator - (const Left & a_left, const Right & a_right)
+    {
+        return typename expr_binary_result<expr_subtract,Left,Right>::type(expr_operand<Left>::make(a_left),expr_operand<Right>::make(a_right));
+    }
+
+    //! Element-wise multiplication
+    template <class Left, class Right>
+    inline typename expr_binary_result<expr_multiply,Left,Right>::type operator * (const Left & a_left, const Right & a_right)
+    {
+        return typename expr_binary_result<expr_multiply,Left,Right>::type(expr_operand<Left>::make(a_left),expr_operand<Right>::make(a_right));
+    }
+
+    //! Element-wise division
+    template <class Left, class Right>
+    inline typename expr_binary_result<expr_divide,Left,Right>::type operator / (const Left & a_left, const Right & a_right)
+    {
+        return typename expr_binary_result<expr_divide,Left,Right>::type(expr_operand<Left>::make(a_left),expr_operand<Right>::make(a_right));
+    }
+
+    //! Element-wise negation
+    template <class Operand>
+    inline typename expr_unary_result<expr_negate,Operand>::type operator - (const Operand & a_operand)
+    {
+        return typename expr_unary_result<expr_negate,Operand>::type(expr_operand<Operand>::make(a_operand));
+    }
+
+    //! Element-wise absolute value
+    template <class Operand>
+    inline typename expr_unary_result<expr_abs,Operand>::type abs_of(const Operand & a_operand)
+    {
+        return typename expr_unary_result<expr_abs,Operand>::type(expr_operand<Operand>::make(a_operand));
+    }
+
+    //! Element-wise square root
+    template <class Operand>
+    inline typename expr_unary_result<expr_sqrt,Operand>::type sqrt_of(const Operand & a_operand)
+    {
+        return typename expr_unary_result<expr_sqrt,Operand>::type(expr_operand<Operand>::make(a_operand));
+    }
+
+    //--------------------------------------------------
+    // evaluation
+
+    // number of threads for an expression of a_length elements
+    inline size_t expression_threads(size_t a_length)
+    {
+        size_t threshold = get_expression_threshold();
+
+        if ((threshold == 0) || (a_length < threshold))
+            return 1;
+
+        size_t threads = std::thread::hardware_concurrency();
+
+        if (threads > a_length / (threshold / 2 + 1))
+            threads = a_length / (threshold / 2 + 1);
+
+        return (threads > 1) ? threads : 1;
+    }
+
+    // evaluate elements [a_first,a_last) into a_target
+    template <typename Type, class Expr>
+    void evaluate_range(Type * a_target, const Expr & a_expr, size_t a_first, size_t a_last)
+    {
+        for (size_t n = a_first; n < a_last; ++n)
+            a_target[n] = a_expr[n];
+    }
+
+    //! Evaluate an expression into contiguous storage
+    /*!
+        Computes every element of an expression in one fused loop, which
+        compilers vectorize for arithmetic types; expressions at or above
+        the parallel threshold are divided among threads. Elements are
+        computed independently, so the target may also be an operand.
+        \param a_target - Storage for the results
+        \param a_length - Number of elements in the target
+        \param a_expr - The expression
+    */
+    template <typename Type, class Expr>
+    void evaluate(Type * a_target, size_t a_length, const array_expression<Expr> & a_expr)
+    {
+        const Expr & expr = a_expr.self();
+
+        if (!Expr::is_scalar)
+            validate_equals(expr.size(),a_length,LIBCOYOTL_LOCATION);
+
+        size_t threads = expression_threads(a_length);
+
+        if (threads == 1)
+        {
+            evaluate_range(a_target,expr,0,a_length);
+            return;
+        }
+
+        std::vector<std::thread> workers;
+
+        for (size_t i = 1; i < threads; ++i)
+            workers.push_back(std::thread(evaluate_range<Type,Expr>,a_target,std::cref(expr),a_length * i / threads,a_length * (i + 1) / threads));
+
+        evaluate_range(a_target,expr,0,a_length / threads);
+
+        for (size_t i = 0; i < workers.size(); ++i)
+            workers[i].join();
+    }
+
+    //! Evaluate an expression into a view
+    /*!
+        Assigns each element of an expression to the corresponding element of
+        a (possibly strided) view.
+        \param a_target - View receiving the results
+        \param a_expr - The expression
+    */
+    template <typename Type, class Expr>
+    void assign(array_view<Type> a_target, const array_expression<Expr> & a_expr)
+    {
+        if (a_target.is_contiguous())
+            evaluate(a_target.data(),a_target.size(),a_expr);
+        else
+        {
+            const Expr & expr = a_expr.self();
+
+            if (!Expr::is_scalar)
+                validate_equals(expr.size(),a_target.size(),LIBCOYOTL_LOCATION);
+
+            for (size_t n = 0; n < a_target.size(); ++n)
+                a_target[n] = expr[n];
+        }
+    }
+
+    //--------------------------------------------------
+    // reductions
+
+    // sum elements [a_first,a_last); eight accumulators let the
+    // compiler vectorize without reassociating floating-point sums
+    template <class Expr>
+    void sum_range(const Expr & a_expr, size_t a_first, size_t a_last, typename Expr::value_type * a_result)
+    {
+        typedef typename Expr::value_type value_type;
+
+        value_type acc[8] = { value_type(0), value_type(0), value_type(0), value_type(0),
+                              value_type(0), value_type(0), value_type(0), value_type(0) };
+
+        size_t n = a_first;
+
+        for (; n + 8 <= a_last; n += 8)
+        {
+            for (size_t k = 0; k < 8; ++k)
+                acc[k] += a_expr[n + k];
+        }
+
+        for (; n < a_last; ++n)
+            acc[0] += a_expr[n];
+
+        *a_result = ((acc[0] + acc[1]) + (acc[2] + acc[3])) + ((acc[4] + acc[5]) + (acc[6] + acc[7]));
+    }
+
+    //! Sum of elements
+    /*!
+        Computes the sum of an expression's elements (or of an array's) in
+        one fused loop, in parallel above the threshold.
+        \param a_operand - An expression or array
+        \return Sum of the elements
+    */
+    template <class Operand>
+    typename expr_reduction_result<Operand>::type sum(const Operand & a_operand)
+    {
+        typedef typename expr_operand<Operand>::type expr_type;
+        typedef typename expr_type::value_type value_type;
+
+        expr_type expr(expr_operand<Operand>::make(a_operand));
+
+        size_t length  = expr.size();
+        size_t threads = expression_threads(length);
+
+        if (threads == 1)
+        {
+            value_type result;
+            sum_range(expr,0,length,&result);
+            return result;
+        }
+
+        std::vector<value_type>  partial(threads);
+        std::vector<std::thread> workers;
+
+        for (size_t i = 1; i < threads; ++i)
+            workers.push_back(std::thread(sum_range<expr_type>,std::cref(expr),length * i / threads,length * (i + 1) / threads,&partial[i]));
+
+        sum_range(expr,0,length / threads,&partial[0]);
+
+        value_type result = value_type(0);
+
+        for (size_t i = 0; i < threads; ++i)
+        {
+            if (i > 0)
+                workers[i - 1].join();
+
+            result += partial[i];
+        }
+
+        return result;
+    }
+
+    //! Dot product
+    /*!
+        Computes the sum of the products of corresponding elements, without
+        forming the products as a temporary array.
+        \param a_left - An expression or array
+        \param a_right - An expression or array of the same length
+        \return Dot product
+    */
+    template <class Left, class Right>
+    typename expr_reduction_result<typename expr_binary_result<expr_multiply,Left,Right>::type>::type dot(const Left & a_left, const Right & a_right)
+    {
+        return sum(a_left * a_right);
+    }
+
+    //! Euclidean norm
+    /*!
+        Computes the square root of the sum of squared elements.
+        \param a_operand - An expression or array
+        \return Euclidean norm
+    */
+    template <class Operand>
+    typename expr_reduction_result<Operand>::type norm(const Operand & a_operand)
+    {
+        return std::sqrt(dot(a_operand,a_operand));
+    }
+
+} // end namespace libcoyotl
+
+#endif
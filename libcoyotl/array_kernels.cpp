@@ -0,0 +1,418 @@
+//---------------------------------------------------------------------
+//  Algorithmic Conjurings @ http://www.coyotegulch.com
+//
+//  array_kernels.cpp (libcoyotl)
+//
+//  Element-wise copy, fill and comparison kernels for contiguous
+//  arrays, with fast paths for trivially copyable types.
+//---------------------------------------------------------------------
+//
+//  Copyright 1990-2005 Scott Robert Ladd
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the
+//      Free Software Foundation, Inc.
+//      59 Temple Place - Suite 330
+//      Boston, MA 02111-1307, USA.
+//
+//-----------------------------------------------------------------------
+//
+//  For more information on this software package, please visit
+//  Scott's web site, Coyote Gulch Productions, at:
+//
+//      http://www.coyotegulch.com
+//
+//-----------------------------------------------------------------------
+
+// Standard C++ library
+#include <cstring>
+#include <stdint.h>
+
+// libcoyotl
+#include "array_kernels.h"
+#include "cpu_features.h"
+
+#if defined(LIBCOYOTL_X86_DISPATCH)
+#include <immintrin.h>
+#endif
+
+using namespace libcoyotl;
+
+// kernel signatures
+typedef size_t (*byte_kernel)(const uint8_t * a_first, const uint8_t * a_second, size_t a_bytes);
+typedef size_t (*double_kernel)(const double * a_first, const double * a_second, size_t a_length);
+typedef size_t (*float_kernel)(const float * a_first, const float * a_second, size_t a_length);
+
+//--------------------------------------------------------------------------
+//  Portable kernels
+static size_t mismatch_bytes_scalar(const uint8_t * a_first, const uint8_t * a_second, size_t a_bytes)
+{
+    size_t n = 0;
+
+    // compare a word at a time until words differ
+    for (; n + 8 <= a_bytes; n += 8)
+    {
+        uint64_t x, y;
+        memcpy(&x,a_first + n,8);
+        memcpy(&y,a_second + n,8);
+
+        if (x != y)
+            break;
+    }
+
+    while ((n < a_bytes) && (a_first[n] == a_second[n]))
+        ++n;
+
+    return n;
+}
+
+template <typename Real>
+static size_t unequal_scalar(const Real * a_first, const Real * a_second, size_t a_length)
+{
+    size_t n = 0;
+
+    while ((n < a_length) && (a_first[n] == a_second[n]))
+        ++n;
+
+    return n;
+}
+
+template <typename Real>
+static size_t difference_scalar(const Real * a_first, const Real * a_second, size_t a_length)
+{
+    size_t n = 0;
+
+    while ((n < a_length) && !(a_first[n] < a_second[n]) && !(a_second[n] < a_first[n]))
+        ++n;
+
+    return n;
+}
+
+static size_t unequal_double_scalar(const double * a_first, const double * a_second, size_t a_length)
+{
+    return unequal_scalar(a_first,a_second,a_length);
+}
+
+static size_t unequal_float_scalar(const float * a_first, const float * a_second, size_t a_length)
+{
+    return unequal_scalar(a_first,a_second,a_length);
+}
+
+static size_t difference_double_scalar(const double * a_first, const double * a_second, size_t a_length)
+{
+    return difference_scalar(a_first,a_second,a_length);
+}
+
+static size_t difference_float_scalar(const float * a_first, const float * a_second, size_t a_length)
+{
+    return difference_scalar(a_first,a_second,a_length);
+}
+
+#if defined(LIBCOYOTL_X86_DISPATCH)
+
+//--------------------------------------------------------------------------
+//  SSE2 kernels; each finds the first block containing a difference, and
+//  the lowest set bit of the comparison mask locates it within the block
+LIBCOYOTL_TARGET("sse2")
+static size_t mismatch_bytes_sse2(const uint8_t * a_first, const uint8_t * a_second, size_t a_bytes)
+{
+    size_t n = 0;
+
+    for (; n + 16 <= a_bytes; n += 16)
+    {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a_first + n));
+        __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a_second + n));
+        unsigned int same = unsigned(_mm_movemask_epi8(_mm_cmpeq_epi8(x,y)));
+
+        if (same != 0xFFFFu)
+            return n + __builtin_ctz(~same);
+    }
+
+    return n + mismatch_bytes_scalar(a_first + n,a_second + n,a_bytes - n);
+}
+
+LIBCOYOTL_TARGET("sse2")
+static size_t unequal_double_sse2(const double * a_first, const double * a_second, size_t a_length)
+{
+    size_t n = 0;
+
+    for (; n + 2 <= a_length; n += 2)
+    {
+        int mask = _mm_movemask_pd(_mm_cmpneq_pd(_mm_loadu_pd(a_first + n),_mm_loadu_pd(a_second + n)));
+
+        if (mask != 0)
+            return n + __builtin_ctz(mask);
+    }
+
+    return n + unequal_scalar(a_first + n,a_second + n,a_length - n);
+}
+
+LIBCOYOTL_TARGET("sse2")
+static size_t difference_double_sse2(const double * a_first, const double * a_second, size_t a_length)
+{
+    size_t n = 0;
+
+    for (; n + 2 <= a_length; n += 2)
+    {
+        __m128d x = _mm_loadu_pd(a_first + n);
+        __m128d y = _mm_loadu_pd(a_second + n);
+        int mask = _mm_movemask_pd(_mm_or_pd(_mm_cmplt_pd(x,y),_mm_cmpgt_pd(x,y)));
+
+        if (mask != 0)
+            return n + __builtin_ctz(mask);
+    }
+
+    return n + difference_scalar(a_first + n,a_second + n,a_length - n);
+}
+
+LIBCOYOTL_TARGET("sse2")
+static size_t unequal_float_sse2(const float * a_first, const float * a_second, size_t a_length)
+{
+    size_t n = 0;
+
+    for (; n + 4 <= a_length; n += 4)
+    {
+        int mask = _mm_movemask_ps(_mm_cmpneq_ps(_mm_loadu_ps(a_first + n),_mm_loadu_ps(a_second + n)));
+
+        if (mask != 0)
+            return n + __builtin_ctz(mask);
+    }
+
+    return n + unequal_scalar(a_first + n,a_second + n,a_length - n);
+}
+
+LIBCOYOTL_TARGET("sse2")
+static size_t difference_float_sse2(const float * a_first, const float * a_second, size_t a_length)
+{
+    size_t n = 0;
+
+    for (; n + 4 <= a_length; n += 4)
+    {
+        __m128 x = _mm_loadu_ps(a_first + n);
+        __m128 y = _mm_loadu_ps(a_second + n);
+        int mask = _mm_movemask_ps(_mm_or_ps(_mm_cmplt_ps(x,y),_mm_cmpgt_ps(x,y)));
+
+        if (mask != 0)
+            return n + __builtin_ctz(mask);
+    }
+
+    return n + difference_scalar(a_first + n,a_second + n,a_length - n);
+}
+
+//--------------------------------------------------------------------------
+//  AVX2 kernels
+LIBCOYOTL_TARGET("avx2")
+static size_t mismatch_bytes_avx2(const uint8_t * a_first, const uint8_t * a_second, size_t a_bytes)
+{
+    size_t n = 0;
+
+    for (; n + 32 <= a_bytes; n += 32)
+    {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a_first + n));
+        __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a_second + n));
+        unsigned int same = unsigned(_mm256_movemask_epi8(_mm256_cmpeq_epi8(x,y)));
+
+        if (same != 0xFFFFFFFFu)
+            return n + __builtin_ctz(~same);
+    }
+
+    return n + mismatch_bytes_scalar(a_first + n,a_second + n,a_bytes - n);
+}
+
+LIBCOYOTL_TARGET("avx2")
+static size_t unequal_double_avx2(const double * a_first, const double * a_second, size_t a_length)
+{
+    size_t n = 0;
+
+    for (; n + 4 <= a_length; n += 4)
+    {
+        int mask = _mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd(a_first + n),_mm256_loadu_pd(a_second + n),_CMP_NEQ_UQ));
+
+        if (mask != 0)
+            return n + __builtin_ctz(mask);
+    }
+
+    return n + unequal_scalar(a_first + n,a_second + n,a_length - n);
+}
+
+LIBCOYOTL_TARGET("avx2")
+static size_t difference_double_avx2(const double * a_first, const double * a_second, size_t a_length)
+{
+    size_t n = 0;
+
+    for (; n + 4 <= a_length; n += 4)
+    {
+        int mask = _mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd(a_first + n),_mm256_loadu_pd(a_second + n),_CMP_NEQ_OQ));
+
+        if (mask != 0)
+            return n + __builtin_ctz(mask);
+    }
+
+    return n + difference_scalar(a_first + n,a_second + n,a_length - n);
+}
+
+LIBCOYOTL_TARGET("avx2")
+static size_t unequal_float_avx2(const float * a_first, const float * a_second, size_t a_length)
+{
+    size_t n = 0;
+
+    for (; n + 8 <= a_length; n += 8)
+    {
+        int mask = _mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(a_first + n),_mm256_loadu_ps(a_second + n),_CMP_NEQ_UQ));
+
+        if (mask != 0)
+            return n + __builtin_ctz(mask);
+    }
+
+    return n + unequal_scalar(a_first + n,a_second + n,a_length - n);
+}
+
+LIBCOYOTL_TARGET("avx2")
+static size_t difference_float_avx2(const float * a_first, const float * a_second, size_t a_length)
+{
+    size_t n = 0;
+
+    for (; n + 8 <= a_length; n += 8)
+    {
+        int mask = _mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(a_first + n),_mm256_loadu_ps(a_second + n),_CMP_NEQ_OQ));
+
+        if (mask != 0)
+            return n + __builtin_ctz(mask);
+    }
+
+    return n + difference_scalar(a_first + n,a_second + n,a_length - n);
+}
+
+//--------------------------------------------------------------------------
+//  AVX-512 kernels
+LIBCOYOTL_TARGET("avx512f,avx512bw")
+static size_t mismatch_bytes_avx512(const uint8_t * a_first, const uint8_t * a_second, size_t a_bytes)
+{
+    size_t n = 0;
+
+    for (; n + 64 <= a_bytes; n += 64)
+    {
+        __mmask64 diff = _mm512_cmpneq_epi8_mask(_mm512_loadu_si512(a_first + n),_mm512_loadu_si512(a_second + n));
+
+        if (diff != 0)
+            return n + __builtin_ctzll(diff);
+    }
+
+    return n + mismatch_bytes_scalar(a_first + n,a_second + n,a_bytes - n);
+}
+
+LIBCOYOTL_TARGET("avx512f")
+static size_t unequal_double_avx512(const double * a_first, const double * a_second, size_t a_length)
+{
+    size_t n = 0;
+
+    for (; n + 8 <= a_length; n += 8)
+    {
+        __mmask8 diff = _mm512_cmp_pd_mask(_mm512_loadu_pd(a_first + n),_mm512_loadu_pd(a_second + n),_CMP_NEQ_UQ);
+
+        if (diff != 0)
+            return n + __builtin_ctz(diff);
+    }
+
+    return n + unequal_scalar(a_first + n,a_second + n,a_length - n);
+}
+
+LIBCOYOTL_TARGET("avx512f")
+static size_t difference_double_avx512(const double * a_first, const double * a_second, size_t a_length)
+{
+    size_t n = 0;
+
+    for (; n + 8 <= a_length; n += 8)
+    {
+        __mmask8 diff = _mm512_cmp_pd_mask(_mm512_loadu_pd(a_first + n),_mm512_loadu_pd(a_second + n),_CMP_NEQ_OQ);
+
+        if (diff != 0)
+            return n + __builtin_ctz(diff);
+    }
+
+    return n + difference_scalar(a_first + n,a_second + n,a_length - n);
+}
+
+LIBCOYOTL_TARGET("avx512f")
+static size_t unequal_float_avx512(const float * a_first, const float * a_second, size_t a_length)
+{
+    size_t n = 0;
+
+    for (; n + 16 <= a_length; n += 16)
+    {
+        __mmask16 diff = _mm512_cmp_ps_mask(_mm512_loadu_ps(a_first + n),_mm512_loadu_ps(a_second + n),_CMP_NEQ_UQ);
+
+        if (diff != 0)
+            return n + __builtin_ctz(diff);
+    }
+
+    return n + unequal_scalar(a_first + n,a_second + n,a_length - n);
+}
+
+LIBCOYOTL_TARGET("avx512f")
+static size_t difference_float_avx512(const float * a_first, const float * a_second, size_t a_length)
+{
+    size_t n = 0;
+
+    for (; n + 16 <= a_length; n += 16)
+    {
+        __mmask16 diff = _mm512_cmp_ps_mask(_mm512_loadu_ps(a_first + n),_mm512_loadu_ps(a_second + n),_CMP_NEQ_OQ);
+
+        if (diff != 0)
+            return n + __builtin_ctz(diff);
+    }
+
+    return n + difference_scalar(a_first + n,a_second + n,a_length - n);
+}
+
+// every level has a kernel
+#define LIBCOYOTL_KERNELS(name) name##_scalar, name##_sse2, name##_avx2, name##_avx512
+#else
+#define LIBCOYOTL_KERNELS(name) name##_scalar
+#endif
+
+//--------------------------------------------------------------------------
+//  Find the first differing byte
+size_t libcoyotl::first_mismatch_bytes(const void * a_first, const void * a_second, size_t a_bytes)
+{
+    static const byte_kernel kernel = select_kernel<byte_kernel>(LIBCOYOTL_KERNELS(mismatch_bytes));
+    return kernel(static_cast<const uint8_t *>(a_first),static_cast<const uint8_t *>(a_second),a_bytes);
+}
+
+//--------------------------------------------------------------------------
+//  Find the first unequal elements
+size_t libcoyotl::first_unequal(const double * a_first, const double * a_second, size_t a_length)
+{
+    static const double_kernel kernel = select_kernel<double_kernel>(LIBCOYOTL_KERNELS(unequal_double));
+    return kernel(a_first,a_second,a_length);
+}
+
+size_t libcoyotl::first_unequal(const float * a_first, const float * a_second, size_t a_length)
+{
+    static const float_kernel kernel = select_kernel<float_kernel>(LIBCOYOTL_KERNELS(unequal_float));
+    return kernel(a_first,a_second,a_length);
+}
+
+//--------------------------------------------------------------------------
+//  Find the first ordered difference
+size_t libcoyotl::first_difference(const double * a_first, const double * a_second, size_t a_length)
+{
+    static const double_kernel kernel = select_kernel<double_kernel>(LIBCOYOTL_KERNELS(difference_double));
+    return kernel(a_first,a_second,a_length);
+}
+
+size_t libcoyotl::first_difference(const float * a_first, const float * a_second, size_t a_length)
+{
+    static const float_kernel kernel = select_kernel<float_kernel>(LIBCOYOTL_KERNELS(difference_float));
+    return kernel(a_first,a_second,a_length);
+}
@@ -0,0 +1,299 @@
+//---------------------------------------------------------------------
+//  Algorithmic Conjurings @ http://www.coyotegulch.com
+//
+//  array_kernels.h (libcoyotl)
+//
+//  Element-wise copy, fill and comparison kernels for contiguous
+//  arrays, with fast paths for trivially copyable types.
+//---------------------------------------------------------------------
+//
+//  Copyright 1990-2005 Scott Robert Ladd
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the
+//      Free Software Foundation, Inc.
+//      59 Temple Place - Suite 330
+//      Boston, MA 02111-1307, USA.
+//
+//-----------------------------------------------------------------------
+//
+//  For more information on this software package, please visit
+//  Scott's web site, Coyote Gulch Productions, at:
+//
+//      http://www.coyotegulch.com
+//
+//-----------------------------------------------------------------------
+
+#if !defined(LIBCOYOTL_ARRAY_KERNELS_H)
+#define LIBCOYOTL_ARRAY_KERNELS_H
+
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+
+namespace libcoyotl
+{
+    //! Types whose equality is equality of their bytes
+    /*!
+        Integers, enumerations and pointers have a unique object
+        representation, so they can be compared with <i>memcmp</i> and
+        scanned bytewise. Floating-point types do not: 0.0 equals -0.0, and
+        a NaN equals nothing.
+    */
+    template <typename Type>
+    struct is_bitwise_comparable
+      : public std::integral_constant<bool, std::is_integral<Type>::value
+                                         || std::is_enum<Type>::value
+                                         || std::is_pointer<Type>::value>
+    {
+        // nada
+    };
+
+    //! Find the first differing byte
+    /*!
+        Vectorized scan for the first position at which two byte sequences
+        differ, using the best kernel for the running processor.
+        \param a_first - First sequence
+        \param a_second - Second sequence
+        \param a_bytes - Number of bytes to compare
+        \return Index of the first differing byte, or <i>a_bytes</i> if none
+    */
+    size_t first_mismatch_bytes(const void * a_first, const void * a_second, size_t a_bytes);
+
+    //! Find the first unequal doubles
+    /*!
+        Vectorized scan for the first index at which <i>a_first[i] == a_second[i]</i>
+        is false (so a NaN is unequal to everything).
+        \param a_first - First sequence
+        \param a_second - Second sequence
+        \param a_length - Number of elements to compare
+        \return Index of the first unequal pair, or <i>a_length</i> if none
+    */
+    size_t first_unequal(const double * a_first, const double * a_second, size_t a_length);
+
+    //! Find the first unequal floats
+    /*!
+        The single-precision version of <i>first_unequal</i>.
+        \param a_first - First sequence
+        \param a_second - Second sequence
+        \param a_length - Number of elements to compare
+        \return Index of the first unequal pair, or <i>a_length</i> if none
+    */
+    size_t first_unequal(const float * a_first, const float * a_second, size_t a_length);
+
+    //! Find the first ordered difference between doubles
+    /*!
+        Vectorized scan for the first index at which either element is
+        less than the other; pairs involving a NaN are equivalent, as they
+        are to <i>std::lexicographical_compare</i>.
+        \param a_first - First sequence
+        \param a_second - Second sequence
+        \param a_length - Number of elements to compare
+        \return Index of the first ordered pair, or <i>a_length</i> if none
+    */
+    size_t first_difference(const double * a_first, const double * a_second, size_t a_length);
+
+    //! Find the first ordered difference between floats
+    /*!
+        The single-precision version of <i>first_difference</i>.
+        \param a_first - First sequence
+        \param a_second - Second sequence
+        \param a_length - Number of elements to compare
+        \return Index of the first ordered pair, or <i>a_length</i> if none
+    */
+    size_t first_difference(const float * a_first, const float * a_second, size_t a_length);
+
+    // first ordered difference, bytewise for integers and pointers
+    template <typename Type>
+    size_t first_difference(const Type * a_first, const Type * a_second, size_t a_length, std::true_type)
+    {
+        return first_mismatch_bytes(a_first,a_second,a_length * sizeof(Type)) / sizeof(Type);
+    }
+
+    // first ordered difference, element by element
+    template <typename Type>
+    size_t first_difference(const Type * a_first, const Type * a_second, size_t a_length, std::false_type)
+    {
+        size_t n = 0;
+
+        while ((n < a_length) && !(a_first[n] < a_second[n]) && !(a_second[n] < a_first[n]))
+            ++n;
+
+        return n;
+    }
+
+    //! Find the first ordered difference
+    /*!
+        Returns the first index at which either element is less than the
+        other. Integers, enumerations and pointers are scanned with a
+        vectorized byte kernel; other types are compared with <i>operator <</i>.
+        \param a_first - First sequence
+        \param a_second - Second sequence
+        \param a_length - Number of elements to compare
+        \return Index of the first ordered pair, or <i>a_length</i> if none
+    */
+    template <typename Type>
+    size_t first_difference(const Type * a_first, const Type * a_second, size_t a_length)
+    {
+        return first_difference(a_first,a_second,a_length,typename is_bitwise_comparable<Type>::type());
+    }
+
+    //! Lexicographical comparison of sequences
+    /*!
+        Orders two sequences by their first ordered difference (found with
+        <i>first_difference</i>); a proper prefix orders before the longer
+        sequence.
+        \param a_first - First sequence
+        \param a_first_length - Number of elements in the first sequence
+        \param a_second - Second sequence
+        \param a_second_length - Number of elements in the second sequence
+        \return <i>true</i> if the first sequence orders before the second
+    */
+    template <typename Type>
+    bool less_elements(const Type * a_first, size_t a_first_length, const Type * a_second, size_t a_second_length)
+    {
+        size_t common = (a_first_length < a_second_length) ? a_first_length : a_second_length;
+        size_t n = first_difference(a_first,a_second,common);
+
+        if (n < common)
+            return (a_first[n] < a_second[n]);
+
+        return (a_first_length < a_second_length);
+    }
+
+    // equality with memcmp
+    template <typename Type>
+    bool equal_elements(const Type * a_first, const Type * a_second, size_t a_length, std::true_type)
+    {
+        return (memcmp(a_first,a_second,a_length * sizeof(Type)) == 0);
+    }
+
+    // equality with operator ==
+    template <typename Type>
+    bool equal_elements(const Type * a_first, const Type * a_second, size_t a_length, std::false_type)
+    {
+        for (size_t n = 0; n < a_length; ++n)
+        {
+            if (!(a_first[n] == a_second[n]))
+                return false;
+        }
+
+        return true;
+    }
+
+    //! Compare sequences for equality
+    /*!
+        Integers, enumerations and pointers are compared with <i>memcmp</i>;
+        <i>float</i> and <i>double</i> with vectorized kernels; other types
+        with <i>operator ==</i>.
+        \param a_first - First sequence
+        \param a_second - Second sequence
+        \param a_length - Number of elements to compare
+        \return <i>true</i> if all corresponding elements are equal
+    */
+    template <typename Type>
+    bool equal_elements(const Type * a_first, const Type * a_second, size_t a_length)
+    {
+        return equal_elements(a_first,a_second,a_length,typename is_bitwise_comparable<Type>::type());
+    }
+
+    //! Compare sequences of doubles for equality
+    inline bool equal_elements(const double * a_first, const double * a_second, size_t a_length)
+    {
+        return (first_unequal(a_first,a_second,a_length) == a_length);
+    }
+
+    //! Compare sequences of floats for equality
+    inline bool equal_elements(const float * a_first, const float * a_second, size_t a_length)
+    {
+        return (first_unequal(a_first,a_second,a_length) == a_length);
+    }
+
+    // copy with memcpy
+    template <typename Type>
+    void copy_elements(Type * a_target, const Type * a_source, size_t a_length, std::true_type)
+    {
+        if (a_length > 0)
+            memcpy(static_cast<void *>(a_target),a_source,a_length * sizeof(Type));
+    }
+
+    // copy by assignment
+    template <typename Type>
+    void copy_elements(Type * a_target, const Type * a_source, size_t a_length, std::false_type)
+    {
+        for (size_t n = 0; n < a_length; ++n)
+            a_target[n] = a_source[n];
+    }
+
+    //! Copy elements
+    /*!
+        Copies non-overlapping sequences, with <i>memcpy</i> for trivially
+        copyable types and by assignment otherwise.
+        \param a_target - Destination
+        \param a_source - Source
+        \param a_length - Number of elements to copy
+    */
+    template <typename Type>
+    void copy_elements(Type * a_target, const Type * a_source, size_t a_length)
+    {
+        copy_elements(a_target,a_source,a_length,typename std::is_trivially_copyable<Type>::type());
+    }
+
+    // fill, with memset when every byte of the value is the same
+    template <typename Type>
+    void fill_elements(Type * a_target, size_t a_length, const Type & a_value, std::true_type)
+    {
+        const unsigned char * bytes = reinterpret_cast<const unsigned char *>(&a_value);
+        size_t n = 1;
+
+        while ((n < sizeof(Type)) && (bytes[n] == bytes[0]))
+            ++n;
+
+        if (n == sizeof(Type))
+        {
+            if (a_length > 0)
+                memset(static_cast<void *>(a_target),bytes[0],a_length * sizeof(Type));
+        }
+        else
+        {
+            // simple enough for the compiler to vectorize
+            for (n = 0; n < a_length; ++n)
+                a_target[n] = a_value;
+        }
+    }
+
+    // fill by assignment
+    template <typename Type>
+    void fill_elements(Type * a_target, size_t a_length, const Type & a_value, std::false_type)
+    {
+        for (size_t n = 0; n < a_length; ++n)
+            a_target[n] = a_value;
+    }
+
+    //! Fill elements with a value
+    /*!
+        Assigns a value to a sequence of elements; trivially copyable values
+        made of one repeated byte (zero, for instance) are stored with <i>memset</i>.
+        \param a_target - Destination
+        \param a_length - Number of elements to fill
+        \param a_value - Value assigned to every element
+    */
+    template <typename Type>
+    void fill_elements(Type * a_target, size_t a_length, const Type & a_value)
+    {
+        fill_elements(a_target,a_length,a_value,typename std::is_trivially_copyable<Type>::type());
+    }
+
+} // end namespace libcoyotl
+
+#endif
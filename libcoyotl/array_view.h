@@ -0,0 +1,344 @@
+//---------------------------------------------------------------------
+//  Algorithmic Conjurings @ http://www.coyotegulch.com
+//
+//  array_view.h (libcoyotl)
+//
+//  A non-owning view of contiguous or strided elements, for
+//  zero-copy access to parts of arrays.
+//---------------------------------------------------------------------
+//
+//  Copyright 1990-2005 Scott Robert Ladd
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the
+//      Free Software Foundation, Inc.
+//      59 Temple Place - Suite 330
+//      Boston, MA 02111-1307, USA.
+//
+//-----------------------------------------------------------------------
+//
+//  For more information on this software package, please visit
+//  Scott's web site, Coyote Gulch Productions, at:
+//
+//      http://www.coyotegulch.com
+//
+//-----------------------------------------------------------------------
+
+#if !defined(LIBCOYOTL_ARRAY_VIEW_H)
+#define LIBCOYOTL_ARRAY_VIEW_H
+
+#include <cstddef>
+#include <iterator>
+
+#include "validator.h"
+
+#if defined(LIBCOYOTL_BOUNDS_CHECKING)
+#define LIBCOYOTL_VIEW_EXCEPTIONS validation_error<size_t>
+#define LIBCOYOTL_VIEW_CHECK_INDEX(n) validate_less(n,m_size,LIBCOYOTL_LOCATION);
+#else
+#define LIBCOYOTL_VIEW_EXCEPTIONS
+#define LIBCOYOTL_VIEW_CHECK_INDEX(n)
+#endif
+
+namespace libcoyotl
+{
+    //! Random-access iterator over strided elements
+    /*!
+        Steps through memory <i>stride</i> elements at a time; used by
+        <i>array_view</i>.
+    */
+    template <typename Type>
+    class strided_iterator
+    {
+    public:
+        //! Iterator category
+        typedef std::random_access_iterator_tag iterator_category;
+
+        //! Type of an element
+        typedef Type      value_type;
+
+        //! Difference type between two iterators
+        typedef ptrdiff_t difference_type;
+
+        //! Pointer to an element
+        typedef Type *    pointer;
+
+        //! Reference to an element
+        typedef Type &    reference;
+
+        //! Constructor
+        /*!
+            Creates an iterator at a given element.
+            \param a_element - Element referenced by the iterator
+            \param a_stride - Distance, in elements, between successive elements
+        */
+        strided_iterator(Type * a_element = NULL, ptrdiff_t a_stride = 1) throw()
+          : m_element(a_element),
+            m_stride(a_stride)
+        {
+            // nada
+        }
+
+        //! Dereference
+        Type & operator * () const throw() { return *m_element; }
+
+        //! Member access
+        Type * operator -> () const throw() { return m_element; }
+
+        //! Indexed access
+        Type & operator [] (ptrdiff_t n) const throw() { return m_element[n * m_stride]; }
+
+        //! Pre-increment
+        strided_iterator & operator ++ () throw() { m_element += m_stride; return *this; }
+
+        //! Post-increment
+        strided_iterator operator ++ (int) throw() { strided_iterator result(*this); m_element += m_stride; return result; }
+
+        //! Pre-decrement
+        strided_iterator & operator -- () throw() { m_element -= m_stride; return *this; }
+
+        //! Post-decrement
+        strided_iterator operator -- (int) throw() { strided_iterator result(*this); m_element -= m_stride; return result; }
+
+        //! Advance
+        strided_iterator & operator += (ptrdiff_t n) throw() { m_element += n * m_stride; return *this; }
+
+        //! Retreat
+        strided_iterator & operator -= (ptrdiff_t n) throw() { m_element -= n * m_stride; return *this; }
+
+        //! Offset forward
+        strided_iterator operator + (ptrdiff_t n) const throw() { return strided_iterator(m_element + n * m_stride,m_stride); }
+
+        //! Offset backward
+        strided_iterator operator - (ptrdiff_t n) const throw() { return strided_iterator(m_element - n * m_stride,m_stride); }
+
+        //! Distance between iterators
+        ptrdiff_t operator - (const strided_iterator & a_other) const throw() { return (m_element - a_other.m_element) / m_stride; }
+
+        //! Equality
+        bool operator == (const strided_iterator & a_other) const throw() { return m_element == a_other.m_element; }
+
+        //! Inequality
+        bool operator != (const strided_iterator & a_other) const throw() { return m_element != a_other.m_element; }
+
+        //! Less-than
+        bool operator <  (const strided_iterator & a_other) const throw() { return (m_stride > 0) ? (m_element < a_other.m_element) : (m_element > a_other.m_element); }
+
+        //! Greater-than
+        bool operator >  (const strided_iterator & a_other) const throw() { return a_other < *this; }
+
+        //! Less-than-or-equal-to
+        bool operator <= (const strided_iterator & a_other) const throw() { return !(a_other < *this); }
+
+        //! Greater-than-or-equal-to
+        bool operator >= (const strided_iterator & a_other) const throw() { return !(*this < a_other); }
+
+    private:
+        // current element
+        Type * m_element;
+
+        // distance between elements
+        ptrdiff_t m_stride;
+    };
+
+    //! A non-owning view of array elements
+    /*!
+        Refers to <i>size()</i> elements that begin at <i>data()</i> and lie
+        <i>stride()</i> elements apart, without owning or copying them. Views
+        are cheap to create and to pass by value; every <i>array</i> produces
+        them through its <i>view</i> member, and library algorithms accept
+        them in place of pointer and length pairs. A view is invalidated
+        whenever the storage it refers to is released or reallocated.
+
+        A view of <i>const Type</i> is read-only, and any view converts to
+        one.
+    */
+    template <typename Type>
+    class array_view
+    {
+    public:
+        //! Type of an element
+        typedef Type                       value_type;
+
+        //! Type of a pointer to an element
+        typedef Type *                     pointer;
+
+        //! Type of a reference to an element
+        typedef Type &                     reference;
+
+        //! Difference type between two element pointers
+        typedef ptrdiff_t                  difference_type;
+
+        //! Size type for indexing elements
+        typedef size_t                     size_type;
+
+        //! Iterator type
+        typedef strided_iterator<Type>     iterator;
+
+        //! Constructor
+        /*!
+            Creates a view of elements in memory owned elsewhere.
+            \param a_data - First element, or NULL for an empty view
+            \param a_length - Number of elements in the view
+            \param a_stride - Distance, in elements, between successive elements
+        */
+        array_view(Type * a_data = NULL, size_t a_length = 0, ptrdiff_t a_stride = 1) throw()
+          : m_data(a_data),
+            m_size(a_length),
+            m_stride(a_stride)
+        {
+            // nada
+        }
+
+        //! Conversion to a read-only view
+        /*!
+            Creates a read-only view of the same elements as a writable one.
+            \param a_source - A view of elements of a compatible type
+        */
+        template <typename Other>
+        array_view(const array_view<Other> & a_source) throw()
+          : m_data(a_source.data()),
+            m_size(a_source.size()),
+            m_stride(a_source.stride())
+        {
+            // nada
+        }
+
+        //! First element
+        /*!
+            Returns a pointer to the first element of the view.
+            \return A pointer to the first element
+        */
+        Type * data() const throw()
+        {
+            return m_data;
+        }
+
+        //! Number of elements
+        /*!
+            Returns the number of elements in the view.
+            \return Number of elements
+        */
+        size_t size() const throw()
+        {
+            return m_size;
+        }
+
+        //! Empty view check
+        /*!
+            Checks whether the view contains any elements.
+            \return <i>true</i> if the view has no elements
+        */
+        bool empty() const throw()
+        {
+            return (m_size == 0);
+        }
+
+        //! Distance between elements
+        /*!
+            Returns the distance, in elements, between successive elements of the view.
+            \return Stride of the view
+        */
+        ptrdiff_t stride() const throw()
+        {
+            return m_stride;
+        }
+
+        //! Contiguous view check
+        /*!
+            A contiguous view can be handed to code expecting a pointer and length.
+            \return <i>true</i> if the elements are adjacent in memory
+        */
+        bool is_contiguous() const throw()
+        {
+            return (m_stride == 1) || (m_size <= 1);
+        }
+
+        //! Element access
+        /*!
+            Returns a reference to a specific element in the view.
+            \param n - Index of an element
+            \return A reference to the element at index <i>n</i>
+        */
+        Type & operator [] (size_t n) const throw(LIBCOYOTL_VIEW_EXCEPTIONS)
+        {
+            LIBCOYOTL_VIEW_CHECK_INDEX(n)
+            return m_data[ptrdiff_t(n) * m_stride];
+        }
+
+        //! Obtain beginning-of-sequence iterator
+        iterator begin() const throw()
+        {
+            return iterator(m_data,m_stride);
+        }
+
+        //! Obtain end-of-sequence iterator
+        iterator end() const throw()
+        {
+            return iterator(m_data + ptrdiff_t(m_size) * m_stride,m_stride);
+        }
+
+        //! Subrange
+        /*!
+            Returns a view of consecutive elements of this view.
+            \param a_offset - Index of the first element of the subrange
+            \param a_length - Number of elements in the subrange
+            \return A view of the subrange
+        */
+        array_view subview(size_t a_offset, size_t a_length) const
+        {
+            validate_less_eq(a_offset,m_size,LIBCOYOTL_LOCATION);
+            validate_less_eq(a_length,m_size - a_offset,LIBCOYOTL_LOCATION);
+            return array_view(m_data + ptrdiff_t(a_offset) * m_stride,a_length,m_stride);
+        }
+
+        //! Every <i>n</i>th element
+        /*!
+            Returns a view of every <i>a_step</i>th element of this view,
+            beginning with the first.
+            \param a_step - Distance between selected elements
+            \return A strided view
+        */
+        array_view every(size_t a_step) const
+        {
+            validate_not(a_step,size_t(0),LIBCOYOTL_LOCATION);
+            return array_view(m_data,(m_size + a_step - 1) / a_step,m_stride * ptrdiff_t(a_step));
+        }
+
+    private:
+        // first element
+        Type * m_data;
+
+        // number of elements
+        size_t m_size;
+
+        // distance between elements
+        ptrdiff_t m_stride;
+    };
+
+    //! Create a view of a C-style array
+    /*!
+        A convenience for creating a contiguous view without naming its type.
+        \param a_data - First element
+        \param a_length - Number of elements
+        \return A view of the elements
+    */
+    template <typename Type>
+    inline array_view<Type> make_view(Type * a_data, size_t a_length) throw()
+    {
+        return array_view<Type>(a_data,a_length);
+    }
+
+} // end namespace libcoyotl
+
+#endif
@@ -0,0 +1,169 @@
+//---------------------------------------------------------------------
+//  Algorithmic Conjurings @ http://www.coyotegulch.com
+//
+//  cpu_features.cpp (libcoyotl)
+//
+//  Run-time detection of processor features, and selection of the
+//  best available implementation of a vectorized kernel.
+//---------------------------------------------------------------------
+//
+//  Copyright 1990-2005 Scott Robert Ladd
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the
+//      Free Software Foundation, Inc.
+//      59 Temple Place - Suite 330
+//      Boston, MA 02111-1307, USA.
+//
+//-----------------------------------------------------------------------
+//
+//  For more information on this software package, please visit
+//  Scott's web site, Coyote Gulch Productions, at:
+//
+//      http://www.coyotegulch.com
+//
+//-----------------------------------------------------------------------
+
+// Standard C++ library
+#include <cstdlib>
+#include <cstring>
+
+// libcoyotl
+#include "cpu_features.h"
+
+#if defined(LIBCOYOTL_X86_DISPATCH)
+#include <cpuid.h>
+#include <stdint.h>
+#endif
+
+using namespace libcoyotl;
+
+#if defined(LIBCOYOTL_X86_DISPATCH)
+// read an extended control register; the instruction is emitted directly
+// so this file does not need to be compiled with -mxsave
+static uint64_t read_xcr(uint32_t a_index)
+{
+    uint32_t eax, edx;
+    __asm__ __volatile__ ("xgetbv" : "=a"(eax), "=d"(edx) : "c"(a_index));
+    return (uint64_t(edx) << 32) | eax;
+}
+#endif
+
+//--------------------------------------------------------------------------
+//  Constructor, detecting features
+cpu_features::cpu_features()
+  : m_sse2(false),
+    m_sse41(false),
+    m_sse42(false),
+    m_popcnt(false),
+    m_pclmul(false),
+    m_avx2(false),
+    m_bmi2(false),
+    m_avx512f(false),
+    m_avx512bw(false),
+    m_level(LEVEL_SCALAR)
+{
+#if defined(LIBCOYOTL_X86_DISPATCH)
+    unsigned int eax, ebx, ecx, edx;
+
+    if (__get_cpuid(1,&eax,&ebx,&ecx,&edx))
+    {
+        m_sse2   = (edx & bit_SSE2)   != 0;
+        m_sse41  = (ecx & bit_SSE4_1) != 0;
+        m_sse42  = (ecx & bit_SSE4_2) != 0;
+        m_popcnt = (ecx & bit_POPCNT) != 0;
+        m_pclmul = (ecx & bit_PCLMUL) != 0;
+
+        // wide vector registers are only usable if the OS saves their state
+        bool os_ymm = false;
+        bool os_zmm = false;
+
+        if ((ecx & bit_OSXSAVE) && (ecx & bit_AVX))
+        {
+            uint64_t xcr0 = read_xcr(0);
+            os_ymm = (xcr0 & 0x06) == 0x06;
+            os_zmm = os_ymm && ((xcr0 & 0xE0) == 0xE0);
+        }
+
+        if (__get_cpuid_count(7,0,&eax,&ebx,&ecx,&edx))
+        {
+            m_avx2     = os_ymm && ((ebx & bit_AVX2) != 0);
+            m_bmi2     = (ebx & bit_BMI2) != 0;
+            m_avx512f  = os_zmm && ((ebx & bit_AVX512F)  != 0);
+            m_avx512bw = os_zmm && ((ebx & bit_AVX512BW) != 0);
+        }
+    }
+#endif
+
+    // choose the best level
+    if (m_avx512f && m_avx512bw)
+        m_level = LEVEL_AVX512;
+    else if (m_avx2 && m_bmi2)
+        m_level = LEVEL_AVX2;
+    else if (m_sse2)
+        m_level = LEVEL_SSE2;
+
+    // an environment setting can lower, but never raise, the level
+    const char * cap = getenv("LIBCOYOTL_SIMD");
+
+    if (cap != NULL)
+    {
+        level limit = m_level;
+
+        if (strcmp(cap,"scalar") == 0)
+            limit = LEVEL_SCALAR;
+        else if (strcmp(cap,"sse2") == 0)
+            limit = LEVEL_SSE2;
+        else if (strcmp(cap,"avx2") == 0)
+            limit = LEVEL_AVX2;
+
+        if (limit < m_level)
+            m_level = limit;
+
+        // hide features above the cap, so feature-specific kernels fall back too
+        if (m_level < LEVEL_AVX512)
+            m_avx512f = m_avx512bw = false;
+
+        if (m_level < LEVEL_AVX2)
+            m_avx2 = m_bmi2 = false;
+
+        if (m_level < LEVEL_SSE2)
+            m_sse2 = m_sse41 = m_sse42 = m_popcnt = m_pclmul = false;
+    }
+}
+
+//--------------------------------------------------------------------------
+//  Get the features of the running processor
+const cpu_features & cpu_features::get()
+{
+    // initialized once, on first use
+    static const cpu_features s_features;
+    return s_features;
+}
+
+//--------------------------------------------------------------------------
+//  Get the name of a vector level
+const char * cpu_features::level_name(level a_level)
+{
+    switch (a_level)
+    {
+    case LEVEL_SSE2:
+        return "sse2";
+    case LEVEL_AVX2:
+        return "avx2";
+    case LEVEL_AVX512:
+        return "avx512";
+    default:
+        return "scalar";
+    }
+}
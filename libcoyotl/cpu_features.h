@@ -0,0 +1,180 @@
+//---------------------------------------------------------------------
+//  Algorithmic Conjurings @ http://www.coyotegulch.com
+//
+//  cpu_features.h (libcoyotl)
+//
+//  Run-time detection of processor features, and selection of the
+//  best available implementation of a vectorized kernel.
+//---------------------------------------------------------------------
+//
+//  Copyright 1990-2005 Scott Robert Ladd
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the
+//      Free Software Foundation, Inc.
+//      59 Temple Place - Suite 330
+//      Boston, MA 02111-1307, USA.
+//
+//-----------------------------------------------------------------------
+//
+//  For more information on this software package, please visit
+//  Scott's web site, Coyote Gulch Productions, at:
+//
+//      http://www.coyotegulch.com
+//
+//-----------------------------------------------------------------------
+
+#if !defined(LIBCOYOTL_CPU_FEATURES_H)
+#define LIBCOYOTL_CPU_FEATURES_H
+
+#include <cstddef>
+
+// Kernels for a specific instruction set are compiled with a per-function
+// target attribute, so the library itself needs no special compiler flags.
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define LIBCOYOTL_X86_DISPATCH 1
+#define LIBCOYOTL_TARGET(isa) __attribute__((target(isa)))
+#else
+#define LIBCOYOTL_TARGET(isa)
+#endif
+
+namespace libcoyotl
+{
+    //! Processor features detected at run time
+    /*!
+        Queries the processor (via <i>cpuid</i> and <i>xgetbv</i> on x86) once,
+        the first time <i>get</i> is called, and reports the instruction sets
+        that both the processor and operating system support. The environment
+        variable LIBCOYOTL_SIMD (<i>scalar</i>, <i>sse2</i>, <i>avx2</i> or
+        <i>avx512</i>) caps the level reported by <i>get_level</i> and
+        hides the features above it, which allows fallback kernels to be
+        exercised on any machine. PCLMULQDQ, POPCNT and the SSE4 extensions
+        belong to the SSE2 level.
+    */
+    class cpu_features
+    {
+    public:
+        //! Vector instruction set levels, in increasing order of capability
+        enum level
+        {
+            LEVEL_SCALAR,   //!> Portable C++ only
+            LEVEL_SSE2,     //!> SSE2 (128-bit integer and double vectors)
+            LEVEL_AVX2,     //!> AVX2 (256-bit vectors) with BMI2
+            LEVEL_AVX512    //!> AVX-512 F and BW (512-bit vectors)
+        };
+
+        //! Get the features of the running processor
+        /*!
+            Returns the features detected for this processor; detection
+            happens once, on the first call.
+            \return Detected processor features
+        */
+        static const cpu_features & get();
+
+        //! Get the best usable vector level
+        /*!
+            Returns the most capable vector level supported by the processor,
+            capped by the LIBCOYOTL_SIMD environment variable.
+            \return Best usable vector level
+        */
+        level get_level() const
+        {
+            return m_level;
+        }
+
+        //! Get the name of a vector level
+        /*!
+            Returns a printable name for a vector level.
+            \param a_level - A vector level
+            \return Name of the level
+        */
+        static const char * level_name(level a_level);
+
+        //! SSE2 support
+        bool has_sse2() const { return m_sse2; }
+
+        //! SSE4.1 support
+        bool has_sse41() const { return m_sse41; }
+
+        //! SSE4.2 support
+        bool has_sse42() const { return m_sse42; }
+
+        //! POPCNT support
+        bool has_popcnt() const { return m_popcnt; }
+
+        //! PCLMULQDQ (carry-less multiply) support
+        bool has_pclmul() const { return m_pclmul; }
+
+        //! AVX2 support, including operating system support for YMM state
+        bool has_avx2() const { return m_avx2; }
+
+        //! BMI2 support
+        bool has_bmi2() const { return m_bmi2; }
+
+        //! AVX-512 Foundation support, including operating system support for ZMM state
+        bool has_avx512f() const { return m_avx512f; }
+
+        //! AVX-512 byte and word instruction support
+        bool has_avx512bw() const { return m_avx512bw; }
+
+    private:
+        // detects features; use get()
+        cpu_features();
+
+        bool  m_sse2;
+        bool  m_sse41;
+        bool  m_sse42;
+        bool  m_popcnt;
+        bool  m_pclmul;
+        bool  m_avx2;
+        bool  m_bmi2;
+        bool  m_avx512f;
+        bool  m_avx512bw;
+        level m_level;
+    };
+
+    //! Select the best kernel for the running processor
+    /*!
+        Returns the most capable of the supplied kernels that the running
+        processor supports; a NULL pointer marks a level without a kernel.
+        Callers bind the result to a function pointer once, typically in a
+        static initializer, so that each call costs one indirect jump.
+        \param a_scalar - Portable kernel (must not be NULL)
+        \param a_sse2 - SSE2 kernel, or NULL
+        \param a_avx2 - AVX2 kernel, or NULL
+        \param a_avx512 - AVX-512 kernel, or NULL
+        \return The best usable kernel
+    */
+    template <typename Function>
+    Function select_kernel(Function a_scalar,
+                           Function a_sse2   = NULL,
+                           Function a_avx2   = NULL,
+                           Function a_avx512 = NULL)
+    {
+        cpu_features::level level = cpu_features::get().get_level();
+
+        if ((level >= cpu_features::LEVEL_AVX512) && (a_avx512 != NULL))
+            return a_avx512;
+
+        if ((level >= cpu_features::LEVEL_AVX2) && (a_avx2 != NULL))
+            return a_avx2;
+
+        if ((level >= cpu_features::LEVEL_SSE2) && (a_sse2 != NULL))
+            return a_sse2;
+
+        return a_scalar;
+    }
+
+} // end namespace libcoyotl
+
+#endif
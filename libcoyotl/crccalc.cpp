@@ -39,25 +39,38 @@
 
 // libcoyotl
 #include "crccalc.h"
+#include "cpu_features.h"
+
+#if defined(LIBCOYOTL_X86_DISPATCH)
+#include <immintrin.h>
+#endif
+
 using namespace libcoyotl;
 
-// initialize a CRC table of precalculated values
+// initialize the CRC tables of precalculated values
 crc_calculator::crc_precalc::crc_precalc()
 {
-    for (crc32_t n = 0; n < 256; ++n)
+    for (uint32_t n = 0; n < 256; ++n)
     {
-        crc32_t c = n; // c will be the constant for n
+        uint32_t c = n; // c will be the constant for n
 
         // assumes 8-bit bytes
         for (int bit = 0; bit < 8; ++bit)
         {
             if (c & 1)
-                c = 0xEDB88320L ^ (c >> 1);
+                c = 0xEDB88320UL ^ (c >> 1);
             else
                 c >>= 1;
         }
 
-        m_table[n] = c;
+        m_table[0][n] = c;
+    }
+
+    // each table extends the previous one by a zero byte
+    for (int k = 1; k < 16; ++k)
+    {
+        for (int n = 0; n < 256; ++n)
+            m_table[k][n] = m_table[0][m_table[k - 1][n] & 0xFF] ^ (m_table[k - 1][n] >> 8);
     }
 }
 
@@ -68,7 +81,212 @@ crc_calculator::crc_precalc crc_calculator::s_table;
 crc_calculator::crc_calculator()
 {
     // initialize CRC value
-    m_crc = 0xFFFFFFFFL;
+    m_crc = 0xFFFFFFFFUL;
+}
+
+// read a little-endian 32-bit word; compilers reduce this to one load
+// on little-endian processors, and it needs no alignment
+static inline uint32_t load_word(const unsigned char * a_data)
+{
+    return uint32_t(a_data[0])
+         | (uint32_t(a_data[1]) << 8)
+         | (uint32_t(a_data[2]) << 16)
+         | (uint32_t(a_data[3]) << 24);
+}
+
+// update a CRC one byte at a time
+static uint32_t crc_bytewise(uint32_t crc, const uint32_t * table, const unsigned char * data, size_t len)
+{
+    for (size_t n = 0; n < len; ++n)
+        crc = table[(crc ^ data[n]) & 0xFF] ^ (crc >> 8);
+
+    return crc;
+}
+
+// update a CRC one byte at a time, with the first table
+uint32_t crc_calculator::bytewise(uint32_t crc, const unsigned char * data, size_t len)
+{
+    return crc_bytewise(crc,s_table[0],data,len);
+}
+
+// look up the contributions of the four bytes of a word, the first
+// of which is followed by "after" more bytes
+#define CRC_WORD(w, after) \
+    (s_table[(after) + 3][(w) & 0xFF] ^ s_table[(after) + 2][((w) >> 8) & 0xFF] ^ \
+     s_table[(after) + 1][((w) >> 16) & 0xFF] ^ s_table[(after)][(w) >> 24])
+
+// update a CRC eight bytes at a time; the CRC is folded into the
+// first word, and each byte's table accounts for the bytes after it
+uint32_t crc_calculator::slice_8(uint32_t crc, const unsigned char * data, size_t len)
+{
+    for ( ; len >= 8; len -= 8, data += 8)
+    {
+        uint32_t one = load_word(data) ^ crc;
+        uint32_t two = load_word(data + 4);
+        crc = CRC_WORD(one,4) ^ CRC_WORD(two,0);
+    }
+
+    return crc_bytewise(crc,s_table[0],data,len);
+}
+
+// update a CRC sixteen bytes at a time
+uint32_t crc_calculator::slice_16(uint32_t crc, const unsigned char * data, size_t len)
+{
+    for ( ; len >= 16; len -= 16, data += 16)
+    {
+        uint32_t one   = load_word(data) ^ crc;
+        uint32_t two   = load_word(data + 4);
+        uint32_t three = load_word(data + 8);
+        uint32_t four  = load_word(data + 12);
+        crc = CRC_WORD(one,12) ^ CRC_WORD(two,8) ^ CRC_WORD(three,4) ^ CRC_WORD(four,0);
+    }
+
+    return slice_8(crc,data,len);
+}
+
+#undef CRC_WORD
+
+#if defined(LIBCOYOTL_X86_DISPATCH)
+// Fold a multiple of 16 bytes, at least 64, into a CRC with carry-less
+// multiplies (Gopal et al., "Fast CRC Computation for Generic Polynomials
+// Using PCLMULQDQ Instruction", Intel, 2009). Four 128-bit accumulators
+// are each multiplied by x^512 mod P and combined with the next 64 bytes;
+// they are then folded into one, reduced to 64 bits, and Barrett-reduced
+// to 32 bits. The constants are bit-reflected powers of x modulo P.
+LIBCOYOTL_TARGET("sse2,pclmul")
+static uint32_t fold_pclmul(uint32_t crc, const unsigned char * data, size_t len)
+{
+    const __m128i k1k2 = _mm_set_epi64x(0x01C6E41596LL,0x0154442BD4LL); // x^(512+32), x^(512-32)
+    const __m128i k3k4 = _mm_set_epi64x(0x00CCAA009ELL,0x01751997D0LL); // x^(128+32), x^(128-32)
+    const __m128i k5   = _mm_set_epi64x(0,0x0163CD6124LL);              // x^64
+    const __m128i poly = _mm_set_epi64x(0x01F7011641LL,0x01DB710641LL); // mu, P
+    const __m128i low  = _mm_setr_epi32(~0,0,~0,0);
+
+    __m128i x1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data));
+    __m128i x2 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + 16));
+    __m128i x3 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + 32));
+    __m128i x4 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + 48));
+    x1 = _mm_xor_si128(x1,_mm_cvtsi32_si128(int(crc)));
+
+    data += 64;
+    len  -= 64;
+
+    // fold 64 bytes per step
+    for ( ; len >= 64; data += 64, len -= 64)
+    {
+        __m128i x5 = _mm_clmulepi64_si128(x1,k1k2,0x00);
+        __m128i x6 = _mm_clmulepi64_si128(x2,k1k2,0x00);
+        __m128i x7 = _mm_clmulepi64_si128(x3,k1k2,0x00);
+        __m128i x8 = _mm_clmulepi64_si128(x4,k1k2,0x00);
+
+        x1 = _mm_clmulepi64_si128(x1,k1k2,0x11);
+        x2 = _mm_clmulepi64_si128(x2,k1k2,0x11);
+        x3 = _mm_clmulepi64_si128(x3,k1k2,0x11);
+        x4 = _mm_clmulepi64_si128(x4,k1k2,0x11);
+
+        x1 = _mm_xor_si128(_mm_xor_si128(x1,x5),_mm_loadu_si128(reinterpret_cast<const __m128i *>(data)));
+        x2 = _mm_xor_si128(_mm_xor_si128(x2,x6),_mm_loadu_si128(reinterpret_cast<const __m128i *>(data + 16)));
+        x3 = _mm_xor_si128(_mm_xor_si128(x3,x7),_mm_loadu_si128(reinterpret_cast<const __m128i *>(data + 32)));
+        x4 = _mm_xor_si128(_mm_xor_si128(x4,x8),_mm_loadu_si128(reinterpret_cast<const __m128i *>(data + 48)));
+    }
+
+    // fold the accumulators into one, then any remaining 16-byte blocks
+    __m128i next[3] = { x2, x3, x4 };
+
+    for (int i = 0; i < 3; ++i)
+    {
+        __m128i x5 = _mm_clmulepi64_si128(x1,k3k4,0x00);
+        x1 = _mm_clmulepi64_si128(x1,k3k4,0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1,x5),next[i]);
+    }
+
+    for ( ; len >= 16; data += 16, len -= 16)
+    {
+        __m128i x5 = _mm_clmulepi64_si128(x1,k3k4,0x00);
+        x1 = _mm_clmulepi64_si128(x1,k3k4,0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1,x5),_mm_loadu_si128(reinterpret_cast<const __m128i *>(data)));
+    }
+
+    // reduce 128 bits to 64
+    x2 = _mm_clmulepi64_si128(x1,k3k4,0x10);
+    x1 = _mm_xor_si128(_mm_srli_si128(x1,8),x2);
+
+    x2 = _mm_srli_si128(x1,4);
+    x1 = _mm_clmulepi64_si128(_mm_and_si128(x1,low),k5,0x00);
+    x1 = _mm_xor_si128(x1,x2);
+
+    // Barrett reduction to 32 bits
+    x2 = _mm_clmulepi64_si128(_mm_and_si128(x1,low),poly,0x10);
+    x2 = _mm_clmulepi64_si128(_mm_and_si128(x2,low),poly,0x00);
+    x1 = _mm_xor_si128(x1,x2);
+
+    return uint32_t(_mm_cvtsi128_si32(_mm_srli_si128(x1,4)));
+}
+#endif
+
+// update a CRC by folding 64 bytes per step, where the processor
+// supports carry-less multiplies; slicing handles the rest
+uint32_t crc_calculator::fold(uint32_t crc, const unsigned char * data, size_t len)
+{
+#if defined(LIBCOYOTL_X86_DISPATCH)
+    if ((len >= 64) && cpu_features::get().has_pclmul())
+    {
+        size_t blocks = len & ~size_t(15);
+        crc   = fold_pclmul(crc,data,blocks);
+        data += blocks;
+        len  -= blocks;
+    }
+#endif
+
+    return slice_16(crc,data,len);
+}
+
+// self-test data: lengths up to this, at several alignments
+static const size_t SELF_TEST_LENGTH = 320;
+static const size_t SELF_TEST_OFFSET = 16;
+
+// check that two kernels agree on the self-test data
+bool crc_calculator::agree(kernel a_first, kernel a_second)
+{
+    unsigned char data[SELF_TEST_LENGTH + SELF_TEST_OFFSET];
+    uint32_t x = 0x12345678UL;
+
+    for (size_t n = 0; n < sizeof(data); ++n)
+    {
+        x = x * 1664525UL + 1013904223UL;
+        data[n] = (unsigned char)(x >> 24);
+    }
+
+    for (size_t offset = 0; offset < SELF_TEST_OFFSET; offset += 5)
+    {
+        for (size_t len = 0; len <= SELF_TEST_LENGTH; ++len)
+        {
+            if (a_first(0xFFFFFFFFUL,data + offset,len) != a_second(0xFFFFFFFFUL,data + offset,len))
+                return false;
+        }
+    }
+
+    return true;
+}
+
+// the kernel used by update, chosen on first use; folding must match the
+// tables before it is trusted
+crc_calculator::kernel crc_calculator::active_kernel()
+{
+    static const kernel s_kernel = (cpu_features::get().has_pclmul() && agree(fold,slice_16)) ? fold : slice_16;
+    return s_kernel;
+}
+
+// get the method used by update
+crc_calculator::method crc_calculator::get_method()
+{
+    return (active_kernel() == fold) ? FOLD : SLICE_16;
+}
+
+// compare every method against the bytewise method
+bool crc_calculator::self_test()
+{
+    return agree(bytewise,slice_8) && agree(bytewise,slice_16) && agree(bytewise,fold);
 }
 
 // update CRC value based on an array of bytes
@@ -77,7 +295,43 @@ void crc_calculator::update(const unsigned char * data, size_t len)
     if (data == NULL)
         return;
 
-    for (size_t n = 0; n < len; ++n)
-        m_crc = s_table[(m_crc ^ data[n]) & 0xFF] ^ (m_crc >> 8);
+    m_crc = active_kernel()(m_crc,data,len);
 }
 
+// update CRC value based on an array of bytes, with a specific method
+void crc_calculator::update(const unsigned char * data, size_t len, method a_method)
+{
+    if (data == NULL)
+        return;
+
+    switch (a_method)
+    {
+    case BYTEWISE:
+        m_crc = bytewise(m_crc,data,len);
+        break;
+    case SLICE_8:
+        m_crc = slice_8(m_crc,data,len);
+        break;
+    case FOLD:
+        m_crc = fold(m_crc,data,len);
+        break;
+    default:
+        m_crc = slice_16(m_crc,data,len);
+        break;
+    }
+}
+
+// update CRC value based on a view of bytes
+void crc_calculator::update(array_view<const unsigned char> data)
+{
+    if (data.is_contiguous())
+    {
+        update(data.data(),data.size());
+        return;
+    }
+
+    const uint32_t * table = s_table[0];
+
+    for (size_t n = 0; n < data.size(); ++n)
+        m_crc = table[(m_crc ^ data[n]) & 0xFF] ^ (m_crc >> 8);
+}
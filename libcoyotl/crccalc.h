@@ -37,6 +37,10 @@
 #if !defined(LIBCOYOTL_CRCCALC_H)
 #define LIBCOYOTL_CRCCALC_H
 
+#include <stdint.h>
+
+#include "array_view.h"
+
 namespace libcoyotl
 {
     //! 32-bit unsigned value for holding CRC value
@@ -45,7 +49,12 @@ namespace libcoyotl
     //! Calculate 32-bit CRC values from byte data
     /*!
         Calculates a 32-bit CRC value using the algorithm specified by 
-        ISO 3309, and as used by the PNG graphics specification.
+        ISO 3309, and as used by the PNG graphics specification. Long
+        arrays are folded 64 bytes per step with carry-less multiplies
+        on processors with PCLMULQDQ, and otherwise processed 16 bytes
+        per step ("slicing-by-16") with sixteen tables of 32-bit values.
+        Every method gives the same CRC; the first update checks the
+        folding method against the tables before using it.
         \version 1.1.0
         \date    15 June 2002
     */
@@ -59,18 +68,28 @@ namespace libcoyotl
                 // constructor
                 crc_precalc();
             
-                // return element of table
-                crc32_t operator [] (int n) const
+                // return a table; table k holds the CRCs of each byte
+                // followed by k zero bytes
+                const uint32_t * operator [] (int k) const
                 {
-                    return m_table[n];
+                    return m_table[k];
                 }
             
             protected:
-                // table of precalculated values
-                crc32_t m_table[256];
+                // tables of precalculated values
+                uint32_t m_table[16][256];
             };
         
         public:
+            //! Methods of processing byte arrays
+            enum method
+            {
+                BYTEWISE,   //!> One byte per step, with one table
+                SLICE_8,    //!> Eight bytes per step, with eight tables
+                SLICE_16,   //!> Sixteen bytes per step, with sixteen tables
+                FOLD        //!> 64 bytes per step, with carry-less multiplies (SLICE_16 if unsupported)
+            };
+
             //! Constrctor
             /*!
                 Constructs a new CRC value with a base value of 0xFFFFFFFF.
@@ -87,6 +106,42 @@ namespace libcoyotl
             */  
             void update(const unsigned char * a_data, size_t a_length);
         
+            //! Update CRC for a given data set with a specific method
+            /*!
+                Updates the crc value from the bytes provided in <i>data</i>,
+                processing them with the given method; intended for testing
+                and benchmarks, since every method produces the same CRC.
+                \param a_data - Array of bytes to be "added" to the CRC value
+                \param a_length - Number of bytes in the <i>data</i> array
+                \param a_method - Method of processing the bytes
+            */  
+            void update(const unsigned char * a_data, size_t a_length, method a_method);
+        
+            //! Get the method used by update
+            /*!
+                Returns the method chosen for this processor: FOLD where
+                carry-less multiplies are supported and pass the self-test,
+                and SLICE_16 otherwise.
+                \return Method used by update
+            */
+            static method get_method();
+        
+            //! Compare every method against the bytewise method
+            /*!
+                Computes CRCs of test data of many lengths and alignments
+                with every method, comparing them to the bytewise CRCs.
+                \return <i>true</i> if all methods agree
+            */
+            static bool self_test();
+        
+            //! Update CRC for a view of bytes
+            /*!
+                Updates the crc value from the bytes in a view, which may be
+                strided.
+                \param a_data - View of bytes to be "added" to the CRC value
+            */  
+            void update(array_view<const unsigned char> a_data);
+        
             //! Get CRC value
             /*!
                 Returns the current 32-bit CRC value. This value will change
@@ -95,15 +150,34 @@ namespace libcoyotl
             */
             crc32_t get_crc32()
             {
-                return m_crc ^ 0xFFFFFFFFL;
+                return crc32_t(m_crc ^ 0xFFFFFFFFUL);
             }
         
         private:
-            // precacluated table
+            // function updating a CRC value from an array of bytes
+            typedef uint32_t (*kernel)(uint32_t a_crc, const unsigned char * a_data, size_t a_length);
+
+            // update a CRC value one byte per step
+            static uint32_t bytewise(uint32_t a_crc, const unsigned char * a_data, size_t a_length);
+
+            // update a CRC value, 8 or 16 bytes per step
+            static uint32_t slice_8(uint32_t a_crc, const unsigned char * a_data, size_t a_length);
+            static uint32_t slice_16(uint32_t a_crc, const unsigned char * a_data, size_t a_length);
+
+            // update a CRC value 64 bytes per step, with carry-less multiplies
+            static uint32_t fold(uint32_t a_crc, const unsigned char * a_data, size_t a_length);
+
+            // check that two kernels agree on the self-test data
+            static bool agree(kernel a_first, kernel a_second);
+
+            // the kernel used by update, chosen on first use
+            static kernel active_kernel();
+
+            // precacluated tables
             static crc_precalc s_table;
     
             // computed CRC value
-            crc32_t m_crc;
+            uint32_t m_crc;
     };
     
 } // end namespace libcoyotl
@@ -0,0 +1,343 @@
+//---------------------------------------------------------------------
+//  Algorithmic Conjurings @ http://www.coyotegulch.com
+//
+//  external_sort.cpp (libcoyotl)
+//
+//  Sorting files of fixed-size records that are larger than memory,
+//  with asynchronous, double-buffered file input and output.
+//---------------------------------------------------------------------
+//
+//  Copyright 1990-2005 Scott Robert Ladd
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the
+//      Free Software Foundation, Inc.
+//      59 Temple Place - Suite 330
+//      Boston, MA 02111-1307, USA.
+//
+//-----------------------------------------------------------------------
+//
+//  For more information on this software package, please visit
+//  Scott's web site, Coyote Gulch Productions, at:
+//
+//      http://www.coyotegulch.com
+//
+//-----------------------------------------------------------------------
+
+
+// Standard C++ library
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+// POSIX
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// libcoyotl
+#include "external_sort.h"
+
+using namespace libcoyotl;
+using namespace std;
+
+// build an exception message from errno
+static runtime_error system_error_for(const char * a_operation, const string & a_filename)
+{
+    return runtime_error(string(a_operation) + " failed for " + a_filename + ": " + strerror(errno));
+}
+
+//--------------------------------------------------------------------------
+//  Constructor, starting the worker thread
+async_io::async_io()
+  : m_stopping(false)
+{
+    m_worker = thread(&async_io::serve,this);
+}
+
+//--------------------------------------------------------------------------
+//  Destructor, finishing queued requests
+async_io::~async_io() throw()
+{
+    {
+        lock_guard<mutex> guard(m_lock);
+        m_stopping = true;
+    }
+
+    m_ready.notify_one();
+    m_worker.join();
+}
+
+//--------------------------------------------------------------------------
+//  Queue a read
+future<size_t> async_io::read(int a_fd, void * a_buffer, size_t a_bytes, uint64_t a_offset)
+{
+    return submit(a_fd,a_buffer,a_bytes,a_offset,false);
+}
+
+//--------------------------------------------------------------------------
+//  Queue a write
+future<size_t> async_io::write(int a_fd, const void * a_buffer, size_t a_bytes, uint64_t a_offset)
+{
+    return submit(a_fd,const_cast<void *>(a_buffer),a_bytes,a_offset,true);
+}
+
+//--------------------------------------------------------------------------
+//  Queue a request
+future<size_t> async_io::submit(int a_fd, void * a_buffer, size_t a_bytes, uint64_t a_offset, bool a_write)
+{
+    future<size_t> result;
+
+    {
+        lock_guard<mutex> guard(m_lock);
+
+        m_queue.push_back(request());
+        request & r = m_queue.back();
+        r.m_fd     = a_fd;
+        r.m_buffer = a_buffer;
+        r.m_bytes  = a_bytes;
+        r.m_offset = a_offset;
+        r.m_write  = a_write;
+        result = r.m_done.get_future();
+    }
+
+    m_ready.notify_one();
+    return result;
+}
+
+//--------------------------------------------------------------------------
+//  Worker thread: carry out requests until told to stop
+void async_io::serve()
+{
+    while (true)
+    {
+        request r;
+
+        {
+            unique_lock<mutex> guard(m_lock);
+
+            while (m_queue.empty() && !m_stopping)
+                m_ready.wait(guard);
+
+            if (m_queue.empty())
+                return;
+
+            r = move(m_queue.front());
+            m_queue.pop_front();
+        }
+
+        // transfer everything, resuming after signals and short counts
+        char * buffer = static_cast<char *>(r.m_buffer);
+        size_t done   = 0;
+        bool   failed = false;
+
+        while (done < r.m_bytes)
+        {
+            ssize_t n = r.m_write ? pwrite(r.m_fd,buffer + done,r.m_bytes - done,off_t(r.m_offset + done))
+                                  : pread(r.m_fd,buffer + done,r.m_bytes - done,off_t(r.m_offset + done));
+
+            if (n < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+
+                r.m_done.set_exception(make_exception_ptr(runtime_error(string(r.m_write ? "write" : "read")
+                                                                        + " failed: " + strerror(errno))));
+                failed = true;
+                break;
+            }
+
+            // end of file
+            if (n == 0)
+                break;
+
+            done += size_t(n);
+        }
+
+        if (!failed)
+            r.m_done.set_value(done);
+    }
+}
+
+//--------------------------------------------------------------------------
+//  Constructor, opening a file
+async_file::async_file(async_io & a_io, const string & a_filename, mode a_mode)
+  : m_io(&a_io),
+    m_fd(-1),
+    m_owner(true),
+    m_name(a_filename)
+{
+    if (a_mode == WRITE)
+        m_fd = open(a_filename.c_str(),O_WRONLY | O_CREAT | O_TRUNC,0644);
+    else
+        m_fd = open(a_filename.c_str(),O_RDONLY);
+
+    if (m_fd < 0)
+        throw system_error_for("open",a_filename);
+}
+
+//--------------------------------------------------------------------------
+//  Constructor, taking an open descriptor
+async_file::async_file(async_io & a_io, int a_fd, const string & a_name, bool a_owner)
+  : m_io(&a_io),
+    m_fd(a_fd),
+    m_owner(a_owner),
+    m_name(a_name)
+{
+    // nada
+}
+
+//--------------------------------------------------------------------------
+//  Move constructor
+async_file::async_file(async_file && a_source) throw()
+  : m_io(a_source.m_io),
+    m_fd(a_source.m_fd),
+    m_owner(a_source.m_owner),
+    m_name(move(a_source.m_name)),
+    m_pending(move(a_source.m_pending))
+{
+    a_source.m_fd = -1;
+}
+
+//--------------------------------------------------------------------------
+//  Destructor
+async_file::~async_file() throw()
+{
+    close();
+}
+
+//--------------------------------------------------------------------------
+//  Move assignment
+async_file & async_file::operator = (async_file && a_source) throw()
+{
+    if (this != &a_source)
+    {
+        close();
+        m_io          = a_source.m_io;
+        m_fd          = a_source.m_fd;
+        m_owner       = a_source.m_owner;
+        m_name        = move(a_source.m_name);
+        m_pending     = move(a_source.m_pending);
+        a_source.m_fd = -1;
+    }
+
+    return *this;
+}
+
+//--------------------------------------------------------------------------
+//  Create a temporary file
+async_file async_file::temporary(async_io & a_io, const string & a_directory)
+{
+    string directory(a_directory);
+
+    if (directory.empty())
+    {
+        const char * tmpdir = getenv("TMPDIR");
+        directory = ((tmpdir != NULL) && (*tmpdir != 0)) ? tmpdir : "/tmp";
+    }
+
+    string name = directory + "/libcoyotl-XXXXXX";
+    vector<char> pattern(name.begin(),name.end());
+    pattern.push_back(0);
+
+    int fd = mkstemp(&pattern[0]);
+
+    if (fd < 0)
+        throw system_error_for("mkstemp",name);
+
+    // the file lives on, nameless, until closed
+    unlink(&pattern[0]);
+
+    return async_file(a_io,fd,string(&pattern[0]));
+}
+
+//--------------------------------------------------------------------------
+//  Another handle to the same file
+async_file async_file::share() const
+{
+    return async_file(*m_io,m_fd,m_name,false);
+}
+
+//--------------------------------------------------------------------------
+//  Give back the disk space of a range
+void async_file::discard(uint64_t a_offset, uint64_t a_bytes)
+{
+#if defined(FALLOC_FL_PUNCH_HOLE)
+    // only an economy; the range is merely left in place if this fails
+    fallocate(m_fd,FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,off_t(a_offset),off_t(a_bytes));
+#else
+    (void)a_offset;
+    (void)a_bytes;
+#endif
+}
+
+//--------------------------------------------------------------------------
+//  Size of the file
+uint64_t async_file::size() const
+{
+    struct stat info;
+
+    if (fstat(m_fd,&info) != 0)
+        throw system_error_for("fstat",m_name);
+
+    return uint64_t(info.st_size);
+}
+
+//--------------------------------------------------------------------------
+//  Start reading a block
+void async_file::start_read(void * a_buffer, size_t a_bytes, uint64_t a_offset)
+{
+    wait();
+    m_pending = m_io->read(m_fd,a_buffer,a_bytes,a_offset);
+}
+
+//--------------------------------------------------------------------------
+//  Start writing a block
+void async_file::start_write(const void * a_buffer, size_t a_bytes, uint64_t a_offset)
+{
+    wait();
+    m_pending = m_io->write(m_fd,a_buffer,a_bytes,a_offset);
+}
+
+//--------------------------------------------------------------------------
+//  Complete the pending transfer
+size_t async_file::wait()
+{
+    if (!m_pending.valid())
+        return 0;
+
+    try
+    {
+        return m_pending.get();
+    }
+    catch (runtime_error & error)
+    {
+        throw runtime_error(string(error.what()) + " (" + m_name + ")");
+    }
+}
+
+//--------------------------------------------------------------------------
+//  Wait for any pending transfer and close
+void async_file::close() throw()
+{
+    if (m_pending.valid())
+        m_pending.wait();
+
+    m_pending = future<size_t>();
+
+    if ((m_fd >= 0) && m_owner)
+        ::close(m_fd);
+
+    m_fd = -1;
+}
@@ -0,0 +1,638 @@
+//---------------------------------------------------------------------
+//  Algorithmic Conjurings @ http://www.coyotegulch.com
+//
+//  external_sort.h (libcoyotl)
+//
+//  Sorting files of fixed-size records that are larger than memory,
+//  with asynchronous, double-buffered file input and output.
+//---------------------------------------------------------------------
+//
+//  Copyright 1990-2005 Scott Robert Ladd
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the
+//      Free Software Foundation, Inc.
+//      59 Temple Place - Suite 330
+//      Boston, MA 02111-1307, USA.
+//
+//-----------------------------------------------------------------------
+//
+//  For more information on this software package, please visit
+//  Scott's web site, Coyote Gulch Productions, at:
+//
+//      http://www.coyotegulch.com
+//
+//-----------------------------------------------------------------------
+
+
+#if !defined(LIBCOYOTL_EXTERNAL_SORT_H)
+#define LIBCOYOTL_EXTERNAL_SORT_H
+
+#include <cstddef>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <condition_variable>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include <stdint.h>
+
+#include "realutil.h"
+#include "sortutil.h"
+
+namespace libcoyotl
+{
+    //! A thread that performs file reads and writes in the background
+    /*!
+        Requests are queued and carried out one at a time, in the order
+        they were made, on a single worker thread; each request returns a
+        future that yields the number of bytes transferred once it is
+        complete, or rethrows the <i>std::runtime_error</i> describing its
+        failure. One thread serves any number of files, so a merge of
+        hundreds of files does not create hundreds of threads.
+    */
+    class async_io
+    {
+    public:
+        //! Constructor
+        /*!
+            Starts the worker thread.
+        */
+        async_io();
+
+        //! Destructor
+        /*!
+            Completes every queued request, then stops the worker thread.
+        */
+        ~async_io() throw();
+
+        //! Queue a read
+        /*!
+            Reads up to <i>a_bytes</i> bytes at an offset in a file; fewer
+            bytes are read only at the end of the file.
+            \param a_fd - File descriptor
+            \param a_buffer - Destination; must remain valid until the read completes
+            \param a_bytes - Number of bytes to read
+            \param a_offset - Offset in the file of the first byte
+            \return Future number of bytes read
+        */
+        std::future<size_t> read(int a_fd, void * a_buffer, size_t a_bytes, uint64_t a_offset);
+
+        //! Queue a write
+        /*!
+            Writes bytes at an offset in a file.
+            \param a_fd - File descriptor
+            \param a_buffer - Source; must remain valid and unchanged until the write completes
+            \param a_bytes - Number of bytes to write
+            \param a_offset - Offset in the file of the first byte
+            \return Future number of bytes written
+        */
+        std::future<size_t> write(int a_fd, const void * a_buffer, size_t a_bytes, uint64_t a_offset);
+
+    private:
+        // no copies
+        async_io(const async_io &);
+        async_io & operator = (const async_io &);
+
+        // a queued request
+        struct request
+        {
+            int                  m_fd;
+            void *               m_buffer;
+            size_t               m_bytes;
+            uint64_t             m_offset;
+            bool                 m_write;
+            std::promise<size_t> m_done;
+        };
+
+        // queues a request
+        std::future<size_t> submit(int a_fd, void * a_buffer, size_t a_bytes, uint64_t a_offset, bool a_write);
+
+        // worker thread body
+        void serve();
+
+        std::mutex              m_lock;
+        std::condition_variable m_ready;
+        std::deque<request>     m_queue;
+        bool                    m_stopping;
+        std::thread             m_worker;
+    };
+
+    //! A file read or written asynchronously, one block at a time
+    /*!
+        Wraps a file descriptor whose reads and writes are carried out by
+        an <i>async_io</i> thread. At most one transfer is pending at a
+        time; <i>wait</i> completes it. Alternating transfers between two
+        buffers, while working on the other one, overlaps input and output
+        with computation. Failures throw <i>std::runtime_error</i>.
+    */
+    class async_file
+    {
+    public:
+        //! How a file is opened
+        enum mode
+        {
+            READ,   //!> An existing file, for reading
+            WRITE   //!> A new or truncated file, for writing
+        };
+
+        //! Constructor
+        /*!
+            Opens a file.
+            \param a_io - Thread that performs the transfers; must outlive the file
+            \param a_filename - Name of the file
+            \param a_mode - READ or WRITE
+        */
+        async_file(async_io & a_io, const std::string & a_filename, mode a_mode);
+
+        //! Move constructor
+        /*!
+            Takes over the file of another object, which is left closed.
+            \param a_source - The source object
+        */
+        async_file(async_file && a_source) throw();
+
+        //! Destructor
+        /*!
+            Waits for any pending transfer, ignoring its outcome, and
+            closes the file.
+        */
+        ~async_file() throw();
+
+        //! Move assignment
+        /*!
+            Closes the target's file and takes over the source's.
+            \param a_source - The source object
+        */
+        async_file & operator = (async_file && a_source) throw();
+
+        //! Create a temporary file
+        /*!
+            Creates a uniquely named file for reading and writing, and
+            removes its name at once, so the file disappears when it is
+            closed, even if the program is killed.
+            \param a_io - Thread that performs the transfers; must outlive the file
+            \param a_directory - Directory for the file; if empty, $TMPDIR or /tmp
+            \return The open temporary file
+        */
+        static async_file temporary(async_io & a_io, const std::string & a_directory = std::string());
+
+        //! Another handle to the same file
+        /*!
+            Returns a handle that shares this file's descriptor rather than
+            opening it again, and has its own pending transfer; handles let
+            several transfers on one file be pending at once. The handle
+            never closes the file, and must not outlive this object.
+            \return A handle to this file
+        */
+        async_file share() const;
+
+        //! Give back the disk space of a range of bytes
+        /*!
+            Frees the blocks holding a range that is no longer needed, where
+            the file system supports it; the file keeps its size, and the
+            range reads as zeros. No transfer may be pending on the range.
+            \param a_offset - Offset in the file of the first byte
+            \param a_bytes - Number of bytes
+        */
+        void discard(uint64_t a_offset, uint64_t a_bytes);
+
+        //! Size of the file, in bytes
+        uint64_t size() const;
+
+        //! Start reading a block
+        /*!
+            Starts reading <i>a_bytes</i> bytes at an offset; <i>wait</i>
+            returns fewer only at the end of the file.
+            \param a_buffer - Destination; untouchable until <i>wait</i> returns
+            \param a_bytes - Number of bytes to read
+            \param a_offset - Offset in the file of the first byte
+        */
+        void start_read(void * a_buffer, size_t a_bytes, uint64_t a_offset);
+
+        //! Start writing a block
+        /*!
+            Starts writing <i>a_bytes</i> bytes at an offset.
+            \param a_buffer - Source; untouchable until <i>wait</i> returns
+            \param a_bytes - Number of bytes to write
+            \param a_offset - Offset in the file of the first byte
+        */
+        void start_write(const void * a_buffer, size_t a_bytes, uint64_t a_offset);
+
+        //! Is a transfer pending?
+        bool is_pending() const
+        {
+            return m_pending.valid();
+        }
+
+        //! Complete the pending transfer
+        /*!
+            Waits for the pending transfer and reports its outcome; returns
+            zero at once if none is pending.
+            \return Number of bytes transferred
+        */
+        size_t wait();
+
+        //! Name of the file
+        const std::string & name() const
+        {
+            return m_name;
+        }
+
+    private:
+        // an open descriptor, closed at the end if a_owner
+        async_file(async_io & a_io, int a_fd, const std::string & a_name, bool a_owner = true);
+
+        // no copies
+        async_file(const async_file &);
+        async_file & operator = (const async_file &);
+
+        // waits and closes
+        void close() throw();
+
+        async_io *          m_io;
+        int                 m_fd;
+        bool                m_owner;
+        std::string         m_name;
+        std::future<size_t> m_pending;
+    };
+
+    //! Sorts files of fixed-size records that do not fit in memory
+    /*!
+        Sorts a file holding an array of <i>Record</i>s (trivially copyable
+        objects, compared with <i>operator <</i>) within a fixed memory
+        budget. Records are read into one of two halves of the budget while
+        the other half is sorted with <i>quick_sort</i> and written out as a
+        run. Every run goes to its own place in one temporary file, so the
+        sort holds the same few files open however many runs it makes. A
+        k-way merge through a <i>loser_tree</i>
+        then combines the runs, each read through two blocks, so that the
+        next block arrives while the current one is merged; output is
+        written the same way. When there are too many runs for blocks of
+        at least <i>MIN_BLOCK</i> bytes, groups of runs are merged into
+        longer runs first, appended to the temporary file; the space of the
+        runs they consume is given back. A file that fits in the budget is simply sorted
+        in memory. All reads and writes run on a background thread.
+    */
+    template <class Record>
+    class external_sorter
+    {
+    public:
+        static_assert(std::is_trivially_copyable<Record>::value, "external_sorter records must be trivially copyable");
+
+        //! Smallest merge block, in bytes
+        static const size_t MIN_BLOCK = size_t(1) << 16;
+
+        //! Constructor
+        /*!
+            Creates a sorter.
+            \param a_memory_budget - Bytes of memory for records and buffers
+            \param a_temp_directory - Directory for runs; if empty, $TMPDIR or /tmp
+        */
+        external_sorter(size_t a_memory_budget = size_t(1) << 28,
+                        const std::string & a_temp_directory = std::string())
+          : m_memory_budget(a_memory_budget),
+            m_temp_directory(a_temp_directory),
+            m_records(0),
+            m_runs(0),
+            m_merges(0)
+        {
+            // nada
+        }
+
+        //! Sort a file
+        /*!
+            Sorts the records of one file into another, which is created
+            or replaced; the two may be the same file.
+            \param a_input - Name of the file to sort
+            \param a_output - Name of the sorted file
+        */
+        void sort(const std::string & a_input, const std::string & a_output);
+
+        //! Records in the last file sorted
+        uint64_t get_records() const
+        {
+            return m_records;
+        }
+
+        //! Runs written while sorting the last file; zero if it fit in memory
+        size_t get_runs() const
+        {
+            return m_runs;
+        }
+
+        //! Merges performed while sorting the last file
+        size_t get_merges() const
+        {
+            return m_merges;
+        }
+
+    private:
+        // a sorted run in the temporary file, read and written
+        // through a handle of its own
+        struct run
+        {
+            async_file m_file;
+            uint64_t   m_offset;
+            uint64_t   m_bytes;
+        };
+
+        // reads a run through two blocks
+        class cursor
+        {
+        public:
+            cursor()
+              : m_run(NULL),
+                m_offset(0),
+                m_block(0),
+                m_current(0),
+                m_position(NULL),
+                m_end(NULL)
+            {
+                m_blocks[0] = m_blocks[1] = NULL;
+            }
+
+            // starts reading the first block
+            void open(run & a_run, Record * a_first, Record * a_second, size_t a_block)
+            {
+                m_run       = &a_run;
+                m_blocks[0] = a_first;
+                m_blocks[1] = a_second;
+                m_block     = a_block;
+                m_current   = 1;
+                request(0);
+            }
+
+            // moves to the next block, returning its first record
+            // or NULL at the end of the run; the following block
+            // is requested at once
+            const Record * next_block()
+            {
+                if (!m_run->m_file.is_pending())
+                    return m_position = m_end = NULL;
+
+                size_t bytes = m_run->m_file.wait();
+                m_current  = 1 - m_current;
+                m_position = m_blocks[m_current];
+                m_end      = m_position + bytes / sizeof(Record);
+                request(1 - m_current);
+                return m_position;
+            }
+
+            // the next record, or NULL at the end of the run
+            const Record * next()
+            {
+                if (++m_position < m_end)
+                    return m_position;
+
+                return next_block();
+            }
+
+        private:
+            // requests the next block of the run into a buffer
+            void request(size_t a_buffer)
+            {
+                if (m_offset < m_run->m_bytes)
+                {
+                    size_t bytes = size_t(min_of<uint64_t>(uint64_t(m_block) * sizeof(Record),m_run->m_bytes - m_offset));
+                    m_run->m_file.start_read(m_blocks[a_buffer],bytes,m_run->m_offset + m_offset);
+                    m_offset += bytes;
+                }
+            }
+
+            run *          m_run;
+            uint64_t       m_offset;
+            Record *       m_blocks[2];
+            size_t         m_block;
+            size_t         m_current;
+            const Record * m_position;
+            const Record * m_end;
+        };
+
+        // reads a whole block, failing at a premature end of file
+        static void read_fully(async_file & a_file, void * a_buffer, size_t a_bytes, uint64_t a_offset);
+
+        // creates sorted runs from the input file, one after another in a_temp
+        void make_runs(async_file & a_input, uint64_t a_bytes, std::vector<Record> & a_memory, async_file & a_temp, std::deque<run> & a_runs);
+
+        // merges runs into a file, starting at an offset
+        void merge(run * const * a_runs, size_t k, async_file & a_output, uint64_t a_offset, std::vector<Record> & a_memory);
+
+        size_t      m_memory_budget;
+        std::string m_temp_directory;
+        uint64_t    m_records;
+        size_t      m_runs;
+        size_t      m_merges;
+    };
+
+    // read a whole block
+    template <class Record>
+    void external_sorter<Record>::read_fully(async_file & a_file, void * a_buffer, size_t a_bytes, uint64_t a_offset)
+    {
+        a_file.start_read(a_buffer,a_bytes,a_offset);
+
+        if (a_file.wait() != a_bytes)
+            throw std::runtime_error("unexpected end of file in " + a_file.name());
+    }
+
+    // create sorted runs
+    template <class Record>
+    void external_sorter<Record>::make_runs(async_file & a_input, uint64_t a_bytes, std::vector<Record> & a_memory, async_file & a_temp, std::deque<run> & a_runs)
+    {
+        // each half of memory holds one run
+        size_t   run_bytes = (a_memory.size() / 2) * sizeof(Record);
+        Record * halves[2] = { &a_memory[0], &a_memory[a_memory.size() / 2] };
+
+        size_t   current = 0;
+        size_t   length  = size_t(min_of<uint64_t>(run_bytes,a_bytes));
+        uint64_t start   = 0;
+        uint64_t next    = length;
+
+        a_input.start_read(halves[0],length,0);
+
+        while (true)
+        {
+            if (a_input.wait() != length)
+                throw std::runtime_error("unexpected end of file in " + a_input.name());
+
+            // the other half is free once its run is written
+            if (!a_runs.empty())
+                a_runs.back().m_file.wait();
+
+            // read the next run while sorting this one
+            size_t next_length = size_t(min_of<uint64_t>(run_bytes,a_bytes - next));
+
+            if (next_length > 0)
+                a_input.start_read(halves[1 - current],next_length,next);
+
+            quick_sort(halves[current],length / sizeof(Record));
+
+            // runs lie in the temporary file in input order
+            run r = { a_temp.share(), start, length };
+            a_runs.push_back(std::move(r));
+            a_runs.back().m_file.start_write(halves[current],length,start);
+
+            if (next_length == 0)
+                break;
+
+            start   = next;
+            next   += next_length;
+            length  = next_length;
+            current = 1 - current;
+        }
+
+        a_runs.back().m_file.wait();
+    }
+
+    // merge runs
+    template <class Record>
+    void external_sorter<Record>::merge(run * const * a_runs, size_t k, async_file & a_output, uint64_t a_offset, std::vector<Record> & a_memory)
+    {
+        // two blocks for each run and for the output
+        size_t block = a_memory.size() / (2 * k + 2);
+
+        std::vector<cursor> cursors(k);
+        loser_tree<Record> tree(k);
+
+        for (size_t i = 0; i < k; ++i)
+            cursors[i].open(*a_runs[i],&a_memory[2 * i * block],&a_memory[(2 * i + 1) * block],block);
+
+        for (size_t i = 0; i < k; ++i)
+            tree.set(i,cursors[i].next_block());
+
+        tree.build();
+
+        Record * output[2] = { &a_memory[2 * k * block], &a_memory[(2 * k + 1) * block] };
+        size_t   current   = 0;
+        size_t   filled    = 0;
+        uint64_t offset    = a_offset;
+
+        while (!tree.empty())
+        {
+            output[current][filled] = *tree.winner_element();
+            tree.replace(cursors[tree.winner()].next());
+
+            if (++filled == block)
+            {
+                // write this block while filling the other
+                a_output.start_write(output[current],filled * sizeof(Record),offset);
+                offset  += filled * sizeof(Record);
+                current  = 1 - current;
+                filled   = 0;
+            }
+        }
+
+        if (filled > 0)
+            a_output.start_write(output[current],filled * sizeof(Record),offset);
+
+        a_output.wait();
+        ++m_merges;
+    }
+
+    // sort a file
+    template <class Record>
+    void external_sorter<Record>::sort(const std::string & a_input, const std::string & a_output)
+    {
+        m_records = 0;
+        m_runs    = 0;
+        m_merges  = 0;
+
+        // the largest merge that keeps blocks of at least MIN_BLOCK bytes
+        size_t fan_in = max_of<size_t>(m_memory_budget / (2 * max_of<size_t>(MIN_BLOCK,sizeof(Record))),3) - 1;
+
+        // the I/O thread and the memory are declared before any file,
+        // so that every file's transfers finish before either goes,
+        // and the temporary file before the runs that share it
+        async_io io;
+        std::vector<Record> memory(max_of<size_t>(m_memory_budget / sizeof(Record),2 * fan_in + 2));
+        async_file temp(async_file::temporary(io,m_temp_directory));
+        uint64_t temp_end = 0;
+        std::deque<run> runs;
+
+        {
+            async_file input(io,a_input,async_file::READ);
+            uint64_t bytes = input.size();
+
+            if (bytes % sizeof(Record) != 0)
+                throw std::runtime_error(a_input + " does not hold a whole number of records");
+
+            m_records = bytes / sizeof(Record);
+
+            if (m_records <= memory.size())
+            {
+                // it fits: sort in memory
+                if (m_records > 0)
+                {
+                    read_fully(input,&memory[0],size_t(bytes),0);
+                    quick_sort(&memory[0],size_t(m_records));
+                }
+
+                async_file output(io,a_output,async_file::WRITE);
+
+                if (m_records > 0)
+                {
+                    output.start_write(&memory[0],size_t(bytes),0);
+                    output.wait();
+                }
+
+                return;
+            }
+
+            make_runs(input,bytes,memory,temp,runs);
+            temp_end = bytes;
+        }
+
+        m_runs = runs.size();
+
+        // merge the oldest runs into longer ones, at the end of the
+        // temporary file, until a single merge can finish the job; a
+        // deque keeps runs in place as it grows
+        std::vector<run *> group;
+
+        while (runs.size() > fan_in)
+        {
+            group.clear();
+            run merged = { temp.share(), temp_end, 0 };
+
+            for (size_t i = 0; i < fan_in; ++i)
+            {
+                group.push_back(&runs[i]);
+                merged.m_bytes += runs[i].m_bytes;
+            }
+
+            temp_end += merged.m_bytes;
+            runs.push_back(std::move(merged));
+            merge(&group[0],fan_in,runs.back().m_file,runs.back().m_offset,memory);
+
+            for (size_t i = 0; i < fan_in; ++i)
+            {
+                temp.discard(runs.front().m_offset,runs.front().m_bytes);
+                runs.pop_front();
+            }
+        }
+
+        group.clear();
+
+        for (size_t i = 0; i < runs.size(); ++i)
+            group.push_back(&runs[i]);
+
+        async_file output(io,a_output,async_file::WRITE);
+        merge(&group[0],group.size(),output,0,memory);
+    }
+
+} // end namespace libcoyotl
+
+#endif
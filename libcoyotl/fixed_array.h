@@ -0,0 +1,277 @@
+//---------------------------------------------------------------------
+//  Algorithmic Conjurings @ http://www.coyotegulch.com
+//
+//  fixed_array.h (libcoyotl)
+//
+//  An array with a compile-time length and inline storage, sharing
+//  the interface of the array template.
+//---------------------------------------------------------------------
+//
+//  Copyright 1990-2005 Scott Robert Ladd
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the
+//      Free Software Foundation, Inc.
+//      59 Temple Place - Suite 330
+//      Boston, MA 02111-1307, USA.
+//
+//-----------------------------------------------------------------------
+//
+//  For more information on this software package, please visit
+//  Scott's web site, Coyote Gulch Productions, at:
+//
+//      http://www.coyotegulch.com
+//
+//-----------------------------------------------------------------------
+
+#if !defined(LIBCOYOTL_FIXED_ARRAY_H)
+#define LIBCOYOTL_FIXED_ARRAY_H
+
+#include <cstddef>
+
+#include "validator.h"     // validation functions
+#include "array_kernels.h" // copy, fill and compare
+#include "array_view.h"    // non-owning views
+#include "array_expr.h"    // element-wise arithmetic
+
+#if defined(LIBCOYOTL_BOUNDS_CHECKING)
+#define LIBCOYOTL_FIXED_ARRAY_EXCEPTIONS validation_error<size_t>
+#define LIBCOYOTL_FIXED_ARRAY_CHECK_INDEX(n) validate_less(n,N,LIBCOYOTL_LOCATION);
+#else
+#define LIBCOYOTL_FIXED_ARRAY_EXCEPTIONS
+#define LIBCOYOTL_FIXED_ARRAY_CHECK_INDEX(n)
+#endif
+
+namespace libcoyotl
+{
+    //! An array of compile-time length with inline storage
+    /*!
+        Holds exactly <i>N</i> elements inside the object itself, so a
+        fixed_array costs no heap allocation and lives on the stack or inline
+        in its parent. It provides the element access, iterator, view,
+        comparison and assignment members of <i>array</i>; it cannot be
+        appended to or resized.
+
+        A fixed_array is an aggregate, so it can be initialized with braces
+        like a C-style array (<i>fixed_array<int,3> a = { { 1, 2, 3 } };</i>)
+        and copied, including in constant tables, at no cost beyond its
+        elements.
+    */
+    template <typename Type, size_t N>
+    class fixed_array
+    {
+    public:
+        //! Type of an array element
+        typedef Type         value_type;
+
+        //! type of a pointer to an element
+        typedef Type *       pointer;
+
+        //! Type of a constant pointer to an element
+        typedef const Type * const_pointer;
+
+        //! Type of a reference to an element
+        typedef Type &       reference;
+
+        //! Type of a constant reference to an element
+        typedef const Type & const_reference;
+
+        //! Difference type between two element pointers
+        typedef ptrdiff_t    difference_type;
+
+        //! Size type for indexing array elements
+        typedef size_t       size_type;
+
+        //! Iterator type
+        typedef Type *       iterator;
+
+        //! Constant iterator type
+        typedef const Type * const_iterator;
+
+        //! Assign value to all elements
+        /*!
+            Assigns a given value to all elements in an array.
+            \param a_value - Value to be assigned
+            \return A reference to the target array
+        */
+        fixed_array & operator = (const Type & a_value) throw()
+        {
+            fill_elements(m_elements,N,a_value);
+            return *this;
+        }
+
+        //! Assign from C-style array
+        /*!
+            Assign elements from a c-style array, assuming that <i>c_array</i>
+            contains at least <i>N</i> elements.
+            \param a_carray - A pointer to a C-style array
+        */
+        fixed_array & operator = (const Type * a_carray) throw()
+        {
+            copy_elements(m_elements,a_carray,N);
+            return *this;
+        }
+
+        //! Assign from an expression
+        /*!
+            Computes an element-wise expression (see array_expr.h) into the array.
+            \param a_expr - An expression over arrays of length <i>N</i>
+        */
+        template <class Expr>
+        fixed_array & operator = (const array_expression<Expr> & a_expr)
+        {
+            evaluate(m_elements,N,a_expr);
+            return *this;
+        }
+
+        //! Conversion to C-style array
+        /*!
+            Returns a pointer to the elements; no elements can be changed via
+            this pointer.
+            \return A const pointer to the underlying C-style array
+        */
+        const Type * c_array() const throw()
+        {
+            return m_elements;
+        }
+
+        //! Element access
+        /*!
+            Returns a reference to a specific element in an array.
+            \param n - Index of an element
+            \return A reference to the element at index <i>n</i>
+        */
+        Type & operator [] (size_t n) throw(LIBCOYOTL_FIXED_ARRAY_EXCEPTIONS)
+        {
+            LIBCOYOTL_FIXED_ARRAY_CHECK_INDEX(n)
+            return m_elements[n];
+        }
+
+        //! Element access, constant array
+        /*!
+            Returns a specific element in an array.
+            \param n - Index of an element
+            \return A constant reference to the element at index <i>n</i>
+        */
+        const Type & operator [] (size_t n) const throw(LIBCOYOTL_FIXED_ARRAY_EXCEPTIONS)
+        {
+            LIBCOYOTL_FIXED_ARRAY_CHECK_INDEX(n)
+            return m_elements[n];
+        }
+
+        //! View of all elements
+        array_view<Type> view() throw()
+        {
+            return array_view<Type>(m_elements,N);
+        }
+
+        //! Read-only view of all elements
+        array_view<const Type> view() const throw()
+        {
+            return array_view<const Type>(m_elements,N);
+        }
+
+        //! Obtain beginning-of-sequence iterator
+        iterator begin() throw() { return m_elements; }
+
+        //! Obtain beginning-of-sequence iterator, constant array
+        const_iterator begin() const throw() { return m_elements; }
+
+        //! Obtain end-of-sequence iterator
+        iterator end() throw() { return m_elements + N; }
+
+        //! Obtain end-of-sequence iterator, constant array
+        const_iterator end() const throw() { return m_elements + N; }
+
+        //! Equals operator
+        /*!
+            Compares corresponding elements of the target array to the argument array,
+            checking for equality.
+            \param a_comparand - Comparand array
+            \return <i>true</i> all corresponding elements are equal, <i>false</i> otherwise.
+        */
+        bool operator == (const fixed_array & a_comparand) const throw()
+        {
+            return equal_elements(m_elements,a_comparand.m_elements,N);
+        }
+
+        //! Inequality operator
+        bool operator != (const fixed_array & a_comparand) const throw()
+        {
+            return !(*this == a_comparand);
+        }
+
+        //! Less-than operator
+        /*!
+            Compares the target array and the comparand array lexicographically.
+            \param a_comparand - Comparand array
+            \return <i>true</i> if the target orders before the comparand; <i>false</i> otherwise.
+        */
+        bool operator <  (const fixed_array & a_comparand) const throw()
+        {
+            return less_elements<Type>(m_elements,N,a_comparand.m_elements,N);
+        }
+
+        //! Greater-than operator
+        bool operator >  (const fixed_array & a_comparand) const throw()
+        {
+            return (a_comparand < *this);
+        }
+
+        //! Less-than-or-equal-to operator
+        bool operator <= (const fixed_array & a_comparand) const throw()
+        {
+            return !(a_comparand < *this);
+        }
+
+        //! Greater-than-or-equal-to operator
+        bool operator >= (const fixed_array & a_comparand) const throw()
+        {
+            return !(*this < a_comparand);
+        }
+
+        //! Exchanges the contents of two arrays
+        /*!
+            Exchanges the elements of two arrays one by one; unlike <i>array</i>,
+            there is no buffer to swap.
+            \param a_source - The array with which to swap
+        */
+        void swap(fixed_array & a_source)
+        {
+            for (size_t n = 0; n < N; ++n)
+            {
+                Type temp(static_cast<Type &&>(m_elements[n]));
+                m_elements[n] = static_cast<Type &&>(a_source.m_elements[n]);
+                a_source.m_elements[n] = static_cast<Type &&>(temp);
+            }
+        }
+
+        //! Number of elements
+        size_t size() const throw() { return N; }
+
+        //! Maximum container size, which is the same as <i>size()</i>
+        size_t max_size() const throw() { return N; }
+
+        //! Allocated capacity, which is the same as <i>size()</i>
+        size_t capacity() const throw() { return N; }
+
+        //! Empty container check
+        bool empty() const throw() { return (N == 0); }
+
+        //! The elements; public only so that the class remains an aggregate
+        Type m_elements[N];
+    };
+
+} // end namespace libcoyotl
+
+#endif
@@ -0,0 +1,545 @@
+//---------------------------------------------------------------------
+//  Algorithmic Conjurings @ http://www.coyotegulch.com
+//
+//  matrix.h (libcoyotl)
+//
+//  A dense, row-major two-dimensional array with aligned rows and
+//  cache-blocked (tiled) traversal.
+//---------------------------------------------------------------------
+//
+//  Copyright 1990-2005 Scott Robert Ladd
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the
+//      Free Software Foundation, Inc.
+//      59 Temple Place - Suite 330
+//      Boston, MA 02111-1307, USA.
+//
+//-----------------------------------------------------------------------
+//
+//  For more information on this software package, please visit
+//  Scott's web site, Coyote Gulch Productions, at:
+//
+//      http://www.coyotegulch.com
+//
+//-----------------------------------------------------------------------
+
+#if !defined(LIBCOYOTL_MATRIX_H)
+#define LIBCOYOTL_MATRIX_H
+
+#include <cstddef>
+
+#include "validator.h"     // validation functions
+#include "allocators.h"    // storage policies
+#include "array_kernels.h" // copy, fill and compare
+#include "array_view.h"    // non-owning views
+
+#if defined(LIBCOYOTL_BOUNDS_CHECKING)
+#define LIBCOYOTL_MATRIX_EXCEPTIONS validation_error<size_t>
+#define LIBCOYOTL_MATRIX_CHECK_INDEX(r,c) validate_less(r,m_rows,LIBCOYOTL_LOCATION); validate_less(c,m_cols,LIBCOYOTL_LOCATION);
+#else
+#define LIBCOYOTL_MATRIX_EXCEPTIONS
+#define LIBCOYOTL_MATRIX_CHECK_INDEX(r,c)
+#endif
+
+namespace libcoyotl
+{
+    //! A dense, row-major matrix
+    /*!
+        Stores all elements in one block from an <i>Allocator</i>, one row
+        after another. Each row is padded to a whole number of 64-byte cache
+        lines when the element size divides 64, so with the default
+        <i>aligned_allocator</i> every row begins on a cache line; the
+        distance between rows, in elements, is <i>get_pitch()</i>.
+
+        <i>m[r][c]</i> and <i>m(r,c)</i> both address the element in row
+        <i>r</i>, column <i>c</i>. Rows are contiguous views and columns are
+        strided views. The tiled traversal members visit the matrix in
+        square blocks that fit in cache, which keeps column-wise access
+        patterns (a transpose, for instance) from thrashing.
+    */
+    template <typename Type, typename Allocator = aligned_allocator<64> >
+    class matrix
+    {
+    public:
+        //! Type of an element
+        typedef Type         value_type;
+
+        //! type of a pointer to an element
+        typedef Type *       pointer;
+
+        //! Type of a constant pointer to an element
+        typedef const Type * const_pointer;
+
+        //! Type of a reference to an element
+        typedef Type &       reference;
+
+        //! Type of a constant reference to an element
+        typedef const Type & const_reference;
+
+        //! Size type for indexing elements
+        typedef size_t       size_type;
+
+        //! Storage policy
+        typedef Allocator    allocator_type;
+
+        //! Default constructor
+        /*!
+            Constructs an empty matrix, with no rows or columns.
+            /param a_allocator source of storage
+        */
+        explicit matrix(const Allocator & a_allocator = Allocator());
+
+        //! Constructor
+        /*!
+            Constructs a matrix of default-initialized elements.
+            /param a_rows number of rows
+            /param a_cols number of columns
+            /param a_allocator source of storage
+        */
+        matrix(size_t a_rows, size_t a_cols, const Allocator & a_allocator = Allocator());
+
+        //! Initialization constructor
+        /*!
+            Constructs a matrix with every element set to a given value.
+            /param a_rows number of rows
+            /param a_cols number of columns
+            /param a_init_value initial value of all elements
+            /param a_allocator source of storage
+        */
+        matrix(size_t a_rows, size_t a_cols, const Type & a_init_value, const Allocator & a_allocator = Allocator());
+
+        //! Copy constructor
+        matrix(const matrix & a_source);
+
+        //! Move constructor
+        /*!
+            Takes ownership of the source's elements; the source is left empty.
+            \param a_source - The source object
+        */
+        matrix(matrix && a_source) throw();
+
+        //! Destructor
+        ~matrix() throw();
+
+        //! Assignment operator
+        /*!
+            Makes the target a copy of the source, reallocating if their
+            dimensions differ.
+            \param a_source - The source object
+        */
+        matrix & operator = (const matrix & a_source);
+
+        //! Move assignment operator
+        matrix & operator = (matrix && a_source) throw();
+
+        //! Assign value to all elements
+        matrix & operator = (const Type & a_value) throw();
+
+        //! Row access
+        /*!
+            Returns a pointer to the first element of a row, so that
+            <i>m[r][c]</i> addresses an element.
+            \param a_row - Index of a row
+            \return Pointer to the row's elements
+        */
+        Type * operator [] (size_t a_row) throw()
+        {
+            return m_data + a_row * m_pitch;
+        }
+
+        //! Row access, constant matrix
+        const Type * operator [] (size_t a_row) const throw()
+        {
+            return m_data + a_row * m_pitch;
+        }
+
+        //! Element access
+        Type & operator () (size_t a_row, size_t a_col) throw(LIBCOYOTL_MATRIX_EXCEPTIONS)
+        {
+            LIBCOYOTL_MATRIX_CHECK_INDEX(a_row,a_col)
+            return m_data[a_row * m_pitch + a_col];
+        }
+
+        //! Element access, constant matrix
+        const Type & operator () (size_t a_row, size_t a_col) const throw(LIBCOYOTL_MATRIX_EXCEPTIONS)
+        {
+            LIBCOYOTL_MATRIX_CHECK_INDEX(a_row,a_col)
+            return m_data[a_row * m_pitch + a_col];
+        }
+
+        //! View of a row
+        array_view<Type> row(size_t a_row)
+        {
+            validate_less(a_row,m_rows,LIBCOYOTL_LOCATION);
+            return array_view<Type>(m_data + a_row * m_pitch,m_cols);
+        }
+
+        //! Read-only view of a row
+        array_view<const Type> row(size_t a_row) const
+        {
+            validate_less(a_row,m_rows,LIBCOYOTL_LOCATION);
+            return array_view<const Type>(m_data + a_row * m_pitch,m_cols);
+        }
+
+        //! View of a column, strided by the pitch
+        array_view<Type> col(size_t a_col)
+        {
+            validate_less(a_col,m_cols,LIBCOYOTL_LOCATION);
+            return array_view<Type>(m_data + a_col,m_rows,ptrdiff_t(m_pitch));
+        }
+
+        //! Read-only view of a column, strided by the pitch
+        array_view<const Type> col(size_t a_col) const
+        {
+            validate_less(a_col,m_cols,LIBCOYOTL_LOCATION);
+            return array_view<const Type>(m_data + a_col,m_rows,ptrdiff_t(m_pitch));
+        }
+
+        //! Visit the matrix tile by tile
+        /*!
+            Calls <i>a_function(row_first, row_last, col_first, col_last)</i>
+            for each tile of at most <i>a_tile_rows</i> by <i>a_tile_cols</i>
+            elements, covering the matrix; tiles are visited in row-major
+            order, and the bounds are half-open.
+            \param a_function - Called once per tile
+            \param a_tile_rows - Maximum rows per tile
+            \param a_tile_cols - Maximum columns per tile
+        */
+        template <class Function>
+        void for_each_tile(Function a_function, size_t a_tile_rows = 64, size_t a_tile_cols = 64) const;
+
+        //! Visit every element tile by tile
+        /*!
+            Calls <i>a_function(row, col, element)</i> for every element,
+            in row-major order within each tile.
+            \param a_function - Called once per element
+            \param a_tile_rows - Maximum rows per tile
+            \param a_tile_cols - Maximum columns per tile
+        */
+        template <class Function>
+        void for_each_tiled(Function a_function, size_t a_tile_rows = 64, size_t a_tile_cols = 64);
+
+        //! Exchange the contents of two matrices
+        void swap(matrix & a_source) throw();
+
+        //! Get the allocator
+        const Allocator & get_allocator() const throw() { return m_allocator; }
+
+        //! Number of rows
+        size_t get_rows() const throw() { return m_rows; }
+
+        //! Number of columns
+        size_t get_cols() const throw() { return m_cols; }
+
+        //! Distance between rows, in elements
+        size_t get_pitch() const throw() { return m_pitch; }
+
+        //! Number of elements, excluding padding
+        size_t size() const throw() { return m_rows * m_cols; }
+
+        //! Empty matrix check
+        bool empty() const throw() { return (m_rows == 0) || (m_cols == 0); }
+
+        //! First element; rows follow at intervals of <i>get_pitch()</i>
+        Type * data() throw() { return m_data; }
+
+        //! First element, constant matrix
+        const Type * data() const throw() { return m_data; }
+
+        //! Equals operator; matrices of different dimensions are unequal
+        bool operator == (const matrix & a_comparand) const throw();
+
+        //! Inequality operator
+        bool operator != (const matrix & a_comparand) const throw() { return !(*this == a_comparand); }
+
+    private:
+        // row length, padded to whole cache lines where possible
+        static size_t compute_pitch(size_t a_cols) throw();
+
+        // allocate storage for the current dimensions
+        void allocate();
+
+        // elements
+        Type * m_data;
+
+        // dimensions
+        size_t m_rows;
+        size_t m_cols;
+
+        // distance between rows, in elements
+        size_t m_pitch;
+
+        // source of storage
+        Allocator m_allocator;
+    };
+
+    // row length, padded to whole cache lines where possible
+    template <typename Type, typename Allocator>
+    size_t matrix<Type,Allocator>::compute_pitch(size_t a_cols) throw()
+    {
+        if ((sizeof(Type) > 64) || ((64 % sizeof(Type)) != 0))
+            return a_cols;
+
+        size_t per_line = 64 / sizeof(Type);
+        return (a_cols + per_line - 1) / per_line * per_line;
+    }
+
+    // allocate storage for the current dimensions
+    template <typename Type, typename Allocator>
+    void matrix<Type,Allocator>::allocate()
+    {
+        m_pitch = compute_pitch(m_cols);
+        m_data  = ((m_rows > 0) && (m_pitch > 0)) ? m_allocator.template allocate<Type>(m_rows * m_pitch) : NULL;
+    }
+
+    // default constructor
+    template <typename Type, typename Allocator>
+    matrix<Type,Allocator>::matrix(const Allocator & a_allocator)
+      : m_data(NULL),
+        m_rows(0),
+        m_cols(0),
+        m_pitch(0),
+        m_allocator(a_allocator)
+    {
+        // nada
+    }
+
+    // constructor
+    template <typename Type, typename Allocator>
+    matrix<Type,Allocator>::matrix(size_t a_rows, size_t a_cols, const Allocator & a_allocator)
+      : m_data(NULL),
+        m_rows(a_rows),
+        m_cols(a_cols),
+        m_pitch(0),
+        m_allocator(a_allocator)
+    {
+        allocate();
+    }
+
+    // initialization constructor
+    template <typename Type, typename Allocator>
+    matrix<Type,Allocator>::matrix(size_t a_rows, size_t a_cols, const Type & a_init_value, const Allocator & a_allocator)
+      : m_data(NULL),
+        m_rows(a_rows),
+        m_cols(a_cols),
+        m_pitch(0),
+        m_allocator(a_allocator)
+    {
+        allocate();
+        fill_elements(m_data,m_rows * m_pitch,a_init_value);
+    }
+
+    // copy constructor
+    template <typename Type, typename Allocator>
+    matrix<Type,Allocator>::matrix(const matrix & a_source)
+      : m_data(NULL),
+        m_rows(a_source.m_rows),
+        m_cols(a_source.m_cols),
+        m_pitch(0),
+        m_allocator(a_source.m_allocator)
+    {
+        allocate();
+        copy_elements(m_data,a_source.m_data,m_rows * m_pitch);
+    }
+
+    // move constructor
+    template <typename Type, typename Allocator>
+    matrix<Type,Allocator>::matrix(matrix && a_source) throw()
+      : m_data(a_source.m_data),
+        m_rows(a_source.m_rows),
+        m_cols(a_source.m_cols),
+        m_pitch(a_source.m_pitch),
+        m_allocator(a_source.m_allocator)
+    {
+        a_source.m_data  = NULL;
+        a_source.m_rows  = 0;
+        a_source.m_cols  = 0;
+        a_source.m_pitch = 0;
+    }
+
+    // destructor
+    template <typename Type, typename Allocator>
+    matrix<Type,Allocator>::~matrix() throw()
+    {
+        m_allocator.deallocate(m_data,m_rows * m_pitch);
+    }
+
+    // assignment operator
+    template <typename Type, typename Allocator>
+    matrix<Type,Allocator> & matrix<Type,Allocator>::operator = (const matrix & a_source)
+    {
+        if (this != &a_source)
+        {
+            if ((m_rows != a_source.m_rows) || (m_cols != a_source.m_cols))
+            {
+                matrix temp(a_source);
+                swap(temp);
+            }
+            else
+                copy_elements(m_data,a_source.m_data,m_rows * m_pitch);
+        }
+
+        return *this;
+    }
+
+    // move assignment operator
+    template <typename Type, typename Allocator>
+    matrix<Type,Allocator> & matrix<Type,Allocator>::operator = (matrix && a_source) throw()
+    {
+        if (this != &a_source)
+        {
+            m_allocator.deallocate(m_data,m_rows * m_pitch);
+
+            m_data      = a_source.m_data;
+            m_rows      = a_source.m_rows;
+            m_cols      = a_source.m_cols;
+            m_pitch     = a_source.m_pitch;
+            m_allocator = a_source.m_allocator;
+
+            a_source.m_data  = NULL;
+            a_source.m_rows  = 0;
+            a_source.m_cols  = 0;
+            a_source.m_pitch = 0;
+        }
+
+        return *this;
+    }
+
+    // assign value to all elements
+    template <typename Type, typename Allocator>
+    matrix<Type,Allocator> & matrix<Type,Allocator>::operator = (const Type & a_value) throw()
+    {
+        fill_elements(m_data,m_rows * m_pitch,a_value);
+        return *this;
+    }
+
+    // visit tiles
+    template <typename Type, typename Allocator>
+    template <class Function>
+    void matrix<Type,Allocator>::for_each_tile(Function a_function, size_t a_tile_rows, size_t a_tile_cols) const
+    {
+        validate_not(a_tile_rows,size_t(0),LIBCOYOTL_LOCATION);
+        validate_not(a_tile_cols,size_t(0),LIBCOYOTL_LOCATION);
+
+        for (size_t r = 0; r < m_rows; r += a_tile_rows)
+        {
+            size_t r_last = (m_rows - r > a_tile_rows) ? r + a_tile_rows : m_rows;
+
+            for (size_t c = 0; c < m_cols; c += a_tile_cols)
+            {
+                size_t c_last = (m_cols - c > a_tile_cols) ? c + a_tile_cols : m_cols;
+                a_function(r,r_last,c,c_last);
+            }
+        }
+    }
+
+    // visit elements tile by tile
+    template <typename Type, typename Allocator>
+    template <class Function>
+    void matrix<Type,Allocator>::for_each_tiled(Function a_function, size_t a_tile_rows, size_t a_tile_cols)
+    {
+        validate_not(a_tile_rows,size_t(0),LIBCOYOTL_LOCATION);
+        validate_not(a_tile_cols,size_t(0),LIBCOYOTL_LOCATION);
+
+        for (size_t r = 0; r < m_rows; r += a_tile_rows)
+        {
+            size_t r_last = (m_rows - r > a_tile_rows) ? r + a_tile_rows : m_rows;
+
+            for (size_t c = 0; c < m_cols; c += a_tile_cols)
+            {
+                size_t c_last = (m_cols - c > a_tile_cols) ? c + a_tile_cols : m_cols;
+
+                for (size_t i = r; i < r_last; ++i)
+                {
+                    Type * row_ptr = m_data + i * m_pitch;
+
+                    for (size_t j = c; j < c_last; ++j)
+                        a_function(i,j,row_ptr[j]);
+                }
+            }
+        }
+    }
+
+    // exchange contents
+    template <typename Type, typename Allocator>
+    void matrix<Type,Allocator>::swap(matrix & a_source) throw()
+    {
+        Type * temp_data = m_data;
+        m_data = a_source.m_data;
+        a_source.m_data = temp_data;
+
+        size_t temp = m_rows;
+        m_rows = a_source.m_rows;
+        a_source.m_rows = temp;
+
+        temp = m_cols;
+        m_cols = a_source.m_cols;
+        a_source.m_cols = temp;
+
+        temp = m_pitch;
+        m_pitch = a_source.m_pitch;
+        a_source.m_pitch = temp;
+
+        Allocator temp_allocator = m_allocator;
+        m_allocator = a_source.m_allocator;
+        a_source.m_allocator = temp_allocator;
+    }
+
+    // equality
+    template <typename Type, typename Allocator>
+    bool matrix<Type,Allocator>::operator == (const matrix & a_comparand) const throw()
+    {
+        if ((m_rows != a_comparand.m_rows) || (m_cols != a_comparand.m_cols))
+            return false;
+
+        // compare row by row, skipping padding
+        for (size_t r = 0; r < m_rows; ++r)
+        {
+            if (!equal_elements(m_data + r * m_pitch,a_comparand.m_data + r * m_pitch,m_cols))
+                return false;
+        }
+
+        return true;
+    }
+
+    //! Tiled transpose
+    /*!
+        Stores the transpose of <i>a_source</i> in <i>a_target</i>, which must
+        have the transposed dimensions. Works in square tiles, so both the
+        rows read and the columns written stay in cache.
+        \param a_source - Matrix to be transposed
+        \param a_target - Receives the transpose
+        \param a_tile - Edge length of a tile
+    */
+    template <typename Type, typename SourceAllocator, typename TargetAllocator>
+    void transpose(const matrix<Type,SourceAllocator> & a_source, matrix<Type,TargetAllocator> & a_target, size_t a_tile = 32)
+    {
+        validate_equals(a_target.get_rows(),a_source.get_cols(),LIBCOYOTL_LOCATION);
+        validate_equals(a_target.get_cols(),a_source.get_rows(),LIBCOYOTL_LOCATION);
+
+        a_source.for_each_tile([&](size_t a_r0, size_t a_r1, size_t a_c0, size_t a_c1)
+        {
+            for (size_t r = a_r0; r < a_r1; ++r)
+            {
+                const Type * source_row = a_source[r];
+
+                for (size_t c = a_c0; c < a_c1; ++c)
+                    a_target[c][r] = source_row[c];
+            }
+        },a_tile,a_tile);
+    }
+
+} // end namespace libcoyotl
+
+#endif
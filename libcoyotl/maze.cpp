@@ -86,7 +86,7 @@ maze maze::load(istream & source)
 maze::maze(size_t width, size_t height) :
     m_width(width),
     m_height(height),
-    m_cells(NULL)
+    m_cells()
 {
     construct();
 }
@@ -95,15 +95,12 @@ void maze::construct()
 {
     size_t row, col;
 
-    // allocate cell array columns
-    m_cells = new cell * [m_width];
+    // allocate cells, one contiguous block
+    m_cells = matrix<cell>(m_width,m_height);
 
-    // allocate cells and walls
+    // allocate walls
     for (col = 0; col < m_width; ++col)
     {
-        // allocate a row
-        m_cells[col] = new cell[m_height];
-
         // allocate top and left walls
         for (row = 0; row < m_height; ++row)
         {
@@ -191,14 +188,7 @@ void maze::release()
     }
 
     // delete cells
-    for (col = 0; col < m_width; ++col)
-    {
-        delete [] m_cells[col];
-        m_cells[col] = NULL;
-    }
-
-    delete [] m_cells;
-    m_cells = NULL;
+    m_cells = matrix<cell>();
 }
 
 void maze::deep_copy(const maze & source)
@@ -278,7 +268,7 @@ maze::maze(const maze & source) :
     m_height(source.m_height),
     m_entrance(source.m_entrance),
     m_exit(source.m_exit),
-    m_cells(NULL)
+    m_cells()
 {
     construct();
     deep_copy(source);
@@ -40,6 +40,8 @@
 #include <iostream>
 #include <cstddef>
 
+#include "matrix.h"
+
 namespace libcoyotl
 {
     //! Defines the data structure of a maze
@@ -151,11 +153,12 @@ namespace libcoyotl
             //! Get cell map for a maze
             /*!
                 Retrieves the two-dimensional maze containing the cells for a maze.
-                This function provides direct read-write access to the cell data.
+                This function provides direct read-write access to the cell data,
+                which is indexed as <i>cells[col][row]</i>.
                 \param a_target - The target maze
-                \return A two-dimensional pointer to the cell grid
+                \return The cell grid, one matrix row per maze column
             */
-            static cell ** get_cells(maze & a_target)
+            static matrix<cell> & get_cells(maze & a_target)
             {
                 return a_target.m_cells;
             }
@@ -314,8 +317,8 @@ namespace libcoyotl
         //! Position of the exit cell
         position m_exit;        
 
-        //! The cell data
-        cell ** m_cells;        
+        //! The cell data, one matrix row per maze column
+        matrix<cell> m_cells;        
     };
 
 } // end namespace
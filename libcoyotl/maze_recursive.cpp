@@ -34,6 +34,7 @@
 //-----------------------------------------------------------------------
 
 #include "maze_recursive.h"
+#include "fixed_array.h"
 using namespace libcoyotl;
 
 #include <deque>
@@ -41,12 +42,12 @@ using namespace libcoyotl;
 void recursive_maze_architect::create_floor_plan(maze & a_target)
 {
     // permutations of directions
-    static size_t dir_perms[24][4] =
+    static const fixed_array<size_t,4> dir_perms[24] =
     {
-        { 0, 1, 2, 3 }, { 0, 1, 3, 2 }, { 0, 2, 1, 3 }, { 0, 2, 3, 1 }, { 0, 3, 1, 2 }, { 0, 3, 2, 1 },
-        { 1, 0, 2, 3 }, { 1, 0, 3, 2 }, { 1, 2, 0, 3 }, { 1, 2, 3, 0 }, { 1, 3, 0, 2 }, { 1, 3, 2, 0 },
-        { 2, 1, 0, 3 }, { 2, 1, 3, 0 }, { 2, 0, 1, 3 }, { 2, 0, 3, 1 }, { 2, 3, 1, 0 }, { 2, 3, 0, 1 },
-        { 3, 1, 2, 0 }, { 3, 1, 0, 2 }, { 3, 2, 1, 0 }, { 3, 2, 0, 1 }, { 3, 0, 1, 2 }, { 3, 0, 2, 1 }
+        { { 0, 1, 2, 3 } }, { { 0, 1, 3, 2 } }, { { 0, 2, 1, 3 } }, { { 0, 2, 3, 1 } }, { { 0, 3, 1, 2 } }, { { 0, 3, 2, 1 } },
+        { { 1, 0, 2, 3 } }, { { 1, 0, 3, 2 } }, { { 1, 2, 0, 3 } }, { { 1, 2, 3, 0 } }, { { 1, 3, 0, 2 } }, { { 1, 3, 2, 0 } },
+        { { 2, 1, 0, 3 } }, { { 2, 1, 3, 0 } }, { { 2, 0, 1, 3 } }, { { 2, 0, 3, 1 } }, { { 2, 3, 1, 0 } }, { { 2, 3, 0, 1 } },
+        { { 3, 1, 2, 0 } }, { { 3, 1, 0, 2 } }, { { 3, 2, 1, 0 } }, { { 3, 2, 0, 1 } }, { { 3, 0, 1, 2 } }, { { 3, 0, 2, 1 } }
     };
 
     // record places we can go back to
@@ -57,18 +58,10 @@ void recursive_maze_architect::create_floor_plan(maze & a_target)
     size_t          height    = a_target.get_height();
     maze::position  entrance  = a_target.get_entrance_cell_position();
     maze::position  exit      = a_target.get_exit_cell_position();
-    maze::cell **   cells     = get_cells(a_target);
+    matrix<maze::cell> & cells = get_cells(a_target);
 
     // record whether or not we've visisted a given cell
-    bool ** visited = new bool * [width];
-
-    for (size_t col = 0; col < width; ++col)
-    {
-        visited[col] = new bool[height];
-
-        for (size_t row = 0; row < height; ++row)
-            visited[col][row] = false;
-    }
+    matrix<bool> visited(width,height,false);
 
     // start in a random location along the edge
     switch (m_prng.get_rand_range(maze::DIR_NORTH,maze::DIR_WEST))
@@ -194,10 +187,4 @@ void recursive_maze_architect::create_floor_plan(maze & a_target)
             }
         }
     }
-
-    // delete buffer
-    for (size_t col2 = 0; col2 < width; ++col2)
-        delete [] visited[col2];
-
-    delete [] visited;
 }
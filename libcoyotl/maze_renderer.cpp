@@ -55,15 +55,8 @@ maze_renderer::image::image(const maze & source, size_t grid_size)
 
     size_t row, col;
 
-    // allocate row pointers
-    m_bits = new unsigned char * [m_height];
-    
     // allocate and initialize rows
-    for (row = 0; row < size_t(m_height); ++row)
-    {
-        m_bits[row] = new unsigned char [alloc_width];
-        memset(m_bits[row],0xFF,alloc_width);
-    }
+    m_bits = matrix<unsigned char>(m_height,alloc_width,0xFF);
 
     // now we set the bits we need to draw
     size_t x = 0, y = 0, x2 = 0, y2 = 0;
@@ -126,16 +119,6 @@ maze_renderer::image::image(const maze & source, size_t grid_size)
     }
 }
 
-// destructor
-maze_renderer::image::~image()
-{
-    // delete image data
-    for (int row = 0; row < m_height; ++row)
-        delete [] m_bits[row];
-
-    delete [] m_bits;
-}
-
 // create a PNG image of the maze in the specified file
 void maze_renderer::render(const maze & source, const string & file_name, size_t grid_size)
 {
@@ -178,8 +161,9 @@ void maze_renderer::render(const maze & source, const string & file_name, size_t
     // write the file header information
     png_write_info(png_ptr, info_ptr);
 
-    // write out the entire image data in one call
-    png_write_image (png_ptr, maze_image.get_bits());
+    // write out the image data, one row at a time
+    for (int row = 0; row < maze_image.get_height(); ++row)
+        png_write_row(png_ptr, const_cast<png_bytep>(maze_image.get_bits()[row]));
     
     // write the additional chunks to the PNG file (not really needed)
     png_write_end(png_ptr, info_ptr);
@@ -65,11 +65,8 @@ namespace libcoyotl
             // constructor
             image(const maze & source, size_t grid_size);
 
-            // destructor
-            ~image();
-
             // properties
-            unsigned char ** get_bits() const
+            const matrix<unsigned char> & get_bits() const
             {
                 return m_bits;
             }
@@ -92,7 +89,7 @@ namespace libcoyotl
             int  m_height;
 
             // bits representing the maze
-            unsigned char ** m_bits;
+            matrix<unsigned char> m_bits;
         };
     };
 }
@@ -0,0 +1,268 @@
+//---------------------------------------------------------------------
+//  Algorithmic Conjurings @ http://www.coyotegulch.com
+//
+//  mmap_array.cpp (libcoyotl)
+//
+//  Arrays whose storage is a memory-mapped file, for persistent
+//  tables that load without reading or copying.
+//---------------------------------------------------------------------
+//
+//  Copyright 1990-2005 Scott Robert Ladd
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the
+//      Free Software Foundation, Inc.
+//      59 Temple Place - Suite 330
+//      Boston, MA 02111-1307, USA.
+//
+//-----------------------------------------------------------------------
+//
+//  For more information on this software package, please visit
+//  Scott's web site, Coyote Gulch Productions, at:
+//
+//      http://www.coyotegulch.com
+//
+//-----------------------------------------------------------------------
+
+// Standard C++ library
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+// POSIX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// libcoyotl
+#include "mmap_array.h"
+
+using namespace libcoyotl;
+using namespace std;
+
+// build an exception message from errno
+static runtime_error system_error_for(const char * a_operation, const string & a_filename)
+{
+    return runtime_error(string(a_operation) + " failed for " + a_filename + ": " + strerror(errno));
+}
+
+//--------------------------------------------------------------------------
+//  Constructor
+mapped_file::mapped_file(const string & a_filename, mode a_mode, size_t a_offset, size_t a_length)
+  : m_base(NULL),
+    m_map_length(0),
+    m_data(NULL),
+    m_size(0),
+    m_mode(a_mode)
+{
+    int fd = open(a_filename.c_str(),(a_mode == SHARED) ? O_RDWR : O_RDONLY);
+
+    if (fd < 0)
+        throw system_error_for("open",a_filename);
+
+    struct stat info;
+
+    if (fstat(fd,&info) != 0)
+    {
+        runtime_error error = system_error_for("fstat",a_filename);
+        close(fd);
+        throw error;
+    }
+
+    size_t file_size = size_t(info.st_size);
+
+    if (a_offset > file_size)
+    {
+        close(fd);
+        throw runtime_error("mapped_file offset lies beyond the end of " + a_filename);
+    }
+
+    // clamp the length to the file
+    m_size = file_size - a_offset;
+
+    if (a_length < m_size)
+        m_size = a_length;
+
+    if (m_size > 0)
+    {
+        // mappings must begin on a page boundary
+        size_t page  = size_t(sysconf(_SC_PAGESIZE));
+        size_t start = a_offset - (a_offset % page);
+
+        m_map_length = m_size + (a_offset - start);
+
+        int prot  = (a_mode == READ_ONLY) ? PROT_READ : (PROT_READ | PROT_WRITE);
+        int flags = (a_mode == COPY_ON_WRITE) ? MAP_PRIVATE : MAP_SHARED;
+
+        void * base = mmap(NULL,m_map_length,prot,flags,fd,off_t(start));
+
+        if (base == MAP_FAILED)
+        {
+            runtime_error error = system_error_for("mmap",a_filename);
+            close(fd);
+            throw error;
+        }
+
+        m_base = base;
+        m_data = static_cast<char *>(base) + (a_offset - start);
+    }
+
+    // the mapping holds its own reference to the file
+    close(fd);
+}
+
+//--------------------------------------------------------------------------
+//  Move constructor
+mapped_file::mapped_file(mapped_file && a_source) throw()
+  : m_base(a_source.m_base),
+    m_map_length(a_source.m_map_length),
+    m_data(a_source.m_data),
+    m_size(a_source.m_size),
+    m_mode(a_source.m_mode)
+{
+    a_source.m_base       = NULL;
+    a_source.m_map_length = 0;
+    a_source.m_data       = NULL;
+    a_source.m_size       = 0;
+}
+
+//--------------------------------------------------------------------------
+//  Destructor
+mapped_file::~mapped_file() throw()
+{
+    unmap();
+}
+
+//--------------------------------------------------------------------------
+//  Move assignment
+mapped_file & mapped_file::operator = (mapped_file && a_source) throw()
+{
+    if (this != &a_source)
+    {
+        unmap();
+
+        m_base       = a_source.m_base;
+        m_map_length = a_source.m_map_length;
+        m_data       = a_source.m_data;
+        m_size       = a_source.m_size;
+        m_mode       = a_source.m_mode;
+
+        a_source.m_base       = NULL;
+        a_source.m_map_length = 0;
+        a_source.m_data       = NULL;
+        a_source.m_size       = 0;
+    }
+
+    return *this;
+}
+
+//--------------------------------------------------------------------------
+//  Unmap the region
+void mapped_file::unmap() throw()
+{
+    if (m_base != NULL)
+        munmap(m_base,m_map_length);
+
+    m_base       = NULL;
+    m_map_length = 0;
+    m_data       = NULL;
+    m_size       = 0;
+}
+
+//--------------------------------------------------------------------------
+//  Create a file of a given size
+void mapped_file::create(const string & a_filename, size_t a_bytes)
+{
+    int fd = open(a_filename.c_str(),O_RDWR | O_CREAT,0644);
+
+    if (fd < 0)
+        throw system_error_for("open",a_filename);
+
+    if (ftruncate(fd,off_t(a_bytes)) != 0)
+    {
+        runtime_error error = system_error_for("ftruncate",a_filename);
+        close(fd);
+        throw error;
+    }
+
+    close(fd);
+}
+
+//--------------------------------------------------------------------------
+//  Advise the kernel of an access pattern
+void mapped_file::advise(advice a_advice, size_t a_offset, size_t a_length) const throw()
+{
+    if ((m_base == NULL) || (a_offset >= m_size))
+        return;
+
+    if (a_length > m_size - a_offset)
+        a_length = m_size - a_offset;
+
+    // the range, as offsets within the mapping
+    size_t page  = size_t(sysconf(_SC_PAGESIZE));
+    size_t first = size_t(static_cast<char *>(m_data) - static_cast<char *>(m_base)) + a_offset;
+    size_t last  = first + a_length;
+
+    if (a_advice == ADVISE_DONTNEED)
+    {
+        // discard only whole pages inside the range, so changes to
+        // COPY_ON_WRITE bytes next to it survive; the end of the
+        // mapping counts as a page boundary
+        first += (page - first % page) % page;
+
+        if (last < m_map_length)
+            last -= last % page;
+
+        if (first >= last)
+            return;
+    }
+    else
+    {
+        // madvise needs a page-aligned start
+        first -= first % page;
+    }
+
+    int flag = MADV_NORMAL;
+
+    switch (a_advice)
+    {
+    case ADVISE_SEQUENTIAL:
+        flag = MADV_SEQUENTIAL;
+        break;
+    case ADVISE_RANDOM:
+        flag = MADV_RANDOM;
+        break;
+    case ADVISE_WILLNEED:
+        flag = MADV_WILLNEED;
+        break;
+    case ADVISE_DONTNEED:
+        flag = MADV_DONTNEED;
+        break;
+    default:
+        break;
+    }
+
+    madvise(static_cast<char *>(m_base) + first,last - first,flag);
+}
+
+//--------------------------------------------------------------------------
+//  Write changes to the file
+void mapped_file::sync(bool a_wait) const
+{
+    if ((m_base == NULL) || (m_mode != SHARED))
+        return;
+
+    if (msync(m_base,m_map_length,a_wait ? MS_SYNC : MS_ASYNC) != 0)
+        throw runtime_error(string("msync failed: ") + strerror(errno));
+}
@@ -0,0 +1,441 @@
+//---------------------------------------------------------------------
+//  Algorithmic Conjurings @ http://www.coyotegulch.com
+//
+//  mmap_array.h (libcoyotl)
+//
+//  Arrays whose storage is a memory-mapped file, for persistent
+//  tables that load without reading or copying.
+//---------------------------------------------------------------------
+//
+//  Copyright 1990-2005 Scott Robert Ladd
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the
+//      Free Software Foundation, Inc.
+//      59 Temple Place - Suite 330
+//      Boston, MA 02111-1307, USA.
+//
+//-----------------------------------------------------------------------
+//
+//  For more information on this software package, please visit
+//  Scott's web site, Coyote Gulch Productions, at:
+//
+//      http://www.coyotegulch.com
+//
+//-----------------------------------------------------------------------
+
+#if !defined(LIBCOYOTL_MMAP_ARRAY_H)
+#define LIBCOYOTL_MMAP_ARRAY_H
+
+#include <cstddef>
+#include <string>
+#include <type_traits>
+
+#include "validator.h"     // validation functions
+#include "array_kernels.h" // copy, fill and compare
+#include "array_view.h"    // non-owning views
+#include "array_expr.h"    // element-wise arithmetic
+
+#if defined(LIBCOYOTL_BOUNDS_CHECKING)
+#define LIBCOYOTL_MMAP_ARRAY_EXCEPTIONS validation_error<size_t>
+#define LIBCOYOTL_MMAP_ARRAY_CHECK_INDEX(n) validate_less(n,m_size,LIBCOYOTL_LOCATION);
+#else
+#define LIBCOYOTL_MMAP_ARRAY_EXCEPTIONS
+#define LIBCOYOTL_MMAP_ARRAY_CHECK_INDEX(n)
+#endif
+
+namespace libcoyotl
+{
+    //! A memory-mapped region of a file
+    /*!
+        Maps a byte range of a file into memory with <i>mmap</i>. Pages are
+        read from the file on first touch, so mapping even a very large
+        file is nearly instantaneous. The file descriptor is closed once the
+        mapping exists; the mapping is released on destruction. Failures
+        throw <i>std::runtime_error</i>.
+    */
+    class mapped_file
+    {
+    public:
+        //! How the mapping shares changes with the file
+        enum mode
+        {
+            READ_ONLY,      //!> Pages may only be read; writing faults
+            COPY_ON_WRITE,  //!> Writes modify private copies of pages; the file is unchanged
+            SHARED          //!> Writes go to the file, and are visible to other mappings
+        };
+
+        //! Expected access pattern, passed to <i>madvise</i>
+        enum advice
+        {
+            ADVISE_NORMAL,      //!> No special treatment
+            ADVISE_SEQUENTIAL,  //!> Pages will be read in order; read ahead aggressively
+            ADVISE_RANDOM,      //!> Pages will be read at random; do not read ahead
+            ADVISE_WILLNEED,    //!> Pages will be needed soon; start reading them now
+            ADVISE_DONTNEED     //!> Pages are not needed for now; discards COPY_ON_WRITE changes to them
+        };
+
+        //! Constructor
+        /*!
+            Maps part or all of an existing file.
+            \param a_filename - Name of the file
+            \param a_mode - Sharing mode; SHARED requires write permission
+            \param a_offset - Offset, in bytes, of the first mapped byte
+            \param a_length - Number of bytes to map; by default, to the end of the file
+        */
+        mapped_file(const std::string & a_filename,
+                     mode a_mode = READ_ONLY,
+                     size_t a_offset = 0,
+                     size_t a_length = size_t(-1));
+
+        //! Move constructor
+        /*!
+            Takes over the mapping of another object, which is left empty.
+            \param a_source - The source object
+        */
+        mapped_file(mapped_file && a_source) throw();
+
+        //! Destructor
+        /*!
+            Unmaps the region. Changes to SHARED mappings reach the file even
+            without an explicit <i>sync</i>.
+        */
+        ~mapped_file() throw();
+
+        //! Move assignment
+        /*!
+            Unmaps the target's region and takes over the source's.
+            \param a_source - The source object
+        */
+        mapped_file & operator = (mapped_file && a_source) throw();
+
+        //! Create a file of a given size
+        /*!
+            Creates a file, or resizes an existing one, so that it holds
+            <i>a_bytes</i> bytes; new bytes read as zero. The file can then
+            be mapped in SHARED mode to fill it.
+            \param a_filename - Name of the file
+            \param a_bytes - Size of the file, in bytes
+        */
+        static void create(const std::string & a_filename, size_t a_bytes);
+
+        //! Mapped bytes
+        void * data() const throw()
+        {
+            return m_data;
+        }
+
+        //! Number of mapped bytes
+        size_t size() const throw()
+        {
+            return m_size;
+        }
+
+        //! Sharing mode
+        mode get_mode() const throw()
+        {
+            return m_mode;
+        }
+
+        //! Advise the kernel of an access pattern
+        /*!
+            Passes an access pattern for a byte range to <i>madvise</i>;
+            the advice is a hint, and failures are ignored. Most advice
+            covers every page the range touches. ADVISE_DONTNEED covers only
+            the whole pages inside the range (plus the partial page at the
+            end of the mapping), since it discards COPY_ON_WRITE changes to
+            each page it covers; a range with no whole page is ignored.
+            \param a_advice - Expected access pattern
+            \param a_offset - Offset, in bytes, of the range within the mapping
+            \param a_length - Number of bytes in the range; by default, to the end
+        */
+        void advise(advice a_advice, size_t a_offset = 0, size_t a_length = size_t(-1)) const throw();
+
+        //! Write changes to the file
+        /*!
+            Flushes modified pages of a SHARED mapping to the file with
+            <i>msync</i>; other modes have nothing to write.
+            \param a_wait - If <i>true</i>, wait until the data is written
+        */
+        void sync(bool a_wait = true) const;
+
+    private:
+        // mappings cannot be copied
+        mapped_file(const mapped_file &);
+        mapped_file & operator = (const mapped_file &);
+
+        // unmap the region
+        void unmap() throw();
+
+        // start of the page-aligned mapping
+        void * m_base;
+
+        // length of the page-aligned mapping
+        size_t m_map_length;
+
+        // first requested byte, within the mapping
+        void * m_data;
+
+        // number of requested bytes
+        size_t m_size;
+
+        // sharing mode
+        mode m_mode;
+    };
+
+    //! An array stored in a memory-mapped file
+    /*!
+        Presents a file (or part of one) as an array of <i>Type</i>, which
+        must be trivially copyable; elements are read directly from the
+        mapped pages, so opening a table of many gigabytes takes only as long
+        as the <i>mmap</i> call. The file's bytes are the elements' in-memory
+        representation, so files are not portable between architectures with
+        different byte orders or type layouts.
+
+        mmap_array shares the element access, iterator, view, comparison,
+        assignment and expression interface of <i>array</i>. Its length is
+        fixed by the file, so it cannot be appended to. Storing into a
+        READ_ONLY array faults.
+    */
+    template <typename Type>
+    class mmap_array
+    {
+    public:
+        //! Type of an array element
+        typedef Type         value_type;
+
+        //! type of a pointer to an element
+        typedef Type *       pointer;
+
+        //! Type of a constant pointer to an element
+        typedef const Type * const_pointer;
+
+        //! Type of a reference to an element
+        typedef Type &       reference;
+
+        //! Type of a constant reference to an element
+        typedef const Type & const_reference;
+
+        //! Difference type between two element pointers
+        typedef ptrdiff_t    difference_type;
+
+        //! Size type for indexing array elements
+        typedef size_t       size_type;
+
+        //! Iterator type
+        typedef Type *       iterator;
+
+        //! Constant iterator type
+        typedef const Type * const_iterator;
+
+        //! Constructor
+        /*!
+            Maps elements of an existing file. A trailing partial element
+            is ignored.
+            \param a_filename - Name of the file
+            \param a_mode - Sharing mode
+            \param a_offset - Index, in elements, of the first mapped element
+            \param a_length - Number of elements; by default, to the end of the file
+        */
+        mmap_array(const std::string & a_filename,
+                   mapped_file::mode a_mode = mapped_file::READ_ONLY,
+                   size_t a_offset = 0,
+                   size_t a_length = size_t(-1))
+          : m_file(a_filename,a_mode,a_offset * sizeof(Type),(a_length == size_t(-1)) ? a_length : a_length * sizeof(Type)),
+            m_array(static_cast<Type *>(m_file.data())),
+            m_size(m_file.size() / sizeof(Type))
+        {
+            // nada
+        }
+
+        //! Move constructor
+        mmap_array(mmap_array && a_source) throw()
+          : m_file(static_cast<mapped_file &&>(a_source.m_file)),
+            m_array(a_source.m_array),
+            m_size(a_source.m_size)
+        {
+            a_source.m_array = NULL;
+            a_source.m_size  = 0;
+        }
+
+        //! Move assignment
+        mmap_array & operator = (mmap_array && a_source) throw()
+        {
+            m_file  = static_cast<mapped_file &&>(a_source.m_file);
+            m_array = a_source.m_array;
+            m_size  = a_source.m_size;
+            a_source.m_array = NULL;
+            a_source.m_size  = 0;
+            return *this;
+        }
+
+        //! Create a file-backed array
+        /*!
+            Creates (or resizes) a file to hold <i>a_length</i> elements and
+            maps it in SHARED mode; new elements read as zero bytes.
+            \param a_filename - Name of the file
+            \param a_length - Number of elements
+            \return An array backed by the file
+        */
+        static mmap_array create(const std::string & a_filename, size_t a_length)
+        {
+            mapped_file::create(a_filename,a_length * sizeof(Type));
+            return mmap_array(a_filename,mapped_file::SHARED);
+        }
+
+        //! Assign value to all elements
+        mmap_array & operator = (const Type & a_value) throw()
+        {
+            fill_elements(m_array,m_size,a_value);
+            return *this;
+        }
+
+        //! Assign from C-style array
+        mmap_array & operator = (const Type * a_carray) throw()
+        {
+            copy_elements(m_array,a_carray,m_size);
+            return *this;
+        }
+
+        //! Assign from an expression
+        template <class Expr>
+        mmap_array & operator = (const array_expression<Expr> & a_expr)
+        {
+            evaluate(m_array,m_size,a_expr);
+            return *this;
+        }
+
+        //! Advise the kernel of an access pattern for all elements
+        void advise(mapped_file::advice a_advice) const throw()
+        {
+            m_file.advise(a_advice);
+        }
+
+        //! Advise the kernel of an access pattern for some elements
+        /*!
+            Passes the bytes of a range of elements to
+            <i>mapped_file::advise</i>. ADVISE_DONTNEED discards only pages
+            lying wholly inside the range, so COPY_ON_WRITE changes to
+            neighbouring elements survive; elements of the range that share
+            a page with elements outside it keep their changes too.
+            \param a_advice - Expected access pattern
+            \param a_offset - Index of the first element
+            \param a_length - Number of elements
+        */
+        void advise(mapped_file::advice a_advice, size_t a_offset, size_t a_length) const throw()
+        {
+            m_file.advise(a_advice,a_offset * sizeof(Type),a_length * sizeof(Type));
+        }
+
+        //! Write changes to the file (SHARED mode)
+        void sync(bool a_wait = true) const
+        {
+            m_file.sync(a_wait);
+        }
+
+        //! Sharing mode
+        mapped_file::mode get_mode() const throw()
+        {
+            return m_file.get_mode();
+        }
+
+        //! Conversion to C-style array
+        const Type * c_array() const throw() { return m_array; }
+
+        //! Element access
+        Type & operator [] (size_t n) throw(LIBCOYOTL_MMAP_ARRAY_EXCEPTIONS)
+        {
+            LIBCOYOTL_MMAP_ARRAY_CHECK_INDEX(n)
+            return m_array[n];
+        }
+
+        //! Element access, constant array
+        const Type & operator [] (size_t n) const throw(LIBCOYOTL_MMAP_ARRAY_EXCEPTIONS)
+        {
+            LIBCOYOTL_MMAP_ARRAY_CHECK_INDEX(n)
+            return m_array[n];
+        }
+
+        //! View of all elements
+        array_view<Type> view() throw() { return array_view<Type>(m_array,m_size); }
+
+        //! Read-only view of all elements
+        array_view<const Type> view() const throw() { return array_view<const Type>(m_array,m_size); }
+
+        //! View of a subrange
+        array_view<Type> view(size_t a_offset, size_t a_length) { return view().subview(a_offset,a_length); }
+
+        //! Read-only view of a subrange
+        array_view<const Type> view(size_t a_offset, size_t a_length) const { return view().subview(a_offset,a_length); }
+
+        //! Obtain beginning-of-sequence iterator
+        iterator begin() throw() { return m_array; }
+
+        //! Obtain beginning-of-sequence iterator, constant array
+        const_iterator begin() const throw() { return m_array; }
+
+        //! Obtain end-of-sequence iterator
+        iterator end() throw() { return m_array + m_size; }
+
+        //! Obtain end-of-sequence iterator, constant array
+        const_iterator end() const throw() { return m_array + m_size; }
+
+        //! Equals operator; arrays of different lengths are unequal
+        bool operator == (const mmap_array & a_comparand) const throw()
+        {
+            return (m_size == a_comparand.m_size) && equal_elements(m_array,a_comparand.m_array,m_size);
+        }
+
+        //! Inequality operator
+        bool operator != (const mmap_array & a_comparand) const throw() { return !(*this == a_comparand); }
+
+        //! Less-than operator, comparing lexicographically
+        bool operator <  (const mmap_array & a_comparand) const throw()
+        {
+            return less_elements<Type>(m_array,m_size,a_comparand.m_array,a_comparand.m_size);
+        }
+
+        //! Greater-than operator
+        bool operator >  (const mmap_array & a_comparand) const throw() { return (a_comparand < *this); }
+
+        //! Less-than-or-equal-to operator
+        bool operator <= (const mmap_array & a_comparand) const throw() { return !(a_comparand < *this); }
+
+        //! Greater-than-or-equal-to operator
+        bool operator >= (const mmap_array & a_comparand) const throw() { return !(*this < a_comparand); }
+
+        //! Number of elements
+        size_t size() const throw() { return m_size; }
+
+        //! Maximum container size, which is the same as <i>size()</i>
+        size_t max_size() const throw() { return m_size; }
+
+        //! Empty container check
+        bool empty() const throw() { return (m_size == 0); }
+
+    private:
+        static_assert(std::is_trivially_copyable<Type>::value,"mmap_array elements must be trivially copyable");
+
+        // the mapping
+        mapped_file m_file;
+
+        // elements
+        Type * m_array;
+
+        // number of elements
+        size_t m_size;
+    };
+
+} // end namespace libcoyotl
+
+#endif
@@ -0,0 +1,428 @@
+//---------------------------------------------------------------------
+//  Algorithmic Conjurings @ http://www.coyotegulch.com
+//
+//  ndarray.h (libcoyotl)
+//
+//  A dense, row-major array of any fixed number of dimensions,
+//  stored in a single contiguous block.
+//---------------------------------------------------------------------
+//
+//  Copyright 1990-2005 Scott Robert Ladd
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the
+//      Free Software Foundation, Inc.
+//      59 Temple Place - Suite 330
+//      Boston, MA 02111-1307, USA.
+//
+//-----------------------------------------------------------------------
+//
+//  For more information on this software package, please visit
+//  Scott's web site, Coyote Gulch Productions, at:
+//
+//      http://www.coyotegulch.com
+//
+//-----------------------------------------------------------------------
+
+#if !defined(LIBCOYOTL_NDARRAY_H)
+#define LIBCOYOTL_NDARRAY_H
+
+#include <cstddef>
+
+#include "validator.h"     // validation functions
+#include "allocators.h"    // storage policies
+#include "array_kernels.h" // copy, fill and compare
+#include "array_view.h"    // non-owning views
+#include "array_expr.h"    // element-wise arithmetic
+#include "fixed_array.h"   // shapes and indices
+
+namespace libcoyotl
+{
+    //! A dense, row-major N-dimensional array
+    /*!
+        Stores the elements of an array with <i>N</i> dimensions in one
+        unpadded block, with the last index varying fastest. The stride of
+        each dimension is the number of elements between successive values
+        of its index, so the element at index (i<sub>0</sub>, ... ,
+        i<sub>N-1</sub>) lies at the sum of i<sub>k</sub> * stride<sub>k</sub>.
+        Because the storage is contiguous, an ndarray can be used in the
+        element-wise expressions of array_expr.h, and a line along any axis
+        is available as a strided <i>array_view</i>.
+    */
+    template <typename Type, size_t N, typename Allocator = aligned_allocator<64> >
+    class ndarray
+    {
+        static_assert(N > 0, "an ndarray needs at least one dimension");
+
+    public:
+        //! Type of an element
+        typedef Type                   value_type;
+
+        //! Size type for indexing elements
+        typedef size_t                 size_type;
+
+        //! Storage policy
+        typedef Allocator              allocator_type;
+
+        //! Type of a shape, stride or index
+        typedef fixed_array<size_t,N>  index_type;
+
+        //! Constructor
+        /*!
+            Constructs an array of default-initialized elements.
+            \param a_shape - Extent of each dimension
+            \param a_allocator - Source of storage
+        */
+        explicit ndarray(const index_type & a_shape, const Allocator & a_allocator = Allocator());
+
+        //! Initialization constructor
+        /*!
+            Constructs an array with every element set to a given value.
+            \param a_shape - Extent of each dimension
+            \param a_init_value - Initial value of all elements
+            \param a_allocator - Source of storage
+        */
+        ndarray(const index_type & a_shape, const Type & a_init_value, const Allocator & a_allocator = Allocator());
+
+        //! Copy constructor
+        ndarray(const ndarray & a_source);
+
+        //! Move constructor
+        /*!
+            Takes ownership of the source's elements; the source is left with
+            no elements (all extents zero).
+            \param a_source - The source object
+        */
+        ndarray(ndarray && a_source) throw();
+
+        //! Destructor
+        ~ndarray() throw();
+
+        //! Assignment operator
+        ndarray & operator = (const ndarray & a_source);
+
+        //! Move assignment operator
+        ndarray & operator = (ndarray && a_source) throw();
+
+        //! Assign value to all elements
+        ndarray & operator = (const Type & a_value) throw()
+        {
+            fill_elements(m_data,m_size,a_value);
+            return *this;
+        }
+
+        //! Assign from an expression
+        /*!
+            Computes an element-wise expression (see array_expr.h) into the array.
+            \param a_expr - An expression over arrays of the target's size
+        */
+        template <class Expr>
+        ndarray & operator = (const array_expression<Expr> & a_expr)
+        {
+            evaluate(m_data,m_size,a_expr);
+            return *this;
+        }
+
+        //! Element access by individual indices
+        /*!
+            Indices are given in dimension order, one per dimension.
+            \return Reference to the indexed element
+        */
+        template <typename... Indices>
+        Type & operator () (Indices... a_indices) throw()
+        {
+            static_assert(sizeof...(Indices) == N, "one index is required per dimension");
+            return m_data[offset_of(a_indices...)];
+        }
+
+        //! Element access by individual indices, constant array
+        template <typename... Indices>
+        const Type & operator () (Indices... a_indices) const throw()
+        {
+            static_assert(sizeof...(Indices) == N, "one index is required per dimension");
+            return m_data[offset_of(a_indices...)];
+        }
+
+        //! Checked element access by index tuple
+        /*!
+            \param a_index - Index in each dimension
+            \return Reference to the indexed element
+        */
+        Type & at(const index_type & a_index)
+        {
+            return m_data[checked_offset(a_index)];
+        }
+
+        //! Checked element access by index tuple, constant array
+        const Type & at(const index_type & a_index) const
+        {
+            return m_data[checked_offset(a_index)];
+        }
+
+        //! View of all elements, in storage order
+        array_view<Type> view() throw() { return array_view<Type>(m_data,m_size); }
+
+        //! Read-only view of all elements, in storage order
+        array_view<const Type> view() const throw() { return array_view<const Type>(m_data,m_size); }
+
+        //! View of a line along one axis
+        /*!
+            Returns the elements whose indices match <i>a_start</i> in every
+            dimension except <i>a_axis</i>, which runs from
+            <i>a_start[a_axis]</i> to the end of that dimension.
+            \param a_start - Index of the first element of the line
+            \param a_axis - Dimension along which the line runs
+            \return A view strided by the axis' stride
+        */
+        array_view<Type> axis_view(const index_type & a_start, size_t a_axis)
+        {
+            size_t offset = checked_offset(a_start);
+            validate_less(a_axis,N,LIBCOYOTL_LOCATION);
+            return array_view<Type>(m_data + offset,m_shape[a_axis] - a_start[a_axis],ptrdiff_t(m_strides[a_axis]));
+        }
+
+        //! Read-only view of a line along one axis
+        array_view<const Type> axis_view(const index_type & a_start, size_t a_axis) const
+        {
+            size_t offset = checked_offset(a_start);
+            validate_less(a_axis,N,LIBCOYOTL_LOCATION);
+            return array_view<const Type>(m_data + offset,m_shape[a_axis] - a_start[a_axis],ptrdiff_t(m_strides[a_axis]));
+        }
+
+        //! Exchange the contents of two arrays
+        void swap(ndarray & a_source) throw();
+
+        //! Extent of each dimension
+        const index_type & get_shape() const throw() { return m_shape; }
+
+        //! Stride of each dimension, in elements
+        const index_type & get_strides() const throw() { return m_strides; }
+
+        //! Get the allocator
+        const Allocator & get_allocator() const throw() { return m_allocator; }
+
+        //! Total number of elements
+        size_t size() const throw() { return m_size; }
+
+        //! Empty array check
+        bool empty() const throw() { return m_size == 0; }
+
+        //! Conversion to C-style array
+        const Type * c_array() const throw() { return m_data; }
+
+        //! First element
+        Type * data() throw() { return m_data; }
+
+        //! First element, constant array
+        const Type * data() const throw() { return m_data; }
+
+        //! Equals operator; arrays of different shapes are unequal
+        bool operator == (const ndarray & a_comparand) const throw()
+        {
+            return (m_shape == a_comparand.m_shape) && equal_elements(m_data,a_comparand.m_data,m_size);
+        }
+
+        //! Inequality operator
+        bool operator != (const ndarray & a_comparand) const throw() { return !(*this == a_comparand); }
+
+    private:
+        // compute strides and size from the shape
+        void set_shape(const index_type & a_shape) throw();
+
+        // offset of an element, from individual indices
+        template <typename... Indices>
+        size_t offset_of(Indices... a_indices) const throw()
+        {
+            const size_t index[N] = { size_t(a_indices)... };
+            size_t offset = 0;
+
+            for (size_t k = 0; k < N; ++k)
+                offset += index[k] * m_strides[k];
+
+            return offset;
+        }
+
+        // offset of an element, validating each index
+        size_t checked_offset(const index_type & a_index) const
+        {
+            size_t offset = 0;
+
+            for (size_t k = 0; k < N; ++k)
+            {
+                validate_less(a_index[k],m_shape[k],LIBCOYOTL_LOCATION);
+                offset += a_index[k] * m_strides[k];
+            }
+
+            return offset;
+        }
+
+        // elements
+        Type * m_data;
+
+        // extents and strides
+        index_type m_shape;
+        index_type m_strides;
+
+        // total number of elements
+        size_t m_size;
+
+        // source of storage
+        Allocator m_allocator;
+    };
+
+    // compute strides and size from the shape
+    template <typename Type, size_t N, typename Allocator>
+    void ndarray<Type,N,Allocator>::set_shape(const index_type & a_shape) throw()
+    {
+        m_shape = a_shape;
+        m_size  = 1;
+
+        for (size_t k = N; k > 0; --k)
+        {
+            m_strides[k - 1] = m_size;
+            m_size *= m_shape[k - 1];
+        }
+    }
+
+    // constructor
+    template <typename Type, size_t N, typename Allocator>
+    ndarray<Type,N,Allocator>::ndarray(const index_type & a_shape, const Allocator & a_allocator)
+      : m_data(NULL),
+        m_size(0),
+        m_allocator(a_allocator)
+    {
+        set_shape(a_shape);
+
+        if (m_size > 0)
+            m_data = m_allocator.template allocate<Type>(m_size);
+    }
+
+    // initialization constructor
+    template <typename Type, size_t N, typename Allocator>
+    ndarray<Type,N,Allocator>::ndarray(const index_type & a_shape, const Type & a_init_value, const Allocator & a_allocator)
+      : m_data(NULL),
+        m_size(0),
+        m_allocator(a_allocator)
+    {
+        set_shape(a_shape);
+
+        if (m_size > 0)
+            m_data = m_allocator.template allocate<Type>(m_size);
+
+        fill_elements(m_data,m_size,a_init_value);
+    }
+
+    // copy constructor
+    template <typename Type, size_t N, typename Allocator>
+    ndarray<Type,N,Allocator>::ndarray(const ndarray & a_source)
+      : m_data(NULL),
+        m_shape(a_source.m_shape),
+        m_strides(a_source.m_strides),
+        m_size(a_source.m_size),
+        m_allocator(a_source.m_allocator)
+    {
+        if (m_size > 0)
+            m_data = m_allocator.template allocate<Type>(m_size);
+
+        copy_elements(m_data,a_source.m_data,m_size);
+    }
+
+    // move constructor
+    template <typename Type, size_t N, typename Allocator>
+    ndarray<Type,N,Allocator>::ndarray(ndarray && a_source) throw()
+      : m_data(a_source.m_data),
+        m_shape(a_source.m_shape),
+        m_strides(a_source.m_strides),
+        m_size(a_source.m_size),
+        m_allocator(a_source.m_allocator)
+    {
+        a_source.m_data = NULL;
+        a_source.m_size = 0;
+        a_source.m_shape = size_t(0);
+    }
+
+    // destructor
+    template <typename Type, size_t N, typename Allocator>
+    ndarray<Type,N,Allocator>::~ndarray() throw()
+    {
+        m_allocator.deallocate(m_data,m_size);
+    }
+
+    // assignment operator
+    template <typename Type, size_t N, typename Allocator>
+    ndarray<Type,N,Allocator> & ndarray<Type,N,Allocator>::operator = (const ndarray & a_source)
+    {
+        if (this != &a_source)
+        {
+            if (m_shape != a_source.m_shape)
+            {
+                ndarray temp(a_source);
+                swap(temp);
+            }
+            else
+                copy_elements(m_data,a_source.m_data,m_size);
+        }
+
+        return *this;
+    }
+
+    // move assignment operator
+    template <typename Type, size_t N, typename Allocator>
+    ndarray<Type,N,Allocator> & ndarray<Type,N,Allocator>::operator = (ndarray && a_source) throw()
+    {
+        if (this != &a_source)
+        {
+            m_allocator.deallocate(m_data,m_size);
+
+            m_data      = a_source.m_data;
+            m_shape     = a_source.m_shape;
+            m_strides   = a_source.m_strides;
+            m_size      = a_source.m_size;
+            m_allocator = a_source.m_allocator;
+
+            a_source.m_data  = NULL;
+            a_source.m_size  = 0;
+            a_source.m_shape = size_t(0);
+        }
+
+        return *this;
+    }
+
+    // exchange contents
+    template <typename Type, size_t N, typename Allocator>
+    void ndarray<Type,N,Allocator>::swap(ndarray & a_source) throw()
+    {
+        Type * temp_data = m_data;
+        m_data = a_source.m_data;
+        a_source.m_data = temp_data;
+
+        index_type temp_index = m_shape;
+        m_shape = a_source.m_shape;
+        a_source.m_shape = temp_index;
+
+        temp_index = m_strides;
+        m_strides = a_source.m_strides;
+        a_source.m_strides = temp_index;
+
+        size_t temp_size = m_size;
+        m_size = a_source.m_size;
+        a_source.m_size = temp_size;
+
+        Allocator temp_allocator = m_allocator;
+        m_allocator = a_source.m_allocator;
+        a_source.m_allocator = temp_allocator;
+    }
+
+} // end namespace libcoyotl
+
+#endif
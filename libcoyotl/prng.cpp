@@ -66,6 +66,13 @@ prng::prng(uint32_t seed)
     // nada
 }
 
+//---------------------------------------------------------------------------
+//  Virtual destructor
+prng::~prng()
+{
+    // nada
+}
+
 //---------------------------------------------------------------------------
 //  Initializes the generator with "seed"
 void prng::init(uint32_t seed)
@@ -74,6 +74,13 @@ namespace libcoyotl
         */
         prng(uint32_t seed);
 
+        //! Virtual destructor
+        /*!
+            Does nothing in this class, but ensures that generators destroyed
+            through a <i>prng</i> pointer release their own resources.
+        */
+        virtual ~prng();
+
         //! Initializes the generator with "seed"
         /*!
             Resets the generator using the provided seed value.
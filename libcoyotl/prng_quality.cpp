@@ -0,0 +1,539 @@
+//---------------------------------------------------------------------
+//  Algorithmic Conjurings @ http://www.coyotegulch.com
+//
+//  prng_quality.cpp (libcoyotl)
+//
+//  A compact, multithreaded battery of statistical tests for
+//  pseudorandom number generators.
+//---------------------------------------------------------------------
+//
+//  Copyright 1990-2005 Scott Robert Ladd
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the
+//      Free Software Foundation, Inc.
+//      59 Temple Place - Suite 330
+//      Boston, MA 02111-1307, USA.
+//
+//-----------------------------------------------------------------------
+//
+//  For more information on this software package, please visit
+//  Scott's web site, Coyote Gulch Productions, at:
+//
+//      http://www.coyotegulch.com
+//
+//-----------------------------------------------------------------------
+
+// Standard C++ library
+#include <cmath>
+#include <stdexcept>
+#include <thread>
+
+// libcoyotl
+#include "prng_quality.h"
+#include "sortutil.h"
+#include "realutil.h"
+
+using namespace libcoyotl;
+using namespace std;
+
+//--------------------------------------------------------------------------
+//  Statistical helpers
+
+namespace
+{
+    // regularized upper incomplete gamma function Q(a,x), after Numerical Recipes
+    double gamma_q(double a, double x)
+    {
+        static const int    ITMAX = 1000;
+        static const double EPS   = 1.0e-15;
+        static const double FPMIN = 1.0e-300;
+
+        if (x <= 0.0)
+            return 1.0;
+
+        double gln = lgamma(a);
+
+        if (x < a + 1.0)
+        {
+            // series representation of P(a,x)
+            double ap  = a;
+            double del = 1.0 / a;
+            double sum = del;
+
+            for (int n = 0; n < ITMAX; ++n)
+            {
+                ap  += 1.0;
+                del *= x / ap;
+                sum += del;
+
+                if (fabs(del) < fabs(sum) * EPS)
+                    break;
+            }
+
+            return 1.0 - sum * exp(-x + a * log(x) - gln);
+        }
+        else
+        {
+            // continued fraction representation of Q(a,x)
+            double b = x + 1.0 - a;
+            double c = 1.0 / FPMIN;
+            double d = 1.0 / b;
+            double h = d;
+
+            for (int i = 1; i <= ITMAX; ++i)
+            {
+                double an = -i * (i - a);
+                b += 2.0;
+                d = an * d + b;
+
+                if (fabs(d) < FPMIN)
+                    d = FPMIN;
+
+                c = b + an / c;
+
+                if (fabs(c) < FPMIN)
+                    c = FPMIN;
+
+                d = 1.0 / d;
+                double del = d * c;
+                h *= del;
+
+                if (fabs(del - 1.0) < EPS)
+                    break;
+            }
+
+            return exp(-x + a * log(x) - gln) * h;
+        }
+    }
+
+    // probability that a random m-by-n matrix over GF(2) has rank r
+    double matrix_rank_probability(int r, int m, int n)
+    {
+        double product = 1.0;
+
+        for (int i = 0; i < r; ++i)
+            product *= ((1.0 - ldexp(1.0,i - m)) * (1.0 - ldexp(1.0,i - n))) / (1.0 - ldexp(1.0,i - r));
+
+        return ldexp(product,r * (m + n - r) - m * n);
+    }
+
+    //----------------------------------------------------------------------
+    //  Chunk counters, one per test
+
+    // frequency: high byte of each value
+    void count_frequency(prng & a_generator, size_t a_samples, vector<double> & a_counts)
+    {
+        for (size_t n = 0; n < a_samples; ++n)
+            a_counts[a_generator.get_rand() >> 24] += 1.0;
+    }
+
+    // serial: non-overlapping pairs of high nybbles
+    void count_serial(prng & a_generator, size_t a_samples, vector<double> & a_counts)
+    {
+        for (size_t n = 0; n < a_samples / 2; ++n)
+        {
+            uint32_t first  = a_generator.get_rand() >> 28;
+            uint32_t second = a_generator.get_rand() >> 28;
+            a_counts[(first << 4) | second] += 1.0;
+        }
+    }
+
+    // gap: gaps between values in [0,1/4)
+    const size_t GAP_LIMIT = 24;
+
+    void count_gap(prng & a_generator, size_t a_samples, vector<double> & a_counts)
+    {
+        size_t gap = 0;
+
+        for (size_t n = 0; n < a_samples; ++n)
+        {
+            if (a_generator.get_rand() < 0x40000000UL)
+            {
+                a_counts[gap < GAP_LIMIT ? gap : GAP_LIMIT] += 1.0;
+                gap = 0;
+            }
+            else
+                ++gap;
+        }
+    }
+
+    // birthday spacings: 512 birthdays in a year of 2^24 days
+    const size_t BIRTHDAYS     = 512;
+    const size_t BIRTHDAY_CATS = 7;
+
+    void count_birthday_spacings(prng & a_generator, size_t a_samples, vector<double> & a_counts)
+    {
+        uint32_t days[BIRTHDAYS];
+        uint32_t spacings[BIRTHDAYS];
+
+        for (size_t n = 0; n < a_samples / BIRTHDAYS; ++n)
+        {
+            for (size_t i = 0; i < BIRTHDAYS; ++i)
+                days[i] = a_generator.get_rand() >> 8;
+
+            shell_sort(days,BIRTHDAYS);
+
+            spacings[0] = days[0];
+
+            for (size_t i = 1; i < BIRTHDAYS; ++i)
+                spacings[i] = days[i] - days[i - 1];
+
+            shell_sort(spacings,BIRTHDAYS);
+
+            size_t duplicates = 0;
+
+            for (size_t i = 1; i < BIRTHDAYS; ++i)
+            {
+                if (spacings[i] == spacings[i - 1])
+                    ++duplicates;
+            }
+
+            if (duplicates >= BIRTHDAY_CATS)
+                duplicates = BIRTHDAY_CATS - 1;
+
+            a_counts[duplicates] += 1.0;
+        }
+    }
+
+    // matrix rank: 32x32 matrices over GF(2), rows are successive values
+    void count_matrix_rank(prng & a_generator, size_t a_samples, vector<double> & a_counts)
+    {
+        uint32_t rows[32];
+
+        for (size_t n = 0; n < a_samples / 32; ++n)
+        {
+            for (size_t i = 0; i < 32; ++i)
+                rows[i] = a_generator.get_rand();
+
+            // Gaussian elimination
+            size_t rank = 0;
+
+            for (int bit = 31; (bit >= 0) && (rank < 32); --bit)
+            {
+                uint32_t mask = uint32_t(1) << bit;
+                size_t pivot = rank;
+
+                while ((pivot < 32) && !(rows[pivot] & mask))
+                    ++pivot;
+
+                if (pivot == 32)
+                    continue;
+
+                uint32_t temp = rows[pivot];
+                rows[pivot]   = rows[rank];
+                rows[rank]    = temp;
+
+                for (size_t i = rank + 1; i < 32; ++i)
+                {
+                    if (rows[i] & mask)
+                        rows[i] ^= temp;
+                }
+
+                ++rank;
+            }
+
+            // categories: 32, 31, <= 30
+            a_counts[rank >= 31 ? 32 - rank : 2] += 1.0;
+        }
+    }
+
+    // linear complexity: Berlekamp-Massey over 512-bit blocks, using
+    // bit-packed polynomials so each step costs a handful of word operations
+    const size_t LC_BITS  = 512;
+    const size_t LC_WORDS = LC_BITS / 64 + 2;
+
+    // extract 64 bits of a packed sequence, starting at a bit position
+    inline uint64_t extract_bits(const uint64_t * a_bits, size_t a_pos)
+    {
+        size_t word  = a_pos >> 6;
+        size_t shift = a_pos & 63;
+
+        if (shift == 0)
+            return a_bits[word];
+
+        return (a_bits[word] >> shift) | (a_bits[word + 1] << (64 - shift));
+    }
+
+    size_t linear_complexity_of(const uint64_t * a_reversed)
+    {
+        uint64_t c[LC_WORDS] = { 1 };
+        uint64_t b[LC_WORDS] = { 1 };
+        uint64_t t[LC_WORDS];
+
+        size_t L = 0;
+        long   m = -1;
+
+        for (size_t N = 0; N < LC_BITS; ++N)
+        {
+            // discrepancy: s[N] + sum c[i] * s[N - i]
+            size_t offset = LC_BITS - 1 - N;
+            uint64_t d = 0;
+
+            for (size_t k = 0; k <= L / 64; ++k)
+                d ^= c[k] & extract_bits(a_reversed,offset + 64 * k);
+
+            if (__builtin_parityll(d))
+            {
+                // highest word either polynomial can occupy at this step
+                size_t top  = min_of((N + 1) >> 6,LC_WORDS - 1);
+                bool   grow = (2 * L <= N);
+
+                if (grow)
+                {
+                    for (size_t k = 0; k <= top; ++k)
+                        t[k] = c[k];
+                }
+
+                // c ^= b << (N - m)
+                size_t shift      = size_t(long(N) - m);
+                size_t word_shift = shift >> 6;
+                size_t bit_shift  = shift & 63;
+
+                for (size_t k = top + 1; k-- > word_shift; )
+                {
+                    uint64_t v = b[k - word_shift] << bit_shift;
+
+                    if ((bit_shift != 0) && (k > word_shift))
+                        v |= b[k - word_shift - 1] >> (64 - bit_shift);
+
+                    c[k] ^= v;
+                }
+
+                if (grow)
+                {
+                    L = N + 1 - L;
+                    m = long(N);
+
+                    for (size_t k = 0; k <= top; ++k)
+                        b[k] = t[k];
+                }
+            }
+        }
+
+        return L;
+    }
+
+    const size_t LC_CATS = 7;
+
+    void count_linear_complexity(prng & a_generator, size_t a_samples, vector<double> & a_counts)
+    {
+        // reversed bit sequence, zero-padded past the end
+        uint64_t reversed[2 * LC_WORDS + 2];
+
+        for (size_t n = 0; n < a_samples / (LC_BITS / 32); ++n)
+        {
+            for (size_t k = 0; k < 2 * LC_WORDS + 2; ++k)
+                reversed[k] = 0;
+
+            // bit j of the sequence is stored at position LC_BITS - 1 - j, so
+            // each value lands bit-reversed in a 32-bit field
+            for (size_t j = 0; j < LC_BITS; j += 32)
+            {
+                uint32_t value = a_generator.get_rand();
+
+                value = ((value >> 1) & 0x55555555UL) | ((value & 0x55555555UL) << 1);
+                value = ((value >> 2) & 0x33333333UL) | ((value & 0x33333333UL) << 2);
+                value = ((value >> 4) & 0x0F0F0F0FUL) | ((value & 0x0F0F0F0FUL) << 4);
+                value = ((value >> 8) & 0x00FF00FFUL) | ((value & 0x00FF00FFUL) << 8);
+                value = (value >> 16) | (value << 16);
+
+                size_t pos = LC_BITS - 32 - j;
+                reversed[pos >> 6] |= uint64_t(value) << (pos & 63);
+            }
+
+            // for M = 512, the NIST statistic T reduces to L - 256
+            long T = long(linear_complexity_of(reversed)) - long(LC_BITS / 2);
+
+            if (T < -3)
+                T = -3;
+            else if (T > 3)
+                T = 3;
+
+            a_counts[T + 3] += 1.0;
+        }
+    }
+
+    // worker body for one chunk of a test
+    void run_chunk(prng_battery::factory a_factory,
+                   uint32_t a_seed,
+                   void (*a_counter)(prng &, size_t, vector<double> &),
+                   size_t a_samples,
+                   vector<double> * a_counts)
+    {
+        prng * generator = a_factory(a_seed);
+        a_counter(*generator,a_samples,*a_counts);
+        delete generator;
+    }
+}
+
+//--------------------------------------------------------------------------
+//  Constructor
+prng_battery::prng_battery(factory a_factory, size_t a_sample_size, uint32_t a_seed, size_t a_threads)
+  : m_factory(a_factory),
+    m_sample_size(a_sample_size),
+    m_seed(a_seed),
+    m_threads(a_threads)
+{
+    if (m_factory == NULL)
+        throw invalid_argument("prng_battery requires a generator factory");
+
+    if (m_threads == 0)
+        m_threads = thread::hardware_concurrency();
+
+    if (m_threads == 0)
+        m_threads = 1;
+}
+
+//--------------------------------------------------------------------------
+//  Runs a test's chunks in parallel and computes chi-square
+prng_test_result prng_battery::run_test(const char * a_name,
+                                        chunk_counter a_counter,
+                                        const vector<double> & a_probabilities) const
+{
+    vector< vector<double> > counts(m_threads,vector<double>(a_probabilities.size(),0.0));
+    vector<thread> workers;
+
+    // spread the samples across chunks; each chunk gets its own stream
+    for (size_t i = 0; i < m_threads; ++i)
+    {
+        size_t samples = m_sample_size / m_threads + (i < m_sample_size % m_threads ? 1 : 0);
+        uint32_t seed  = m_seed + uint32_t(i) * 0x9E3779B9UL;
+        workers.push_back(thread(run_chunk,m_factory,seed,a_counter,samples,&counts[i]));
+    }
+
+    for (size_t i = 0; i < workers.size(); ++i)
+        workers[i].join();
+
+    // merge chunk counts
+    vector<double> observed(a_probabilities.size(),0.0);
+    double total = 0.0;
+
+    for (size_t i = 0; i < m_threads; ++i)
+    {
+        for (size_t c = 0; c < observed.size(); ++c)
+        {
+            observed[c] += counts[i][c];
+            total += counts[i][c];
+        }
+    }
+
+    // chi-square against expected counts
+    prng_test_result result;
+    result.m_name       = a_name;
+    result.m_samples    = m_sample_size;
+    result.m_chi_square = 0.0;
+    result.m_degrees    = observed.size() - 1;
+
+    for (size_t c = 0; c < observed.size(); ++c)
+    {
+        double expected = total * a_probabilities[c];
+        double diff     = observed[c] - expected;
+        result.m_chi_square += diff * diff / expected;
+    }
+
+    result.m_p_value = (total > 0.0) ? gamma_q(result.m_degrees / 2.0,result.m_chi_square / 2.0) : 0.0;
+
+    return result;
+}
+
+//--------------------------------------------------------------------------
+//  Runs every test in the battery
+vector<prng_test_result> prng_battery::run() const
+{
+    vector<prng_test_result> results;
+
+    results.push_back(frequency());
+    results.push_back(serial());
+    results.push_back(gap());
+    results.push_back(birthday_spacings());
+    results.push_back(matrix_rank());
+    results.push_back(linear_complexity());
+
+    return results;
+}
+
+//--------------------------------------------------------------------------
+//  Frequency test
+prng_test_result prng_battery::frequency() const
+{
+    return run_test("frequency",count_frequency,vector<double>(256,1.0 / 256.0));
+}
+
+//--------------------------------------------------------------------------
+//  Serial test
+prng_test_result prng_battery::serial() const
+{
+    return run_test("serial",count_serial,vector<double>(256,1.0 / 256.0));
+}
+
+//--------------------------------------------------------------------------
+//  Gap test
+prng_test_result prng_battery::gap() const
+{
+    vector<double> probabilities(GAP_LIMIT + 1);
+
+    for (size_t r = 0; r < GAP_LIMIT; ++r)
+        probabilities[r] = 0.25 * pow(0.75,double(r));
+
+    probabilities[GAP_LIMIT] = pow(0.75,double(GAP_LIMIT));
+
+    return run_test("gap",count_gap,probabilities);
+}
+
+//--------------------------------------------------------------------------
+//  Birthday spacings test
+prng_test_result prng_battery::birthday_spacings() const
+{
+    // duplicate spacings are Poisson with lambda = m^3 / 4n = 2
+    static const double LAMBDA = 2.0;
+
+    vector<double> probabilities(BIRTHDAY_CATS);
+    double term = exp(-LAMBDA);
+    double tail = 1.0;
+
+    for (size_t k = 0; k < BIRTHDAY_CATS - 1; ++k)
+    {
+        probabilities[k] = term;
+        tail -= term;
+        term *= LAMBDA / double(k + 1);
+    }
+
+    probabilities[BIRTHDAY_CATS - 1] = tail;
+
+    return run_test("birthday spacings",count_birthday_spacings,probabilities);
+}
+
+//--------------------------------------------------------------------------
+//  Binary matrix rank test
+prng_test_result prng_battery::matrix_rank() const
+{
+    vector<double> probabilities(3);
+    probabilities[0] = matrix_rank_probability(32,32,32);
+    probabilities[1] = matrix_rank_probability(31,32,32);
+    probabilities[2] = 1.0 - probabilities[0] - probabilities[1];
+
+    return run_test("matrix rank",count_matrix_rank,probabilities);
+}
+
+//--------------------------------------------------------------------------
+//  Linear complexity test
+prng_test_result prng_battery::linear_complexity() const
+{
+    static const double PI[LC_CATS] =
+    {
+        1.0 / 96.0, 1.0 / 32.0, 1.0 / 8.0, 1.0 / 2.0, 1.0 / 4.0, 1.0 / 16.0, 1.0 / 48.0
+    };
+
+    return run_test("linear complexity",count_linear_complexity,vector<double>(PI,PI + LC_CATS));
+}
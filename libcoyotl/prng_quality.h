@@ -0,0 +1,209 @@
+//---------------------------------------------------------------------
+//  Algorithmic Conjurings @ http://www.coyotegulch.com
+//
+//  prng_quality.h (libcoyotl)
+//
+//  A compact, multithreaded battery of statistical tests for
+//  pseudorandom number generators.
+//---------------------------------------------------------------------
+//
+//  Copyright 1990-2005 Scott Robert Ladd
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the
+//      Free Software Foundation, Inc.
+//      59 Temple Place - Suite 330
+//      Boston, MA 02111-1307, USA.
+//
+//-----------------------------------------------------------------------
+//
+//  For more information on this software package, please visit
+//  Scott's web site, Coyote Gulch Productions, at:
+//
+//      http://www.coyotegulch.com
+//
+//-----------------------------------------------------------------------
+
+#if !defined(LIBCOYOTL_PRNG_QUALITY_H)
+#define LIBCOYOTL_PRNG_QUALITY_H
+
+#include <string>
+#include <vector>
+
+#include "prng.h"
+
+namespace libcoyotl
+{
+    //! Creates a new generator of a given type with a specific seed
+    /*!
+        A convenience for building a <i>prng_battery::factory</i>; every
+        libcoyotl generator has a constructor taking a 32-bit seed.
+        \param a_seed - Seed value used to "start" or seed the generator
+        \return A new generator, allocated with <i>new</i>
+    */
+    template <class Generator>
+    prng * create_prng(uint32_t a_seed)
+    {
+        return new Generator(a_seed);
+    }
+
+    //! Outcome of a single statistical test
+    /*!
+        Every test in the battery reduces to a chi-square comparison of
+        observed category counts against their expected probabilities.
+    */
+    struct prng_test_result
+    {
+        //! Name of the test
+        std::string m_name;
+
+        //! Number of 32-bit values consumed by the test
+        size_t m_samples;
+
+        //! Chi-square statistic
+        double m_chi_square;
+
+        //! Degrees of freedom of the chi-square statistic
+        size_t m_degrees;
+
+        //! Probability of a chi-square value at least this large
+        double m_p_value;
+
+        //! Pass/fail check
+        /*!
+            A test fails when its p-value falls in either tail of the
+            distribution, i.e., outside [alpha, 1 - alpha].
+            \param a_alpha - Size of each rejection tail
+            \return <i>true</i> if the p-value lies within the acceptance region
+        */
+        bool passed(double a_alpha = 0.001) const
+        {
+            return (m_p_value >= a_alpha) && (m_p_value <= 1.0 - a_alpha);
+        }
+    };
+
+    //! A battery of statistical tests for any <i>prng</i>
+    /*!
+        Runs the frequency, serial, gap, birthday spacings, binary matrix
+        rank and linear complexity tests on a generator type. Each test is
+        divided into one chunk per thread; every chunk draws from its own
+        generator (seeded from the battery seed and the chunk number), so
+        the work spreads across all available cores. Chunk category counts
+        are summed before the chi-square statistic is computed.
+    */
+    class prng_battery
+    {
+    public:
+        //! Function that creates a new, seeded generator
+        typedef prng * (*factory)(uint32_t a_seed);
+
+        //! Constructor
+        /*!
+            Creates a battery for the generators built by <i>a_factory</i>.
+            \param a_factory - Creates a new generator from a seed
+            \param a_sample_size - Number of 32-bit values consumed by each test
+            \param a_seed - Base seed for the per-thread generators
+            \param a_threads - Number of worker threads; zero uses all cores
+        */
+        prng_battery(factory a_factory,
+                     size_t a_sample_size,
+                     uint32_t a_seed = 19650218UL,
+                     size_t a_threads = 0);
+
+        //! Runs every test in the battery
+        /*!
+            Runs all tests, in order, and returns their results.
+            \return One result per test
+        */
+        std::vector<prng_test_result> run() const;
+
+        //! Frequency test
+        /*!
+            Chi-square test on the distribution of the high byte of each value.
+            \return Test result
+        */
+        prng_test_result frequency() const;
+
+        //! Serial test
+        /*!
+            Chi-square test on non-overlapping pairs of successive 4-bit values.
+            \return Test result
+        */
+        prng_test_result serial() const;
+
+        //! Gap test
+        /*!
+            Knuth's gap test, measuring the run lengths between values falling
+            in [0,1/4).
+            \return Test result
+        */
+        prng_test_result gap() const;
+
+        //! Birthday spacings test
+        /*!
+            Marsaglia's birthday spacings test, with 512 birthdays in a year
+            of 2<sup>24</sup> days.
+            \return Test result
+        */
+        prng_test_result birthday_spacings() const;
+
+        //! Binary matrix rank test
+        /*!
+            Ranks of random 32x32 matrices over GF(2).
+            \return Test result
+        */
+        prng_test_result matrix_rank() const;
+
+        //! Linear complexity test
+        /*!
+            NIST linear complexity test, applying Berlekamp-Massey to blocks
+            of 512 bits.
+            \return Test result
+        */
+        prng_test_result linear_complexity() const;
+
+        //! Number of worker threads
+        /*!
+            Returns the number of threads used to run each test.
+            \return Number of worker threads
+        */
+        size_t get_threads() const
+        {
+            return m_threads;
+        }
+
+    private:
+        // counts categories for one chunk of a test
+        typedef void (*chunk_counter)(prng & a_generator, size_t a_samples, std::vector<double> & a_counts);
+
+        // runs a test's chunks in parallel and computes chi-square
+        prng_test_result run_test(const char * a_name,
+                                  chunk_counter a_counter,
+                                  const std::vector<double> & a_probabilities) const;
+
+        // generator factory
+        factory m_factory;
+
+        // values consumed per test
+        size_t m_sample_size;
+
+        // base seed
+        uint32_t m_seed;
+
+        // worker threads
+        size_t m_threads;
+    };
+
+} // end namespace libcoyotl
+
+#endif
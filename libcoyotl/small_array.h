@@ -0,0 +1,575 @@
+//---------------------------------------------------------------------
+//  Algorithmic Conjurings @ http://www.coyotegulch.com
+//
+//  small_array.h (libcoyotl)
+//
+//  An array that keeps up to N elements inline and spills to the
+//  heap above that, sharing the interface of the array template.
+//---------------------------------------------------------------------
+//
+//  Copyright 1990-2005 Scott Robert Ladd
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the
+//      Free Software Foundation, Inc.
+//      59 Temple Place - Suite 330
+//      Boston, MA 02111-1307, USA.
+//
+//-----------------------------------------------------------------------
+//
+//  For more information on this software package, please visit
+//  Scott's web site, Coyote Gulch Productions, at:
+//
+//      http://www.coyotegulch.com
+//
+//-----------------------------------------------------------------------
+
+#if !defined(LIBCOYOTL_SMALL_ARRAY_H)
+#define LIBCOYOTL_SMALL_ARRAY_H
+
+#include <cstddef>
+#include <type_traits>
+
+#include "validator.h"     // validation functions
+#include "allocators.h"    // storage policies
+#include "array_kernels.h" // copy, fill and compare
+#include "array_view.h"    // non-owning views
+#include "array_expr.h"    // element-wise arithmetic
+
+#if defined(LIBCOYOTL_BOUNDS_CHECKING)
+#define LIBCOYOTL_SMALL_ARRAY_EXCEPTIONS validation_error<size_t>
+#define LIBCOYOTL_SMALL_ARRAY_CHECK_INDEX(n) validate_less(n,m_size,LIBCOYOTL_LOCATION);
+#else
+#define LIBCOYOTL_SMALL_ARRAY_EXCEPTIONS
+#define LIBCOYOTL_SMALL_ARRAY_CHECK_INDEX(n)
+#endif
+
+namespace libcoyotl
+{
+    //! An array with a small-buffer optimization
+    /*!
+        Stores up to <i>N</i> elements in a buffer inside the object, and
+        only draws storage from its <i>Allocator</i> when it grows beyond
+        that; small instances therefore cost no heap allocation. It shares
+        the interface and semantics of <i>array</i>, including appending
+        with geometric growth, except that a small_array may be empty and
+        cannot adopt or release a buffer.
+
+        The inline buffer always holds <i>N</i> default-initialized elements,
+        so <i>N</i> should stay small for expensive element types.
+    */
+    template <typename Type, size_t N, typename Allocator = new_allocator>
+    class small_array
+    {
+    public:
+        //! Type of an array element
+        typedef Type         value_type;
+
+        //! type of a pointer to an element
+        typedef Type *       pointer;
+
+        //! Type of a constant pointer to an element
+        typedef const Type * const_pointer;
+
+        //! Type of a reference to an element
+        typedef Type &       reference;
+
+        //! Type of a constant reference to an element
+        typedef const Type & const_reference;
+
+        //! Difference type between two element pointers
+        typedef ptrdiff_t    difference_type;
+
+        //! Size type for indexing array elements
+        typedef size_t       size_type;
+
+        //! Iterator type
+        typedef Type *       iterator;
+
+        //! Constant iterator type
+        typedef const Type * const_iterator;
+
+        //! Storage policy
+        typedef Allocator    allocator_type;
+
+        //! Default constructor
+        /*!
+            Constructs an array with <i>a_length</i> uninitialized elements.
+            /param a_length number of elements in the array
+            /param a_allocator source of storage beyond the inline buffer
+        */
+        explicit small_array(size_t a_length = 0, const Allocator & a_allocator = Allocator());
+
+        //! Initialization constructor
+        /*!
+            Constructs an array with specific number of elements initialized to
+            given value.
+            /param a_length number of elements in the array
+            /param a_init_value initial value of all array elements
+            /param a_allocator source of storage beyond the inline buffer
+        */
+        small_array(size_t a_length, const Type & a_init_value, const Allocator & a_allocator = Allocator());
+
+        //! Create from C-style array
+        /*!
+            Constructs a new array by copying the elements of the specified
+            C-style array.
+            /param a_length number of elements in the array
+            /param a_carray pointer to an array of with a_length elements
+            /param a_allocator source of storage beyond the inline buffer
+        */
+        small_array(size_t a_length, const Type * a_carray, const Allocator & a_allocator = Allocator());
+
+        //! Copy constructor
+        /*!
+            Creates a new array identical to an existing one.
+            \param a_source - The a_source object
+        */
+        small_array(const small_array & a_source);
+
+        //! Move constructor
+        /*!
+            Takes ownership of the source's heap storage, if it has any, and
+            otherwise moves its inline elements. The source is left with no
+            elements.
+            \param a_source - The source object
+        */
+        small_array(small_array && a_source);
+
+        //! Destructor
+        ~small_array() throw();
+
+        //! Assignment operator
+        /*!
+            Copies as many elements as both arrays hold, as <i>array</i> does.
+            \param a_source - The source object
+        */
+        small_array & operator = (const small_array & a_source) throw();
+
+        //! Move assignment operator
+        /*!
+            Releases the target's elements and takes over the source's; the
+            target takes on the length of the source, and the source is left
+            with no elements.
+            \param a_source - The source object
+        */
+        small_array & operator = (small_array && a_source);
+
+        //! Assign value to all elements
+        small_array & operator = (const Type & a_value) throw()
+        {
+            fill_elements(m_array,m_size,a_value);
+            return *this;
+        }
+
+        //! Assign from C-style array
+        small_array & operator = (const Type * a_carray) throw()
+        {
+            copy_elements(m_array,a_carray,m_size);
+            return *this;
+        }
+
+        //! Assign from an expression
+        /*!
+            Computes an element-wise expression (see array_expr.h) into the array.
+            \param a_expr - An expression over arrays of the target's length
+        */
+        template <class Expr>
+        small_array & operator = (const array_expression<Expr> & a_expr)
+        {
+            evaluate(m_array,m_size,a_expr);
+            return *this;
+        }
+
+        //! Get the allocator
+        const Allocator & get_allocator() const throw() { return m_allocator; }
+
+        //! Conversion to C-style array
+        const Type * c_array() const throw() { return m_array; }
+
+        //! Element access
+        Type & operator [] (size_t n) throw(LIBCOYOTL_SMALL_ARRAY_EXCEPTIONS)
+        {
+            LIBCOYOTL_SMALL_ARRAY_CHECK_INDEX(n)
+            return m_array[n];
+        }
+
+        //! Element access, constant array
+        const Type & operator [] (size_t n) const throw(LIBCOYOTL_SMALL_ARRAY_EXCEPTIONS)
+        {
+            LIBCOYOTL_SMALL_ARRAY_CHECK_INDEX(n)
+            return m_array[n];
+        }
+
+        //! View of all elements
+        array_view<Type> view() throw() { return array_view<Type>(m_array,m_size); }
+
+        //! Read-only view of all elements
+        array_view<const Type> view() const throw() { return array_view<const Type>(m_array,m_size); }
+
+        //! View of a subrange
+        array_view<Type> view(size_t a_offset, size_t a_length) { return view().subview(a_offset,a_length); }
+
+        //! Read-only view of a subrange
+        array_view<const Type> view(size_t a_offset, size_t a_length) const { return view().subview(a_offset,a_length); }
+
+        //! Appending arrays
+        /*!
+            Appends <i>a_array</i> to the target, spilling to the heap when the
+            inline buffer is exhausted and growing geometrically thereafter.
+            \param a_array - Array to be appended to the target
+        */
+        void append(const small_array & a_array);
+
+        //! Appending an element
+        /*!
+            Appends a single value to the target, extending its length by one.
+            \param a_value - Value to be appended to the target
+        */
+        void append(const Type & a_value);
+
+        //! Reserve storage
+        /*!
+            Ensures that the array can hold at least <i>a_capacity</i> elements
+            without reallocating.
+            \param a_capacity - Number of elements required
+        */
+        void reserve(size_t a_capacity);
+
+        //! Allocated capacity; at least <i>N</i>
+        size_t capacity() const throw() { return m_capacity; }
+
+        //! Inline storage check
+        /*!
+            Reports whether the elements still live in the inline buffer.
+            \return <i>true</i> if no heap storage is in use
+        */
+        bool is_inline() const throw() { return (m_array == m_inline); }
+
+        //! Obtain beginning-of-sequence iterator
+        iterator begin() throw() { return m_array; }
+
+        //! Obtain beginning-of-sequence iterator, constant array
+        const_iterator begin() const throw() { return m_array; }
+
+        //! Obtain end-of-sequence iterator
+        iterator end() throw() { return m_array + m_size; }
+
+        //! Obtain end-of-sequence iterator, constant array
+        const_iterator end() const throw() { return m_array + m_size; }
+
+        //! Equals operator; arrays of different lengths are unequal
+        bool operator == (const small_array & a_comparand) const throw()
+        {
+            return (m_size == a_comparand.m_size) && equal_elements(m_array,a_comparand.m_array,m_size);
+        }
+
+        //! Inequality operator
+        bool operator != (const small_array & a_comparand) const throw() { return !(*this == a_comparand); }
+
+        //! Less-than operator, comparing lexicographically
+        bool operator <  (const small_array & a_comparand) const throw()
+        {
+            return less_elements<Type>(m_array,m_size,a_comparand.m_array,a_comparand.m_size);
+        }
+
+        //! Greater-than operator
+        bool operator >  (const small_array & a_comparand) const throw() { return (a_comparand < *this); }
+
+        //! Less-than-or-equal-to operator
+        bool operator <= (const small_array & a_comparand) const throw() { return !(a_comparand < *this); }
+
+        //! Greater-than-or-equal-to operator
+        bool operator >= (const small_array & a_comparand) const throw() { return !(*this < a_comparand); }
+
+        //! Exchanges the contents of two arrays
+        /*!
+            Swaps heap buffers when both arrays have one, and otherwise moves
+            elements through a temporary.
+            \param a_source - The array with which to swap
+        */
+        void swap(small_array & a_source);
+
+        //! Number of elements
+        size_t size() const throw() { return m_size; }
+
+        //! Maximum container size, which is the same as <i>size()</i>
+        size_t max_size() const throw() { return m_size; }
+
+        //! Empty container check
+        bool empty() const throw() { return (m_size == 0); }
+
+    private:
+        // allocate storage for a_length elements
+        void initialize(size_t a_length);
+
+        // give up any heap storage and return to the inline buffer
+        void reset() throw();
+
+        // grow storage for trivial types, using the allocator's reallocate
+        void grow(size_t a_capacity, std::true_type);
+
+        // grow storage for other types, moving elements
+        void grow(size_t a_capacity, std::false_type);
+
+        // current elements; either m_inline or heap storage
+        Type * m_array;
+
+        // number of elements
+        size_t m_size;
+
+        // number of elements m_array can hold
+        size_t m_capacity;
+
+        // source of heap storage
+        Allocator m_allocator;
+
+        // inline buffer
+        Type m_inline[N];
+    };
+
+    // allocate storage for a_length elements
+    template <typename Type, size_t N, typename Allocator>
+    void small_array<Type,N,Allocator>::initialize(size_t a_length)
+    {
+        m_size = a_length;
+
+        if (a_length <= N)
+        {
+            m_array    = m_inline;
+            m_capacity = N;
+        }
+        else
+        {
+            m_array    = m_allocator.template allocate<Type>(a_length);
+            m_capacity = a_length;
+        }
+    }
+
+    // give up any heap storage and return to the inline buffer
+    template <typename Type, size_t N, typename Allocator>
+    void small_array<Type,N,Allocator>::reset() throw()
+    {
+        if (m_array != m_inline)
+            m_allocator.deallocate(m_array,m_capacity);
+
+        m_array    = m_inline;
+        m_size     = 0;
+        m_capacity = N;
+    }
+
+    // default constructor
+    template <typename Type, size_t N, typename Allocator>
+    small_array<Type,N,Allocator>::small_array(size_t a_length, const Allocator & a_allocator)
+      : m_allocator(a_allocator)
+    {
+        initialize(a_length);
+    }
+
+    // value constructor
+    template <typename Type, size_t N, typename Allocator>
+    small_array<Type,N,Allocator>::small_array(size_t a_length, const Type & a_init_value, const Allocator & a_allocator)
+      : m_allocator(a_allocator)
+    {
+        initialize(a_length);
+        fill_elements(m_array,m_size,a_init_value);
+    }
+
+    // construct from C-style array
+    template <typename Type, size_t N, typename Allocator>
+    small_array<Type,N,Allocator>::small_array(size_t a_length, const Type * a_carray, const Allocator & a_allocator)
+      : m_allocator(a_allocator)
+    {
+        // validate a_source
+        validate_not(a_carray,(const Type *)NULL,LIBCOYOTL_LOCATION);
+
+        initialize(a_length);
+        copy_elements(m_array,a_carray,m_size);
+    }
+
+    // copy constructor
+    template <typename Type, size_t N, typename Allocator>
+    small_array<Type,N,Allocator>::small_array(const small_array & a_source)
+      : m_allocator(a_source.m_allocator)
+    {
+        initialize(a_source.m_size);
+        copy_elements(m_array,a_source.m_array,m_size);
+    }
+
+    // move constructor
+    template <typename Type, size_t N, typename Allocator>
+    small_array<Type,N,Allocator>::small_array(small_array && a_source)
+      : m_array(m_inline),
+        m_size(0),
+        m_capacity(N),
+        m_allocator(a_source.m_allocator)
+    {
+        *this = static_cast<small_array &&>(a_source);
+    }
+
+    // destructor
+    template <typename Type, size_t N, typename Allocator>
+    small_array<Type,N,Allocator>::~small_array() throw()
+    {
+        if (m_array != m_inline)
+            m_allocator.deallocate(m_array,m_capacity);
+    }
+
+    // assignment operator
+    template <typename Type, size_t N, typename Allocator>
+    small_array<Type,N,Allocator> & small_array<Type,N,Allocator>::operator = (const small_array & a_source) throw()
+    {
+        if (this != &a_source)
+            copy_elements(m_array,a_source.m_array,(m_size < a_source.m_size) ? m_size : a_source.m_size);
+
+        return *this;
+    }
+
+    // move assignment operator
+    template <typename Type, size_t N, typename Allocator>
+    small_array<Type,N,Allocator> & small_array<Type,N,Allocator>::operator = (small_array && a_source)
+    {
+        if (this != &a_source)
+        {
+            reset();
+            m_allocator = a_source.m_allocator;
+
+            if (a_source.m_array == a_source.m_inline)
+            {
+                // inline elements must be moved one by one
+                for (size_t n = 0; n < a_source.m_size; ++n)
+                    m_inline[n] = static_cast<Type &&>(a_source.m_inline[n]);
+
+                m_size = a_source.m_size;
+                a_source.m_size = 0;
+            }
+            else
+            {
+                // heap storage changes hands
+                m_array    = a_source.m_array;
+                m_size     = a_source.m_size;
+                m_capacity = a_source.m_capacity;
+
+                a_source.m_array    = a_source.m_inline;
+                a_source.m_size     = 0;
+                a_source.m_capacity = N;
+            }
+        }
+
+        return *this;
+    }
+
+    // grow storage for trivial types
+    template <typename Type, size_t N, typename Allocator>
+    void small_array<Type,N,Allocator>::grow(size_t a_capacity, std::true_type)
+    {
+        if (m_array == m_inline)
+        {
+            m_array = m_allocator.template allocate<Type>(a_capacity);
+            copy_elements(m_array,m_inline,m_size);
+        }
+        else
+            m_array = m_allocator.reallocate(m_array,m_capacity,a_capacity);
+
+        m_capacity = a_capacity;
+    }
+
+    // grow storage for other types, moving elements
+    template <typename Type, size_t N, typename Allocator>
+    void small_array<Type,N,Allocator>::grow(size_t a_capacity, std::false_type)
+    {
+        Type * new_array = m_allocator.template allocate<Type>(a_capacity);
+
+        for (size_t n = 0; n < m_size; ++n)
+            new_array[n] = static_cast<Type &&>(m_array[n]);
+
+        if (m_array != m_inline)
+            m_allocator.deallocate(m_array,m_capacity);
+
+        m_array    = new_array;
+        m_capacity = a_capacity;
+    }
+
+    // reserve storage
+    template <typename Type, size_t N, typename Allocator>
+    void small_array<Type,N,Allocator>::reserve(size_t a_capacity)
+    {
+        if (a_capacity > m_capacity)
+            grow(a_capacity,typename std::is_trivial<Type>::type());
+    }
+
+    // appending
+    template <typename Type, size_t N, typename Allocator>
+    void small_array<Type,N,Allocator>::append(const small_array & a_array)
+    {
+        // capture the length first, in case a_array is this array
+        size_t count = a_array.m_size;
+        size_t new_size = m_size + count;
+
+        if (new_size > m_capacity)
+            reserve((new_size > 2 * m_capacity) ? new_size : 2 * m_capacity);
+
+        copy_elements(m_array + m_size,a_array.m_array,count);
+        m_size = new_size;
+    }
+
+    template <typename Type, size_t N, typename Allocator>
+    void small_array<Type,N,Allocator>::append(const Type & a_value)
+    {
+        if (m_size == m_capacity)
+        {
+            // a_value may refer to an element of this array
+            Type temp(a_value);
+            reserve((m_capacity > 0) ? 2 * m_capacity : 1);
+            m_array[m_size] = static_cast<Type &&>(temp);
+        }
+        else
+            m_array[m_size] = a_value;
+
+        ++m_size;
+    }
+
+    // swap
+    template <typename Type, size_t N, typename Allocator>
+    void small_array<Type,N,Allocator>::swap(small_array & a_source)
+    {
+        if ((m_array != m_inline) && (a_source.m_array != a_source.m_inline))
+        {
+            // exchange buffers; no elements are moved
+            Type * temp_array = m_array;
+            m_array = a_source.m_array;
+            a_source.m_array = temp_array;
+
+            size_t temp_size = m_size;
+            m_size = a_source.m_size;
+            a_source.m_size = temp_size;
+
+            size_t temp_capacity = m_capacity;
+            m_capacity = a_source.m_capacity;
+            a_source.m_capacity = temp_capacity;
+
+            Allocator temp_allocator = m_allocator;
+            m_allocator = a_source.m_allocator;
+            a_source.m_allocator = temp_allocator;
+        }
+        else if (this != &a_source)
+        {
+            small_array temp(static_cast<small_array &&>(a_source));
+            a_source = static_cast<small_array &&>(*this);
+            *this = static_cast<small_array &&>(temp);
+        }
+    }
+
+} // end namespace libcoyotl
+
+#endif
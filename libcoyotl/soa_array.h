@@ -0,0 +1,658 @@
+//---------------------------------------------------------------------
+//  Algorithmic Conjurings @ http://www.coyotegulch.com
+//
+//  soa_array.h (libcoyotl)
+//
+//  A structure-of-arrays container, keeping each field of a record
+//  in its own contiguous column.
+//---------------------------------------------------------------------
+//
+//  Copyright 1990-2005 Scott Robert Ladd
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the
+//      Free Software Foundation, Inc.
+//      59 Temple Place - Suite 330
+//      Boston, MA 02111-1307, USA.
+//
+//-----------------------------------------------------------------------
+//
+//  For more information on this software package, please visit
+//  Scott's web site, Coyote Gulch Productions, at:
+//
+//      http://www.coyotegulch.com
+//
+//-----------------------------------------------------------------------
+
+#if !defined(LIBCOYOTL_SOA_ARRAY_H)
+#define LIBCOYOTL_SOA_ARRAY_H
+
+#include <cstddef>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "validator.h"     // validation functions
+#include "realutil.h"      // min_of and max_of
+#include "allocators.h"    // storage policies
+#include "array_kernels.h" // copy, fill and compare
+#include "array_view.h"    // non-owning views
+#include "sortutil.h"      // sorting
+
+namespace libcoyotl
+{
+    //! A structure-of-arrays container
+    /*!
+        Holds a sequence of records with the fields <i>Fields...</i>, storing
+        each field in its own contiguous column allocated from an
+        <i>Allocator</i>. A loop over one field -- finding the best fitness
+        in a population, say -- then reads only that field's column, rather
+        than striding through whole records.
+
+        Columns are addressed by number, as in <i>std::tuple</i>: <i>column<1>()</i>
+        is a pointer to the second field of every record, and
+        <i>column_view<1>()</i> is the same column as an <i>array_view</i>.
+        Indexing yields a proxy <i>reference</i> to a whole record, which
+        converts to and from <i>std::tuple<Fields...></i>. <i>sort_by<K>()</i>
+        sorts the records by column <i>K</i>, moving only the keys while
+        sorting and then permuting every column once.
+
+        Usually named through the <i>soa_array</i> alias, which uses
+        cache-line aligned columns.
+    */
+    template <typename Allocator, typename... Fields>
+    class basic_soa_array
+    {
+        static_assert(sizeof...(Fields) > 0, "a soa_array needs at least one field");
+
+    public:
+        //! A complete record
+        typedef std::tuple<Fields...> value_type;
+
+        //! Size type for indexing records
+        typedef size_t                size_type;
+
+        //! Storage policy
+        typedef Allocator             allocator_type;
+
+        //! Type of a field
+        template <size_t Field>
+        struct field_type
+        {
+            //! The type of field number <i>Field</i>
+            typedef typename std::tuple_element<Field,value_type>::type type;
+        };
+
+        //! Proxy reference to a record
+        /*!
+            Refers to one record of a <i>basic_soa_array</i>. Assigning a
+            record (or another reference) to it stores every field; it
+            converts to a <i>value_type</i> holding copies of the fields.
+        */
+        class reference
+        {
+        public:
+            //! Access a field of the referenced record
+            template <size_t Field>
+            typename field_type<Field>::type & get() const throw()
+            {
+                return m_owner->template column<Field>()[m_index];
+            }
+
+            //! Index of the referenced record
+            size_t index() const throw() { return m_index; }
+
+            //! Copy the referenced record
+            operator value_type () const
+            {
+                return m_owner->get_row(m_index);
+            }
+
+            //! Store a record
+            reference & operator = (const value_type & a_value)
+            {
+                m_owner->set_row(m_index,a_value);
+                return *this;
+            }
+
+            //! Store the record referenced by another proxy
+            reference & operator = (const reference & a_source)
+            {
+                m_owner->set_row(m_index,a_source.m_owner->get_row(a_source.m_index));
+                return *this;
+            }
+
+        private:
+            friend class basic_soa_array;
+
+            reference(basic_soa_array * a_owner, size_t a_index) throw()
+              : m_owner(a_owner),
+                m_index(a_index)
+            {
+                // nada
+            }
+
+            basic_soa_array * m_owner;
+            size_t            m_index;
+        };
+
+        //! Proxy reference to a constant record
+        class const_reference
+        {
+        public:
+            //! Access a field of the referenced record
+            template <size_t Field>
+            const typename field_type<Field>::type & get() const throw()
+            {
+                return m_owner->template column<Field>()[m_index];
+            }
+
+            //! Index of the referenced record
+            size_t index() const throw() { return m_index; }
+
+            //! Copy the referenced record
+            operator value_type () const
+            {
+                return m_owner->get_row(m_index);
+            }
+
+        private:
+            friend class basic_soa_array;
+
+            const_reference(const basic_soa_array * a_owner, size_t a_index) throw()
+              : m_owner(a_owner),
+                m_index(a_index)
+            {
+                // nada
+            }
+
+            const basic_soa_array * m_owner;
+            size_t                  m_index;
+        };
+
+        //! Default constructor
+        /*!
+            Creates an empty container; no storage is allocated until records
+            are added.
+            \param a_allocator - Source of storage
+        */
+        explicit basic_soa_array(const Allocator & a_allocator = Allocator());
+
+        //! Constructor
+        /*!
+            Creates a container of <i>a_length</i> default-initialized records.
+            \param a_length - Number of records
+            \param a_allocator - Source of storage
+        */
+        explicit basic_soa_array(size_t a_length, const Allocator & a_allocator = Allocator());
+
+        //! Copy constructor
+        basic_soa_array(const basic_soa_array & a_source);
+
+        //! Move constructor
+        /*!
+            Takes ownership of the source's columns; the source is left empty.
+            \param a_source - The source object
+        */
+        basic_soa_array(basic_soa_array && a_source) throw();
+
+        //! Destructor
+        ~basic_soa_array() throw();
+
+        //! Assignment operator
+        basic_soa_array & operator = (const basic_soa_array & a_source);
+
+        //! Move assignment operator
+        basic_soa_array & operator = (basic_soa_array && a_source) throw();
+
+        //! Record access
+        reference operator [] (size_t n) throw()
+        {
+            return reference(this,n);
+        }
+
+        //! Record access, constant container
+        const_reference operator [] (size_t n) const throw()
+        {
+            return const_reference(this,n);
+        }
+
+        //! A column
+        /*!
+            Returns a pointer to the first element of a column; the column
+            holds <i>size()</i> elements. The pointer is invalidated when the
+            container reallocates.
+            \return Pointer to the column's elements
+        */
+        template <size_t Field>
+        typename field_type<Field>::type * column() throw()
+        {
+            return std::get<Field>(m_columns);
+        }
+
+        //! A column, constant container
+        template <size_t Field>
+        const typename field_type<Field>::type * column() const throw()
+        {
+            return std::get<Field>(m_columns);
+        }
+
+        //! A column, as a view
+        template <size_t Field>
+        array_view<typename field_type<Field>::type> column_view() throw()
+        {
+            return array_view<typename field_type<Field>::type>(column<Field>(),m_size);
+        }
+
+        //! A column, as a read-only view
+        template <size_t Field>
+        array_view<const typename field_type<Field>::type> column_view() const throw()
+        {
+            return array_view<const typename field_type<Field>::type>(column<Field>(),m_size);
+        }
+
+        //! Copy a record
+        value_type get_row(size_t n) const
+        {
+            return get_row(n,std::index_sequence_for<Fields...>());
+        }
+
+        //! Store a record
+        void set_row(size_t n, const value_type & a_value)
+        {
+            set_row(n,a_value,std::index_sequence_for<Fields...>());
+        }
+
+        //! Exchange two records
+        void swap_rows(size_t a_first, size_t a_second)
+        {
+            swap_rows(a_first,a_second,std::index_sequence_for<Fields...>());
+        }
+
+        //! Append a record
+        /*!
+            Adds a record to the end of the container, growing storage
+            geometrically when it is full.
+            \param a_values - One value per field
+        */
+        void append(const Fields & ... a_values);
+
+        //! Append a record
+        void append(const value_type & a_value);
+
+        //! Reserve storage
+        /*!
+            Ensures every column has room for at least <i>a_capacity</i> records.
+            \param a_capacity - Number of records to make room for
+        */
+        void reserve(size_t a_capacity);
+
+        //! Remove all records, keeping storage
+        void clear() throw() { m_size = 0; }
+
+        //! Reorder the records
+        /*!
+            Rearranges every column so that record <i>i</i> becomes the
+            record previously at <i>a_order[i]</i>.
+            \param a_order - A permutation of [0, size())
+        */
+        void permute(const size_t * a_order);
+
+        //! Sort records by one column
+        /*!
+            Sorts the records into ascending order of field <i>Key</i>;
+            records with equal keys keep their relative order. Only the keys
+            are moved while sorting, and each column is then permuted once.
+        */
+        template <size_t Key>
+        void sort_by();
+
+        //! Exchange the contents of two containers
+        void swap(basic_soa_array & a_source) throw();
+
+        //! Get the allocator
+        const Allocator & get_allocator() const throw() { return m_allocator; }
+
+        //! Number of records
+        size_t size() const throw() { return m_size; }
+
+        //! Number of records for which storage is allocated
+        size_t capacity() const throw() { return m_capacity; }
+
+        //! Empty container check
+        bool empty() const throw() { return m_size == 0; }
+
+    private:
+        // one pointer per column
+        typedef std::tuple<Fields * ...> column_pointers;
+
+        // allocate a set of columns
+        template <size_t... I>
+        column_pointers allocate_columns(size_t a_capacity, std::index_sequence<I...>);
+
+        // release a set of columns
+        template <size_t... I>
+        void release_columns(column_pointers & a_columns, size_t a_capacity, std::index_sequence<I...>) throw();
+
+        // copy or move the first records of one set of columns to another
+        template <size_t... I>
+        void copy_columns(column_pointers & a_target, const column_pointers & a_source, size_t a_length, std::index_sequence<I...>);
+
+        template <size_t... I>
+        void move_columns(column_pointers & a_target, column_pointers & a_source, size_t a_length, std::index_sequence<I...>);
+
+        // gather records into a new set of columns
+        template <size_t... I>
+        void gather_columns(column_pointers & a_target, column_pointers & a_source, const size_t * a_order, size_t a_length, std::index_sequence<I...>);
+
+        // per-record operations
+        template <size_t... I>
+        value_type get_row(size_t n, std::index_sequence<I...>) const;
+
+        template <size_t... I>
+        void set_row(size_t n, const value_type & a_value, std::index_sequence<I...>);
+
+        template <size_t... I>
+        void swap_rows(size_t a_first, size_t a_second, std::index_sequence<I...>);
+
+        // columns
+        column_pointers m_columns;
+
+        // number of records
+        size_t m_size;
+
+        // number of records allocated
+        size_t m_capacity;
+
+        // source of storage
+        Allocator m_allocator;
+    };
+
+    //! A structure-of-arrays container with cache-line aligned columns
+    template <typename... Fields>
+    using soa_array = basic_soa_array<aligned_allocator<64>,Fields...>;
+
+    // gather one column, moving record a_order[n] to position n
+    template <typename Type>
+    void gather_column(Type * a_target, Type * a_source, const size_t * a_order, size_t a_length)
+    {
+        for (size_t n = 0; n < a_length; ++n)
+            a_target[n] = std::move(a_source[a_order[n]]);
+    }
+
+    // allocate a set of columns
+    template <typename Allocator, typename... Fields>
+    template <size_t... I>
+    typename basic_soa_array<Allocator,Fields...>::column_pointers
+    basic_soa_array<Allocator,Fields...>::allocate_columns(size_t a_capacity, std::index_sequence<I...>)
+    {
+        column_pointers result;
+
+        if (a_capacity > 0)
+        {
+            try
+            {
+                int expand[] = { 0, ((std::get<I>(result) = m_allocator.template allocate<Fields>(a_capacity)), 0)... };
+                (void)expand;
+            }
+            catch (...)
+            {
+                release_columns(result,a_capacity,std::index_sequence_for<Fields...>());
+                throw;
+            }
+        }
+
+        return result;
+    }
+
+    // release a set of columns
+    template <typename Allocator, typename... Fields>
+    template <size_t... I>
+    void basic_soa_array<Allocator,Fields...>::release_columns(column_pointers & a_columns, size_t a_capacity, std::index_sequence<I...>) throw()
+    {
+        int expand[] = { 0, (m_allocator.deallocate(std::get<I>(a_columns),a_capacity), std::get<I>(a_columns) = NULL, 0)... };
+        (void)expand;
+    }
+
+    // copy records
+    template <typename Allocator, typename... Fields>
+    template <size_t... I>
+    void basic_soa_array<Allocator,Fields...>::copy_columns(column_pointers & a_target, const column_pointers & a_source, size_t a_length, std::index_sequence<I...>)
+    {
+        int expand[] = { 0, (copy_elements(std::get<I>(a_target),std::get<I>(a_source),a_length), 0)... };
+        (void)expand;
+    }
+
+    // move records
+    template <typename Allocator, typename... Fields>
+    template <size_t... I>
+    void basic_soa_array<Allocator,Fields...>::move_columns(column_pointers & a_target, column_pointers & a_source, size_t a_length, std::index_sequence<I...>)
+    {
+        for (size_t n = 0; n < a_length; ++n)
+        {
+            int expand[] = { 0, ((std::get<I>(a_target)[n] = std::move(std::get<I>(a_source)[n])), 0)... };
+            (void)expand;
+        }
+    }
+
+    // gather records
+    template <typename Allocator, typename... Fields>
+    template <size_t... I>
+    void basic_soa_array<Allocator,Fields...>::gather_columns(column_pointers & a_target, column_pointers & a_source, const size_t * a_order, size_t a_length, std::index_sequence<I...>)
+    {
+        // one column at a time, so each pass streams through a single column
+        int expand[] = { 0, (gather_column(std::get<I>(a_target),std::get<I>(a_source),a_order,a_length), 0)... };
+        (void)expand;
+    }
+
+    // copy a record
+    template <typename Allocator, typename... Fields>
+    template <size_t... I>
+    typename basic_soa_array<Allocator,Fields...>::value_type
+    basic_soa_array<Allocator,Fields...>::get_row(size_t n, std::index_sequence<I...>) const
+    {
+        return value_type(std::get<I>(m_columns)[n]...);
+    }
+
+    // store a record
+    template <typename Allocator, typename... Fields>
+    template <size_t... I>
+    void basic_soa_array<Allocator,Fields...>::set_row(size_t n, const value_type & a_value, std::index_sequence<I...>)
+    {
+        int expand[] = { 0, ((std::get<I>(m_columns)[n] = std::get<I>(a_value)), 0)... };
+        (void)expand;
+    }
+
+    // exchange records
+    template <typename Allocator, typename... Fields>
+    template <size_t... I>
+    void basic_soa_array<Allocator,Fields...>::swap_rows(size_t a_first, size_t a_second, std::index_sequence<I...>)
+    {
+        using std::swap;
+        int expand[] = { 0, (swap(std::get<I>(m_columns)[a_first],std::get<I>(m_columns)[a_second]), 0)... };
+        (void)expand;
+    }
+
+    // default constructor
+    template <typename Allocator, typename... Fields>
+    basic_soa_array<Allocator,Fields...>::basic_soa_array(const Allocator & a_allocator)
+      : m_columns(),
+        m_size(0),
+        m_capacity(0),
+        m_allocator(a_allocator)
+    {
+        // nada
+    }
+
+    // constructor
+    template <typename Allocator, typename... Fields>
+    basic_soa_array<Allocator,Fields...>::basic_soa_array(size_t a_length, const Allocator & a_allocator)
+      : m_columns(),
+        m_size(a_length),
+        m_capacity(a_length),
+        m_allocator(a_allocator)
+    {
+        m_columns = allocate_columns(m_capacity,std::index_sequence_for<Fields...>());
+    }
+
+    // copy constructor
+    template <typename Allocator, typename... Fields>
+    basic_soa_array<Allocator,Fields...>::basic_soa_array(const basic_soa_array & a_source)
+      : m_columns(),
+        m_size(a_source.m_size),
+        m_capacity(a_source.m_size),
+        m_allocator(a_source.m_allocator)
+    {
+        m_columns = allocate_columns(m_capacity,std::index_sequence_for<Fields...>());
+        copy_columns(m_columns,a_source.m_columns,m_size,std::index_sequence_for<Fields...>());
+    }
+
+    // move constructor
+    template <typename Allocator, typename... Fields>
+    basic_soa_array<Allocator,Fields...>::basic_soa_array(basic_soa_array && a_source) throw()
+      : m_columns(a_source.m_columns),
+        m_size(a_source.m_size),
+        m_capacity(a_source.m_capacity),
+        m_allocator(a_source.m_allocator)
+    {
+        a_source.m_columns  = column_pointers();
+        a_source.m_size     = 0;
+        a_source.m_capacity = 0;
+    }
+
+    // destructor
+    template <typename Allocator, typename... Fields>
+    basic_soa_array<Allocator,Fields...>::~basic_soa_array() throw()
+    {
+        release_columns(m_columns,m_capacity,std::index_sequence_for<Fields...>());
+    }
+
+    // assignment operator
+    template <typename Allocator, typename... Fields>
+    basic_soa_array<Allocator,Fields...> & basic_soa_array<Allocator,Fields...>::operator = (const basic_soa_array & a_source)
+    {
+        if (this != &a_source)
+        {
+            if (m_capacity >= a_source.m_size)
+            {
+                copy_columns(m_columns,a_source.m_columns,a_source.m_size,std::index_sequence_for<Fields...>());
+                m_size = a_source.m_size;
+            }
+            else
+            {
+                basic_soa_array temp(a_source);
+                swap(temp);
+            }
+        }
+
+        return *this;
+    }
+
+    // move assignment operator
+    template <typename Allocator, typename... Fields>
+    basic_soa_array<Allocator,Fields...> & basic_soa_array<Allocator,Fields...>::operator = (basic_soa_array && a_source) throw()
+    {
+        if (this != &a_source)
+        {
+            basic_soa_array temp(std::move(a_source));
+            swap(temp);
+        }
+
+        return *this;
+    }
+
+    // append a record
+    template <typename Allocator, typename... Fields>
+    void basic_soa_array<Allocator,Fields...>::append(const Fields & ... a_values)
+    {
+        if (m_size == m_capacity)
+        {
+            // the values may refer to elements of this container
+            value_type temp(a_values...);
+            reserve(max_of(m_size + 1,2 * m_capacity));
+            set_row(m_size,temp);
+        }
+        else
+            set_row(m_size,value_type(a_values...));
+
+        ++m_size;
+    }
+
+    template <typename Allocator, typename... Fields>
+    void basic_soa_array<Allocator,Fields...>::append(const value_type & a_value)
+    {
+        if (m_size == m_capacity)
+        {
+            value_type temp(a_value);
+            reserve(max_of(m_size + 1,2 * m_capacity));
+            set_row(m_size,temp);
+        }
+        else
+            set_row(m_size,a_value);
+
+        ++m_size;
+    }
+
+    // reserve storage
+    template <typename Allocator, typename... Fields>
+    void basic_soa_array<Allocator,Fields...>::reserve(size_t a_capacity)
+    {
+        if (a_capacity > m_capacity)
+        {
+            column_pointers fresh = allocate_columns(a_capacity,std::index_sequence_for<Fields...>());
+            move_columns(fresh,m_columns,m_size,std::index_sequence_for<Fields...>());
+            release_columns(m_columns,m_capacity,std::index_sequence_for<Fields...>());
+            m_columns  = fresh;
+            m_capacity = a_capacity;
+        }
+    }
+
+    // reorder records
+    template <typename Allocator, typename... Fields>
+    void basic_soa_array<Allocator,Fields...>::permute(const size_t * a_order)
+    {
+        if (m_size == 0)
+            return;
+
+        column_pointers fresh = allocate_columns(m_capacity,std::index_sequence_for<Fields...>());
+        gather_columns(fresh,m_columns,a_order,m_size,std::index_sequence_for<Fields...>());
+        release_columns(m_columns,m_capacity,std::index_sequence_for<Fields...>());
+        m_columns = fresh;
+    }
+
+    // sort by a column
+    template <typename Allocator, typename... Fields>
+    template <size_t Key>
+    void basic_soa_array<Allocator,Fields...>::sort_by()
+    {
+        if (m_size < 2)
+            return;
+
+        std::vector<size_t> order(m_size);
+        sort_order<typename field_type<Key>::type>(column<Key>(),m_size,&order[0]);
+        permute(&order[0]);
+    }
+
+    // exchange contents
+    template <typename Allocator, typename... Fields>
+    void basic_soa_array<Allocator,Fields...>::swap(basic_soa_array & a_source) throw()
+    {
+        std::swap(m_columns,a_source.m_columns);
+        std::swap(m_size,a_source.m_size);
+        std::swap(m_capacity,a_source.m_capacity);
+        std::swap(m_allocator,a_source.m_allocator);
+    }
+
+} // end namespace libcoyotl
+
+#endif
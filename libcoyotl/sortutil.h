@@ -36,7 +36,20 @@
 #if !defined(LIBCOYOTL_SORTUTIL_H)
 #define LIBCOYOTL_SORTUTIL_H
 
-#include <stdexcept>
+#include <atomic>
+#include <cstring>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <stdint.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "realutil.h"
+#include "array_view.h"
 
 namespace libcoyotl
 {
@@ -67,27 +80,240 @@ namespace libcoyotl
     }
     
     //--------------------------------------------------
-    // shell sort an array in ascending order
+    // branchless compare-exchange: afterwards a is no
+    // greater than b. Elements that compare equal (or
+    // are unordered, like NaNs) are exchanged, so the
+    // pair always keeps both values. Integers compile
+    // to conditional moves, and floating-point values
+    // use the SSE2 min and max instructions, whose
+    // operand order gives exactly these semantics.
+
+    template <class T>
+    inline void compare_exchange(T & a, T & b)
+    {
+        T x(a);
+        T y(b);
+        a = (x < y) ? x : y;
+        b = (x < y) ? y : x;
+    }
+
+#if defined(__SSE2__)
+    inline void compare_exchange(double & a, double & b)
+    {
+        __m128d x = _mm_set_sd(a);
+        __m128d y = _mm_set_sd(b);
+        a = _mm_cvtsd_f64(_mm_min_sd(x,y));
+        b = _mm_cvtsd_f64(_mm_max_sd(y,x));
+    }
+
+    inline void compare_exchange(float & a, float & b)
+    {
+        __m128 x = _mm_set_ss(a);
+        __m128 y = _mm_set_ss(b);
+        a = _mm_cvtss_f32(_mm_min_ss(x,y));
+        b = _mm_cvtss_f32(_mm_max_ss(y,x));
+    }
+#endif
+
+    //--------------------------------------------------
+    // Comparators of the sorting network for a_size <= N
+    // elements, built at compile time by Batcher's merge
+    // exchange (Knuth, TAOCP 5.2.2, Algorithm M); 191
+    // comparators for 32 elements
+
+    const size_t SORT_NETWORK_MAX = 32;
+
+    // comparators in the network for 2^t >= N elements,
+    // (t^2 - t + 4) 2^(t-2) - 1, a bound for N elements
+    constexpr size_t network_capacity(size_t N, size_t t = 0)
+    {
+        return ((size_t(1) << t) < N) ? network_capacity(N,t + 1) : (((t * t - t + 4) << t) / 4);
+    }
+
+    template <size_t N>
+    struct network_layout
+    {
+        size_t        m_count;
+        unsigned char m_first[network_capacity(N)];
+        unsigned char m_second[network_capacity(N)];
+    };
+
+    template <size_t N>
+    constexpr network_layout<N> make_network(size_t a_size = N)
+    {
+        network_layout<N> net = { 0, { 0 }, { 0 } };
+
+        if (a_size < 2)
+            return net;
+
+        size_t t = 0;
+
+        while ((size_t(1) << t) < a_size)
+            ++t;
+
+        for (size_t p = size_t(1) << (t - 1); p > 0; p /= 2)
+        {
+            size_t q = size_t(1) << (t - 1);
+            size_t r = 0;
+            size_t d = p;
+
+            while (true)
+            {
+                for (size_t i = 0; i + d < a_size; ++i)
+                {
+                    if ((i & p) == r)
+                    {
+                        net.m_first[net.m_count]  = (unsigned char)i;
+                        net.m_second[net.m_count] = (unsigned char)(i + d);
+                        ++net.m_count;
+                    }
+                }
+
+                if (q == p)
+                    break;
+
+                d = q - p;
+                q /= 2;
+                r = p;
+            }
+        }
+
+        return net;
+    }
+
+    template <size_t N>
+    struct sorting_network
+    {
+        static_assert(N <= SORT_NETWORK_MAX, "sorting networks are generated for at most 32 elements");
+
+        static constexpr network_layout<N> LAYOUT = make_network<N>();
+
+        // one compare-exchange per comparator, unrolled
+        template <class T, class Sequence, size_t... I>
+        static void apply(Sequence a, size_t a_first, std::index_sequence<I...>)
+        {
+            int expand[] = { 0, (compare_exchange(a[a_first + LAYOUT.m_first[I]],a[a_first + LAYOUT.m_second[I]]), 0)... };
+            (void)expand;
+        }
+
+        // networks for fewer than two elements are empty
+        template <class T, class Sequence>
+        static void apply(Sequence, size_t, std::index_sequence<>)
+        {
+            // nada
+        }
+
+        template <class T, class Sequence>
+        static void sort(Sequence a, size_t a_first)
+        {
+            apply<T>(a,a_first,std::make_index_sequence<LAYOUT.m_count>());
+        }
+    };
+
+    template <size_t N>
+    constexpr network_layout<N> sorting_network<N>::LAYOUT;
+
+    //--------------------------------------------------
+    // Sort exactly N elements of a sequence, starting at
+    // a_first, with a branchless sorting network. Meant
+    // for arithmetic types; any type with operator < and
+    // copy assignment works.
+    template <size_t N, class T, class Sequence>
+    inline void network_sort_sequence(Sequence a, size_t a_first = 0)
+    {
+        sorting_network<N>::template sort<T>(a,a_first);
+    }
+
+    //--------------------------------------------------
+    // Sort exactly N elements of an array with a sorting
+    // network
+    template <size_t N, class T>
+    inline void network_sort(T * array)
+    {
+        network_sort_sequence<N,T>(array);
+    }
+
+    //--------------------------------------------------
+    // The networks for every size up to N, as data, for
+    // sizes known only at run time; one table serves all
+    // element types, where unrolling every size for each
+    // type would cost far more code and compile time
+
+    template <size_t N>
+    struct network_table
+    {
+        network_layout<N> m_networks[N + 1];
+    };
+
+    template <size_t N>
+    constexpr network_table<N> make_network_table()
+    {
+        network_table<N> table = { };
+
+        for (size_t n = 0; n <= N; ++n)
+            table.m_networks[n] = make_network<N>(n);
+
+        return table;
+    }
+
+    template <size_t N>
+    struct sorting_network_table
+    {
+        static constexpr network_table<N> TABLE = make_network_table<N>();
+    };
+
+    template <size_t N>
+    constexpr network_table<N> sorting_network_table<N>::TABLE;
+
+    //--------------------------------------------------
+    // Sort n elements of a sequence, starting at a_first,
+    // with the sorting network for n, looping over its
+    // comparators; returns false, and does nothing, when
+    // n exceeds SORT_NETWORK_MAX
+    template <class T, class Sequence>
+    inline bool network_sort_sequence(Sequence a, size_t a_first, size_t n)
+    {
+        if (n > SORT_NETWORK_MAX)
+            return false;
+
+        const network_layout<SORT_NETWORK_MAX> & net = sorting_network_table<SORT_NETWORK_MAX>::TABLE.m_networks[n];
+
+        for (size_t i = 0; i < net.m_count; ++i)
+            compare_exchange(a[a_first + net.m_first[i]],a[a_first + net.m_second[i]]);
+
+        return true;
+    }
+
+    //--------------------------------------------------
+    // Sort up to SORT_NETWORK_MAX elements of an array
+    // with a sorting network; returns false, and does
+    // nothing, for longer arrays
+    template <class T>
+    inline bool network_sort(T * array, size_t n)
+    {
+        return network_sort_sequence<T>(array,0,n);
+    }
+
+    //--------------------------------------------------
+    // shell sort a sequence in ascending order; Sequence
+    // is a pointer or anything else indexed like one
     
-    template<class  T> void
-    shell_sort(T * a, size_t n)
+    template<class  T, class Sequence> void
+    shell_sort_sequence(Sequence a, size_t n)
     {
         size_t inc, i, j;
         T t;
         
-        // algorithm relies on one-based arrays
-        --a;
-        
         for (inc = 1; inc <= n / 9; inc = 3 * inc + 1) ;
         
         for ( ; inc > 0; inc /= 3)
         {
-            for (i = inc + 1; i <= n; i += inc)
+            for (i = inc; i < n; ++i)
             {
                 t = a[i];
                 j = i;
                 
-                while ((j > inc) && (a[j - inc] > t))
+                while ((j >= inc) && (a[j - inc] > t))
                 {
                     a[j] = a[j - inc];
                     j -= inc;
@@ -99,27 +325,24 @@ namespace libcoyotl
     }
     
     //--------------------------------------------------
-    // shell sort an array in ascending order
+    // shell sort a sequence in descending order
     
-    template<class  T>
-    void shell_sort_descending(T * array, size_t n)
+    template<class  T, class Sequence>
+    void shell_sort_descending_sequence(Sequence array, size_t n)
     {
         size_t increment, i, j;
         T t;
         
-        // algorithm relies on one-based arrays
-        --array;
-        
         for (increment = 1; increment <= n / 9; increment = 3 * increment + 1) ;
         
         for ( ; increment > 0; increment /= 3)
         {
-            for (i = increment + 1; i <= n; i += increment)
+            for (i = increment; i < n; ++i)
             {
                 t = array[i];
                 j = i;
                 
-                while ((j > increment) && (array[j - increment] < t))
+                while ((j >= increment) && (array[j - increment] < t))
                 {
                     array[j] = array[j - increment];
                     j -= increment;
@@ -129,162 +352,2695 @@ namespace libcoyotl
             }
         }
     }
-#define CHAR_BIT     8
-#define STACK_SIZE  (CHAR_BIT * sizeof(int))
-#define THRESHOLD   7
+    
     //--------------------------------------------------
-    // Quick Sort an array in ascending order
-    template <class T>
-    void quick_sort(T * array, size_t n)
+    // shell sort an array in ascending order
+    
+    template<class  T> void
+    shell_sort(T * a, size_t n)
+    {
+        shell_sort_sequence<T>(a,n);
+    }
+    
+    //--------------------------------------------------
+    // shell sort the elements of a view in ascending order
+    
+    template<class  T> void
+    shell_sort(array_view<T> a_view)
+    {
+        if (a_view.is_contiguous())
+            shell_sort_sequence<T>(a_view.data(),a_view.size());
+        else
+            shell_sort_sequence<T>(a_view,a_view.size());
+    }
+    
+    //--------------------------------------------------
+    // shell sort an array in descending order
+    
+    template<class  T>
+    void shell_sort_descending(T * array, size_t n)
+    {
+        shell_sort_descending_sequence<T>(array,n);
+    }
+    
+    //--------------------------------------------------
+    // shell sort the elements of a view in descending order
+    
+    template<class  T>
+    void shell_sort_descending(array_view<T> a_view)
     {
+        if (a_view.is_contiguous())
+            shell_sort_descending_sequence<T>(a_view.data(),a_view.size());
+        else
+            shell_sort_descending_sequence<T>(a_view,a_view.size());
+    }
 
+    //--------------------------------------------------
+    // Tuning for the pattern-defeating quicksort below:
+    // partitions smaller than PDQ_INSERTION_THRESHOLD are
+    // insertion sorted, partitions larger than
+    // PDQ_NINTHER_THRESHOLD take a pseudomedian of nine
+    // as pivot, and PDQ_PARTIAL_INSERTION_LIMIT bounds
+    // the elements moved while checking a partition that
+    // looks sorted
 
-        size_t left_index  = 0;
-        size_t right_index = n - 1;
+    const size_t PDQ_INSERTION_THRESHOLD     =  24;
+    const size_t PDQ_NINTHER_THRESHOLD       = 128;
+    const size_t PDQ_PARTIAL_INSERTION_LIMIT =   8;
 
-        T temp, pivot;
-        size_t scan_left, scan_right, middle, pivot_index, size_left, size_right;
-        size_t stack_left[STACK_SIZE], stack_right[STACK_SIZE], stack_ptr = 0;
-        
-        while (true)
+    //--------------------------------------------------
+    // exchange two elements of a sequence
+
+    template <class T, class Sequence>
+    inline void swap_elements(Sequence a, size_t i, size_t j)
+    {
+        T t(std::move(a[i]));
+        a[i] = std::move(a[j]);
+        a[j] = std::move(t);
+    }
+
+    //--------------------------------------------------
+    // order two or three elements of a sequence in place
+
+    template <class T, class Sequence>
+    inline void pdq_sort2(Sequence a, size_t i, size_t j)
+    {
+        if (a[j] < a[i])
+            swap_elements<T>(a,i,j);
+    }
+
+    template <class T, class Sequence>
+    inline void pdq_sort3(Sequence a, size_t i, size_t j, size_t k)
+    {
+        pdq_sort2<T>(a,i,j);
+        pdq_sort2<T>(a,j,k);
+        pdq_sort2<T>(a,i,j);
+    }
+
+    //--------------------------------------------------
+    // insertion sort [begin,end) of a sequence
+
+    template <class T, class Sequence>
+    void pdq_insertion_sort(Sequence a, size_t begin, size_t end)
+    {
+        for (size_t i = begin + 1; i < end; ++i)
         {
-            while (right_index > left_index)
+            if (a[i] < a[i - 1])
             {
-                if ((right_index - left_index) > THRESHOLD)
-                {
-                    // "median-of-three" partitioning
-                    middle = (left_index + right_index) / 2;
-                    
-                    // three-sort left, middle, and right elements
-                    if (array[left_index] > array[middle])
-                    {
-                        temp              = array[left_index];
-                        array[left_index] = array[middle];
-                        array[middle]     = temp;
-                    }
-                    
-                    if (array[left_index] > array[right_index])
-                    {
-                        temp               = array[left_index];
-                        array[left_index]  = array[right_index];
-                        array[right_index] = temp;
-                    }
-                    
-                    if (array[middle] > array[right_index])
-                    {
-                        temp               = array[middle];
-                        array[middle]      = array[right_index];
-                        array[right_index] = temp;
-                    }
-                    
-                    pivot_index = right_index - 1;
-                    
-                    temp               = array[middle];
-                    array[middle]      = array[pivot_index];
-                    array[pivot_index] = temp;
-                    
-                    // set-up for partitioning
-                    scan_left  = left_index  + 1;
-                    scan_right = right_index - 2;
-                }
-                else
-                {
-                    pivot_index = right_index;
-                    scan_left   = left_index;
-                    scan_right  = right_index - 1;
-                }
-                
-                pivot = array[pivot_index];
-                
-                while (true)
-                {
-                    // scan from left
-                    while ((array[scan_left] < pivot) && (scan_left < right_index))
-                        ++scan_left;
-                    
-                    // scan from right
-                    while ((array[scan_right] > pivot) && (scan_right > left_index))
-                        --scan_right;
-                    
-                    // if scans have met, exit inner loop
-                    if (scan_left >= scan_right)
-                        break;
-                    
-                    // exchange elements
-                    temp              = array[scan_right];
-                    array[scan_right] = array[scan_left];
-                    array[scan_left]  = temp;
-                    
-                    if (scan_left < right_index)
-                        ++scan_left;
-
-                    if (scan_right > left_index)
-                        --scan_right;
-                }
-                
-                // exchange final element
-                if (scan_left != pivot_index)
-                {
-                    temp               = array[pivot_index];
-                    array[pivot_index] = array[scan_left];
-                    array[scan_left]   = temp;
-                }
-                
-                // place largest partition on stack
-                size_left  = scan_left   - left_index;
-                size_right = right_index - scan_left;
-                
-                if (size_left > size_right)
+                T t(std::move(a[i]));
+                size_t j = i;
+
+                do
                 {
-                    if (size_left != 1)
-                    {
-                        ++stack_ptr;
-                        
-                        if (stack_ptr == STACK_SIZE)
-                            throw std::runtime_error("stack overflow in quick_sort");
-                        
-                        stack_left[stack_ptr]  = left_index;
-                        stack_right[stack_ptr] = scan_left - 1;
-                    }
-                    
-                    if (size_right != 0)
-                        left_index = scan_left + 1;
-                    else
-                        break;
+                    a[j] = std::move(a[j - 1]);
+                    --j;
                 }
-                else
+                while ((j > begin) && (t < a[j - 1]));
+
+                a[j] = std::move(t);
+            }
+        }
+    }
+
+    //--------------------------------------------------
+    // insertion sort [begin,end) when a[begin - 1] is no
+    // greater than any element of the range, which then
+    // serves as a sentinel
+
+    template <class T, class Sequence>
+    void pdq_unguarded_insertion_sort(Sequence a, size_t begin, size_t end)
+    {
+        for (size_t i = begin + 1; i < end; ++i)
+        {
+            if (a[i] < a[i - 1])
+            {
+                T t(std::move(a[i]));
+                size_t j = i;
+
+                do
                 {
-                    if (size_right != 1)
-                    {
-                        ++stack_ptr;
-                        
-                        if (stack_ptr == STACK_SIZE)
-                            throw std::runtime_error("stack overflow in quick_sort");
-                        
-                        stack_left[stack_ptr]  = scan_left + 1;
-                        stack_right[stack_ptr] = right_index;
-                    }
-                    
-                    if (size_left != 0)
-                        right_index = scan_left - 1;
-                    else
-                        break;
+                    a[j] = std::move(a[j - 1]);
+                    --j;
                 }
+                while (t < a[j - 1]);
+
+                a[j] = std::move(t);
             }
-            
-            // iterate with values from stack
-            if (stack_ptr > 0)
+        }
+    }
+
+    //--------------------------------------------------
+    // insertion sort [begin,end), giving up (and returning
+    // false) once more than PDQ_PARTIAL_INSERTION_LIMIT
+    // elements have been moved; used to finish partitions
+    // that are already sorted, or nearly so, in linear time
+
+    template <class T, class Sequence>
+    bool pdq_partial_insertion_sort(Sequence a, size_t begin, size_t end)
+    {
+        size_t moved = 0;
+
+        for (size_t i = begin + 1; i < end; ++i)
+        {
+            if (a[i] < a[i - 1])
             {
-                left_index  = stack_left[stack_ptr];
-                right_index = stack_right[stack_ptr];
-                
-                --stack_ptr;
+                T t(std::move(a[i]));
+                size_t j = i;
+
+                do
+                {
+                    a[j] = std::move(a[j - 1]);
+                    --j;
+                }
+                while ((j > begin) && (t < a[j - 1]));
+
+                a[j] = std::move(t);
+                moved += i - j;
+
+                if (moved > PDQ_PARTIAL_INSERTION_LIMIT)
+                    return false;
             }
-            else
+        }
+
+        return true;
+    }
+
+    //--------------------------------------------------
+    // heap sort [begin,end); the fallback that bounds the
+    // quicksort's worst case at O(n log n)
+
+    template <class T, class Sequence>
+    void pdq_sift_down(Sequence a, size_t begin, size_t root, size_t length)
+    {
+        T t(std::move(a[begin + root]));
+
+        while (true)
+        {
+            size_t child = 2 * root + 1;
+
+            if (child >= length)
+                break;
+
+            if ((child + 1 < length) && (a[begin + child] < a[begin + child + 1]))
+                ++child;
+
+            if (!(t < a[begin + child]))
                 break;
+
+            a[begin + root] = std::move(a[begin + child]);
+            root = child;
+        }
+
+        a[begin + root] = std::move(t);
+    }
+
+    template <class T, class Sequence>
+    void pdq_heap_sort(Sequence a, size_t begin, size_t end)
+    {
+        size_t length = end - begin;
+
+        for (size_t root = length / 2; root > 0; --root)
+            pdq_sift_down<T>(a,begin,root - 1,length);
+
+        while (length > 1)
+        {
+            --length;
+            swap_elements<T>(a,begin,begin + length);
+            pdq_sift_down<T>(a,begin,0,length);
+        }
+    }
+
+    //--------------------------------------------------
+    // partition [begin,end) around the pivot a[begin];
+    // elements equal to the pivot go to the right. The
+    // range must contain an element no less than the
+    // pivot after a[begin], which the median selection
+    // guarantees. Returns the pivot's final position and
+    // reports whether the range was already partitioned.
+
+    template <class T, class Sequence>
+    size_t pdq_partition_right(Sequence a, size_t begin, size_t end, bool & a_already_partitioned, std::false_type)
+    {
+        T pivot(std::move(a[begin]));
+        size_t first = begin;
+        size_t last  = end;
+
+        // find the first element no less than the pivot
+        while (a[++first] < pivot) ;
+
+        // find the last element less than the pivot; guarded
+        // only if no element was skipped above
+        if (first - 1 == begin)
+        {
+            while ((first < last) && !(a[--last] < pivot)) ;
+        }
+        else
+        {
+            while (!(a[--last] < pivot)) ;
+        }
+
+        a_already_partitioned = (first >= last);
+
+        // swap misplaced pairs; the elements found so far
+        // act as sentinels, so the scans are unguarded
+        while (first < last)
+        {
+            swap_elements<T>(a,first,last);
+            while (a[++first] < pivot) ;
+            while (!(a[--last] < pivot)) ;
         }
+
+        size_t pivot_pos = first - 1;
+        a[begin] = std::move(a[pivot_pos]);
+        a[pivot_pos] = std::move(pivot);
+        return pivot_pos;
     }
-            
+
+    //--------------------------------------------------
+    // Types whose comparisons compile to flag-setting
+    // instructions rather than branches, and so are
+    // partitioned with the block partition below. All
+    // arithmetic types qualify; specialize this for a
+    // type with a cheap, branch-free operator < to opt
+    // it in, or to std::false_type to opt out.
+
+    template <class T>
+    struct is_block_partitionable : public std::is_arithmetic<T>
+    {
+    };
+
+    //--------------------------------------------------
+    // Elements examined per block by the block partition;
+    // offsets within a block must fit in an unsigned char
+
+    const size_t PDQ_BLOCK_SIZE = 64;
+
+    //--------------------------------------------------
+    // move num misplaced pairs across a partition: the
+    // elements at a_left + offsets_l[i] belong on the right,
+    // and those at a_right - offsets_r[i] on the left. When
+    // the counts differ the pairs are rotated through one
+    // temporary, which needs fewer moves than swapping.
+
+    template <class T, class Sequence>
+    inline void pdq_swap_offsets(Sequence a, size_t a_left, size_t a_right,
+                                 const unsigned char * offsets_l, const unsigned char * offsets_r,
+                                 size_t num, bool use_swaps)
+    {
+        if (use_swaps)
+        {
+            for (size_t i = 0; i < num; ++i)
+                swap_elements<T>(a,a_left + offsets_l[i],a_right - offsets_r[i]);
+        }
+        else if (num > 0)
+        {
+            size_t l = a_left  + offsets_l[0];
+            size_t r = a_right - offsets_r[0];
+            T t(std::move(a[l]));
+            a[l] = std::move(a[r]);
+
+            for (size_t i = 1; i < num; ++i)
+            {
+                l = a_left + offsets_l[i];
+                a[r] = std::move(a[l]);
+                r = a_right - offsets_r[i];
+                a[l] = std::move(a[r]);
+            }
+
+            a[r] = std::move(t);
+        }
+    }
+
+    //--------------------------------------------------
+    // block partition of [begin,end) around the pivot
+    // a[begin], with the same contract as the scanning
+    // partition. After BlockQuicksort (Edelkamp and
+    // Weiss): each side is scanned a block at a time,
+    // recording the offsets of misplaced elements with
+    // arithmetic instead of branches, and the recorded
+    // elements are then exchanged in a batch. Only the
+    // loop bounds branch, so random keys cause no
+    // mispredictions.
+
+    template <class T, class Sequence>
+    size_t pdq_partition_right(Sequence a, size_t begin, size_t end, bool & a_already_partitioned, std::true_type)
+    {
+        T pivot(std::move(a[begin]));
+        size_t first = begin;
+        size_t last  = end;
+
+        // find the first pair of misplaced elements, as in
+        // the scanning partition
+        while (a[++first] < pivot) ;
+
+        if (first - 1 == begin)
+        {
+            while ((first < last) && !(a[--last] < pivot)) ;
+        }
+        else
+        {
+            while (!(a[--last] < pivot)) ;
+        }
+
+        a_already_partitioned = (first >= last);
+
+        if (!a_already_partitioned)
+        {
+            swap_elements<T>(a,first,last);
+            ++first;
+
+            // offsets of misplaced elements within the current blocks
+            alignas(64) unsigned char offsets_l[PDQ_BLOCK_SIZE];
+            alignas(64) unsigned char offsets_r[PDQ_BLOCK_SIZE];
+
+            size_t base_l  = first;
+            size_t base_r  = last;
+            size_t num_l   = 0;
+            size_t num_r   = 0;
+            size_t start_l = 0;
+            size_t start_r = 0;
+
+            while (first < last)
+            {
+                // refill whichever side has run out of offsets; near
+                // the end, split the remaining elements between them
+                size_t num_unknown = last - first;
+                size_t left_split  = (num_l == 0) ? ((num_r == 0) ? num_unknown / 2 : num_unknown) : 0;
+                size_t right_split = (num_r == 0) ? (num_unknown - left_split) : 0;
+
+                if (left_split >= PDQ_BLOCK_SIZE)
+                    left_split = PDQ_BLOCK_SIZE;
+
+                if (right_split >= PDQ_BLOCK_SIZE)
+                    right_split = PDQ_BLOCK_SIZE;
+
+                for (size_t i = 0; i < left_split; ++i)
+                {
+                    offsets_l[num_l] = (unsigned char)i;
+                    num_l += !(a[first] < pivot);
+                    ++first;
+                }
+
+                for (size_t i = 0; i < right_split; ++i)
+                {
+                    --last;
+                    offsets_r[num_r] = (unsigned char)(i + 1);
+                    num_r += (a[last] < pivot);
+                }
+
+                // exchange as many misplaced pairs as both sides have
+                size_t num = min_of(num_l,num_r);
+                pdq_swap_offsets<T>(a,base_l,base_r,offsets_l + start_l,offsets_r + start_r,num,num_l == num_r);
+
+                num_l   -= num;
+                num_r   -= num;
+                start_l += num;
+                start_r += num;
+
+                if (num_l == 0)
+                {
+                    start_l = 0;
+                    base_l  = first;
+                }
+
+                if (num_r == 0)
+                {
+                    start_r = 0;
+                    base_r  = last;
+                }
+            }
+
+            // at most one side has misplaced elements left; move
+            // them to the boundary
+            if (num_l > 0)
+            {
+                while (num_l > 0)
+                {
+                    --num_l;
+                    swap_elements<T>(a,base_l + offsets_l[start_l + num_l],--last);
+                }
+
+                first = last;
+            }
+
+            if (num_r > 0)
+            {
+                while (num_r > 0)
+                {
+                    --num_r;
+                    swap_elements<T>(a,base_r - offsets_r[start_r + num_r],first);
+                    ++first;
+                }
+
+                last = first;
+            }
+        }
+
+        size_t pivot_pos = first - 1;
+        a[begin] = std::move(a[pivot_pos]);
+        a[pivot_pos] = std::move(pivot);
+        return pivot_pos;
+    }
+
+    //--------------------------------------------------
+    // partition [begin,end) around the pivot a[begin],
+    // putting elements equal to the pivot on the left;
+    // used when the pivot equals the element before the
+    // range, so that runs of equal keys are finished in
+    // one pass
+
+    template <class T, class Sequence>
+    size_t pdq_partition_left(Sequence a, size_t begin, size_t end)
+    {
+        T pivot(std::move(a[begin]));
+        size_t first = begin;
+        size_t last  = end;
+
+        while (pivot < a[--last]) ;
+
+        if (last + 1 == end)
+        {
+            while ((first < last) && !(pivot < a[++first])) ;
+        }
+        else
+        {
+            while (!(pivot < a[++first])) ;
+        }
+
+        while (first < last)
+        {
+            swap_elements<T>(a,first,last);
+            while (pivot < a[--last]) ;
+            while (!(pivot < a[++first])) ;
+        }
+
+        size_t pivot_pos = last;
+        a[begin] = std::move(a[pivot_pos]);
+        a[pivot_pos] = std::move(pivot);
+        return pivot_pos;
+    }
+
+    //--------------------------------------------------
+    // choose a pivot for [begin,end), which must hold at
+    // least PDQ_INSERTION_THRESHOLD elements, and move it
+    // to a[begin]: median of three for small ranges,
+    // Tukey's ninther for large ones. Either way, some
+    // element after the pivot is no less than it.
+
+    template <class T, class Sequence>
+    inline void pdq_choose_pivot(Sequence a, size_t begin, size_t end)
+    {
+        size_t size = end - begin;
+        size_t half = size / 2;
+
+        if (size > PDQ_NINTHER_THRESHOLD)
+        {
+            pdq_sort3<T>(a,begin,begin + half,end - 1);
+            pdq_sort3<T>(a,begin + 1,begin + (half - 1),end - 2);
+            pdq_sort3<T>(a,begin + 2,begin + (half + 1),end - 3);
+            pdq_sort3<T>(a,begin + (half - 1),begin + half,begin + (half + 1));
+            swap_elements<T>(a,begin,begin + half);
+        }
+        else
+            pdq_sort3<T>(a,begin + half,begin,end - 1);
+    }
+
+    //--------------------------------------------------
+    // pattern-defeating quicksort of [begin,end). The
+    // range is leftmost when no element precedes it that
+    // is no greater than all of its elements; otherwise
+    // a[begin - 1] serves as a sentinel. bad_allowed is
+    // the number of badly unbalanced partitions permitted
+    // before switching to heap sort. Recursion is on the
+    // smaller partition, so the depth is at most log2(n).
+    // Block selects the block partition (std::true_type)
+    // or the scanning partition (std::false_type).
+
+    template <class T, class Block, class Sequence>
+    void pdq_sort_loop(Sequence a, size_t begin, size_t end, size_t bad_allowed, bool leftmost)
+    {
+        while (true)
+        {
+            size_t size = end - begin;
+
+            // insertion sort small partitions
+            if (size < PDQ_INSERTION_THRESHOLD)
+            {
+                if (leftmost)
+                    pdq_insertion_sort<T>(a,begin,end);
+                else
+                    pdq_unguarded_insertion_sort<T>(a,begin,end);
+
+                return;
+            }
+
+            pdq_choose_pivot<T>(a,begin,end);
+
+            // a pivot equal to the preceding element is the smallest
+            // value in the range; gather all of its copies at once
+            if (!leftmost && !(a[begin - 1] < a[begin]))
+            {
+                begin = pdq_partition_left<T>(a,begin,end) + 1;
+                continue;
+            }
+
+            bool already_partitioned;
+            size_t pivot_pos = pdq_partition_right<T>(a,begin,end,already_partitioned,Block());
+
+            size_t left_size  = pivot_pos - begin;
+            size_t right_size = end - (pivot_pos + 1);
+
+            if ((left_size < size / 8) || (right_size < size / 8))
+            {
+                // too many bad partitions means an adversarial pattern
+                if (--bad_allowed == 0)
+                {
+                    pdq_heap_sort<T>(a,begin,end);
+                    return;
+                }
+
+                // break up patterns by swapping a few elements in
+                // each partition
+                if (left_size >= PDQ_INSERTION_THRESHOLD)
+                {
+                    size_t q = left_size / 4;
+                    swap_elements<T>(a,begin,begin + q);
+                    swap_elements<T>(a,pivot_pos - 1,pivot_pos - q);
+
+                    if (left_size > PDQ_NINTHER_THRESHOLD)
+                    {
+                        swap_elements<T>(a,begin + 1,begin + (q + 1));
+                        swap_elements<T>(a,begin + 2,begin + (q + 2));
+                        swap_elements<T>(a,pivot_pos - 2,pivot_pos - (q + 1));
+                        swap_elements<T>(a,pivot_pos - 3,pivot_pos - (q + 2));
+                    }
+                }
+
+                if (right_size >= PDQ_INSERTION_THRESHOLD)
+                {
+                    size_t q = right_size / 4;
+                    swap_elements<T>(a,pivot_pos + 1,pivot_pos + (1 + q));
+                    swap_elements<T>(a,end - 1,end - q);
+
+                    if (right_size > PDQ_NINTHER_THRESHOLD)
+                    {
+                        swap_elements<T>(a,pivot_pos + 2,pivot_pos + (2 + q));
+                        swap_elements<T>(a,pivot_pos + 3,pivot_pos + (3 + q));
+                        swap_elements<T>(a,end - 2,end - (1 + q));
+                        swap_elements<T>(a,end - 3,end - (2 + q));
+                    }
+                }
+            }
+            else if (already_partitioned
+                 &&  pdq_partial_insertion_sort<T>(a,begin,pivot_pos)
+                 &&  pdq_partial_insertion_sort<T>(a,pivot_pos + 1,end))
+            {
+                // a balanced partition that needed no swaps is
+                // probably sorted already
+                return;
+            }
+
+            // recurse into the smaller partition, loop on the larger
+            if (left_size < right_size)
+            {
+                pdq_sort_loop<T,Block>(a,begin,pivot_pos,bad_allowed,leftmost);
+                begin    = pivot_pos + 1;
+                leftmost = false;
+            }
+            else
+            {
+                pdq_sort_loop<T,Block>(a,pivot_pos + 1,end,bad_allowed,false);
+                end = pivot_pos;
+            }
+        }
+    }
+
+    //--------------------------------------------------
+    // Quick Sort a sequence in ascending order; Sequence
+    // is a pointer or anything else indexed like one.
+    // This is a pattern-defeating quicksort (Orson
+    // Peters): O(n) on sorted, reversed and all-equal
+    // input, O(n log n) in the worst case, and it uses
+    // only operator < on elements. It never throws
+    // unless copying or comparing elements does. Types
+    // for which is_block_partitionable holds, including
+    // all arithmetic types, use branchless partitioning.
+    template <class T, class Sequence>
+    void quick_sort_sequence(Sequence array, size_t n)
+    {
+        if (n < 2)
+            return;
+
+        // a strictly descending sequence is reversed outright;
+        // the scan stops at the first ascent, so costs little
+        size_t descent = 1;
+
+        while ((descent < n) && (array[descent] < array[descent - 1]))
+            ++descent;
+
+        if (descent == n)
+        {
+            for (size_t i = 0, j = n - 1; i < j; ++i, --j)
+                swap_elements<T>(array,i,j);
+
+            return;
+        }
+
+        // allow about log2(n) bad partitions
+        size_t bad_allowed = 0;
+
+        for (size_t m = n; m > 0; m >>= 1)
+            ++bad_allowed;
+
+        pdq_sort_loop<T,typename is_block_partitionable<T>::type>(array,0,n,bad_allowed,true);
+    }
+
+    //--------------------------------------------------
+    // Quick Sort an array in ascending order
+    template <class T>
+    void quick_sort(T * array, size_t n)
+    {
+        quick_sort_sequence<T>(array,n);
+    }
+
+    //--------------------------------------------------
+    // Quick Sort the elements of a view in ascending order
+    template <class T>
+    void quick_sort(array_view<T> a_view)
+    {
+        if (a_view.is_contiguous())
+            quick_sort_sequence<T>(a_view.data(),a_view.size());
+        else
+            quick_sort_sequence<T>(a_view,a_view.size());
+    }
+
+    //--------------------------------------------------
+    // Selection finds the elements that sorting would
+    // put at given positions, without sorting. After
+    // SELECT_BAD_PARTITIONS badly unbalanced partitions,
+    // introselect takes its pivots from the median of
+    // medians, which bounds its worst case at O(n).
+    const size_t SELECT_BAD_PARTITIONS = 4;
+
+    template <class T, class Block, class Sequence>
+    void select_loop(Sequence a, size_t begin, size_t end, size_t nth, size_t bad_allowed, bool leftmost);
+
+    //--------------------------------------------------
+    // move the median of medians of [begin,end) to
+    // a[begin]: the medians of groups of five gather at
+    // the front of the range, and their own median is
+    // selected recursively
+
+    template <class T, class Block, class Sequence>
+    void select_median_of_medians(Sequence a, size_t begin, size_t end, bool leftmost)
+    {
+        size_t medians = begin;
+
+        for (size_t group = begin; group + 5 <= end; group += 5)
+        {
+            pdq_insertion_sort<T>(a,group,group + 5);
+            swap_elements<T>(a,medians++,group + 2);
+        }
+
+        size_t mid = begin + (medians - begin) / 2;
+        select_loop<T,Block>(a,begin,medians,mid,0,leftmost);
+        swap_elements<T>(a,begin,mid);
+    }
+
+    //--------------------------------------------------
+    // introselect: partition [begin,end) as the pattern-
+    // defeating quicksort does, but continue only into
+    // the side holding position nth. leftmost and the
+    // a[begin - 1] sentinel work as in pdq_sort_loop.
+
+    template <class T, class Block, class Sequence>
+    void select_loop(Sequence a, size_t begin, size_t end, size_t nth, size_t bad_allowed, bool leftmost)
+    {
+        while (true)
+        {
+            size_t size = end - begin;
+
+            if (size < PDQ_INSERTION_THRESHOLD)
+            {
+                if (leftmost)
+                    pdq_insertion_sort<T>(a,begin,end);
+                else
+                    pdq_unguarded_insertion_sort<T>(a,begin,end);
+
+                return;
+            }
+
+            if (bad_allowed > 0)
+                pdq_choose_pivot<T>(a,begin,end);
+            else
+                select_median_of_medians<T,Block>(a,begin,end,leftmost);
+
+            // a pivot equal to the preceding element is the smallest
+            // value in the range; all of its copies are in place
+            // once gathered
+            if (!leftmost && !(a[begin - 1] < a[begin]))
+            {
+                size_t last_equal = pdq_partition_left<T>(a,begin,end);
+
+                if (nth <= last_equal)
+                    return;
+
+                begin = last_equal + 1;
+                continue;
+            }
+
+            bool already_partitioned;
+            size_t pivot_pos = pdq_partition_right<T>(a,begin,end,already_partitioned,Block());
+
+            if (pivot_pos == nth)
+                return;
+
+            size_t left_size  = pivot_pos - begin;
+            size_t right_size = end - (pivot_pos + 1);
+
+            if (((left_size < size / 8) || (right_size < size / 8)) && (bad_allowed > 0))
+                --bad_allowed;
+
+            if (nth < pivot_pos)
+                end = pivot_pos;
+            else
+            {
+                begin    = pivot_pos + 1;
+                leftmost = false;
+            }
+        }
+    }
+
+    //--------------------------------------------------
+    // Select the nth smallest element of a sequence: on
+    // return, array[nth] holds the element that sorting
+    // would put there, no element before it is greater,
+    // and no element after it is less. O(n), using only
+    // operator < on elements; nothing happens if nth is
+    // not less than n.
+    template <class T, class Sequence>
+    void select_nth_sequence(Sequence array, size_t n, size_t nth)
+    {
+        if (nth < n)
+            select_loop<T,typename is_block_partitionable<T>::type>(array,0,n,nth,SELECT_BAD_PARTITIONS,true);
+    }
+
+    //--------------------------------------------------
+    // Select the nth smallest element of an array
+    template <class T>
+    void select_nth(T * array, size_t n, size_t nth)
+    {
+        select_nth_sequence<T>(array,n,nth);
+    }
+
+    //--------------------------------------------------
+    // Select the nth smallest element of a view
+    template <class T>
+    void select_nth(array_view<T> a_view, size_t nth)
+    {
+        if (a_view.is_contiguous())
+            select_nth_sequence<T>(a_view.data(),a_view.size(),nth);
+        else
+            select_nth_sequence<T>(a_view,a_view.size(),nth);
+    }
+
+    //--------------------------------------------------
+    // Partially sort a sequence: on return, its first k
+    // elements are the k smallest, in ascending order,
+    // and the rest follow in no particular order.
+    // O(n + k log k).
+    template <class T, class Sequence>
+    void partial_sort_sequence(Sequence array, size_t n, size_t k)
+    {
+        if (k >= n)
+            quick_sort_sequence<T>(array,n);
+        else if (k > 0)
+        {
+            select_nth_sequence<T>(array,n,k - 1);
+            quick_sort_sequence<T>(array,k - 1);
+        }
+    }
+
+    //--------------------------------------------------
+    // Partially sort an array
+    template <class T>
+    void partial_sort(T * array, size_t n, size_t k)
+    {
+        partial_sort_sequence<T>(array,n,k);
+    }
+
+    //--------------------------------------------------
+    // Partially sort the elements of a view
+    template <class T>
+    void partial_sort(array_view<T> a_view, size_t k)
+    {
+        if (a_view.is_contiguous())
+            partial_sort_sequence<T>(a_view.data(),a_view.size(),k);
+        else
+            partial_sort_sequence<T>(a_view,a_view.size(),k);
+    }
+
+    //--------------------------------------------------
+    // top_k keeps the k largest elements seen so far in
+    // a heap when k is at most TOP_K_HEAP_LIMIT; most
+    // elements then cost a single comparison with the
+    // heap's root. On random input about k ln(n/k)
+    // elements enter the heap; if more than 8k + n/64
+    // do (as for ascending input), or k is larger, the
+    // elements are selected from a copy instead.
+    const size_t TOP_K_HEAP_LIMIT = 1024;
+
+    // sift a_heap[root] down the min-heap a_heap[0,length)
+
+    template <class T>
+    void top_k_sift_down(T * a_heap, size_t root, size_t length)
+    {
+        T t(std::move(a_heap[root]));
+
+        while (true)
+        {
+            size_t child = 2 * root + 1;
+
+            if (child >= length)
+                break;
+
+            if ((child + 1 < length) && (a_heap[child + 1] < a_heap[child]))
+                ++child;
+
+            if (!(a_heap[child] < t))
+                break;
+
+            a_heap[root] = std::move(a_heap[child]);
+            root = child;
+        }
+
+        a_heap[root] = std::move(t);
+    }
+
+    //--------------------------------------------------
+    // Copy the k largest elements of a sequence to
+    // a_result, largest first, leaving the sequence
+    // unchanged; if k exceeds n, all n elements are
+    // copied. O(n) for any k.
+    template <class T, class Sequence>
+    void top_k_sequence(Sequence a_source, size_t n, size_t k, T * a_result)
+    {
+        if (k > n)
+            k = n;
+
+        if (k == 0)
+            return;
+
+        if (k <= TOP_K_HEAP_LIMIT)
+        {
+            for (size_t i = 0; i < k; ++i)
+                a_result[i] = a_source[i];
+
+            for (size_t root = k / 2; root > 0; --root)
+                top_k_sift_down(a_result,root - 1,k);
+
+            size_t budget = 8 * k + n / 64;
+            size_t i = k;
+
+            for ( ; i < n; ++i)
+            {
+                if (a_result[0] < a_source[i])
+                {
+                    if (budget-- == 0)
+                        break;
+
+                    a_result[0] = a_source[i];
+                    top_k_sift_down(a_result,0,k);
+                }
+            }
+
+            if (i == n)
+            {
+                // moving each root in turn to the back of the heap
+                // leaves the largest element first
+                for (size_t length = k - 1; length > 0; --length)
+                {
+                    swap_elements<T>(a_result,0,length);
+                    top_k_sift_down(a_result,0,length);
+                }
+
+                return;
+            }
+        }
+
+        {
+            std::vector<T> work;
+            work.reserve(n);
+
+            for (size_t i = 0; i < n; ++i)
+                work.push_back(a_source[i]);
+
+            size_t first = n - k;
+            select_nth_sequence<T>(&work[0],n,first);
+            quick_sort_sequence<T>(&work[first],k);
+
+            for (size_t i = 0; i < k; ++i)
+                a_result[i] = std::move(work[n - 1 - i]);
+        }
+    }
+
+    //--------------------------------------------------
+    // Copy the k largest elements of an array to
+    // a_result, largest first
+    template <class T>
+    void top_k(const T * a_source, size_t n, size_t k, T * a_result)
+    {
+        top_k_sequence<T>(a_source,n,k,a_result);
+    }
+
+    //--------------------------------------------------
+    // Copy the k largest elements of a view to a_result,
+    // largest first
+    template <class T>
+    void top_k(array_view<T> a_source, size_t k, typename std::remove_const<T>::type * a_result)
+    {
+        typedef typename std::remove_const<T>::type value_type;
+
+        if (a_source.is_contiguous())
+            top_k_sequence<value_type>(a_source.data(),a_source.size(),k,a_result);
+        else
+            top_k_sequence<value_type>(a_source,a_source.size(),k,a_result);
+    }
+
+    //--------------------------------------------------
+    // Runs shorter than MERGE_SORT_RUN are insertion
+    // sorted before merge sort begins merging
+
+    const size_t MERGE_SORT_RUN = 32;
+
+    //--------------------------------------------------
+    // stably merge the sorted runs source[lo,mid) and
+    // source[mid,hi) into target[lo,hi)
+
+    template <class T, class Source, class Target>
+    void merge_runs(Source source, Target target, size_t lo, size_t mid, size_t hi)
+    {
+        size_t i = lo;
+        size_t j = mid;
+        size_t k = lo;
+
+        while ((i < mid) && (j < hi))
+        {
+            // take from the right only when strictly smaller
+            if (source[j] < source[i])
+                target[k++] = std::move(source[j++]);
+            else
+                target[k++] = std::move(source[i++]);
+        }
+
+        while (i < mid)
+            target[k++] = std::move(source[i++]);
+
+        while (j < hi)
+            target[k++] = std::move(source[j++]);
+    }
+
+    //--------------------------------------------------
+    // Merge Sort a sequence in ascending order; Sequence
+    // is a pointer or anything else indexed like one.
+    // Stable: equal elements keep their original order.
+    // Uses a buffer of n elements and only operator <.
+    template <class T, class Sequence>
+    void merge_sort_sequence(Sequence array, size_t n)
+    {
+        if (n < 2)
+            return;
+
+        // sort short runs in place
+        for (size_t lo = 0; lo < n; lo += MERGE_SORT_RUN)
+            pdq_insertion_sort<T>(array,lo,min_of(lo + MERGE_SORT_RUN,n));
+
+        if (n <= MERGE_SORT_RUN)
+            return;
+
+        // merge runs bottom-up, alternating between the
+        // sequence and the buffer
+        std::vector<T> buffer(n);
+        bool in_buffer = false;
+
+        for (size_t width = MERGE_SORT_RUN; width < n; width *= 2)
+        {
+            for (size_t lo = 0; lo < n; lo += 2 * width)
+            {
+                size_t mid = min_of(lo + width,n);
+                size_t hi  = min_of(lo + 2 * width,n);
+
+                if (in_buffer)
+                    merge_runs<T>(&buffer[0],array,lo,mid,hi);
+                else
+                    merge_runs<T>(array,&buffer[0],lo,mid,hi);
+            }
+
+            in_buffer = !in_buffer;
+        }
+
+        if (in_buffer)
+        {
+            for (size_t i = 0; i < n; ++i)
+                array[i] = std::move(buffer[i]);
+        }
+    }
+
+    //--------------------------------------------------
+    // Merge Sort an array in ascending order
+    template <class T>
+    void merge_sort(T * array, size_t n)
+    {
+        merge_sort_sequence<T>(array,n);
+    }
+
+    //--------------------------------------------------
+    // Merge Sort the elements of a view in ascending order
+    template <class T>
+    void merge_sort(array_view<T> a_view)
+    {
+        if (a_view.is_contiguous())
+            merge_sort_sequence<T>(a_view.data(),a_view.size());
+        else
+            merge_sort_sequence<T>(a_view,a_view.size());
+    }
+
+    //--------------------------------------------------
+    // Tim Sort parameters: natural runs shorter than a
+    // minimum run length between TIM_SORT_MIN_RUN and
+    // twice that are extended by insertion sort, and a
+    // merge starts galloping once one side has supplied
+    // TIM_SORT_GALLOP elements in a row. The merge order
+    // (Munro and Wild's powersort policy) keeps at most
+    // one pending run per bit of n.
+
+    const size_t TIM_SORT_MIN_RUN = 32;
+    const size_t TIM_SORT_GALLOP  = 7;
+    const size_t TIM_SORT_STACK   = 8 * sizeof(size_t) + 1;
+
+    //--------------------------------------------------
+    // count the elements of the sorted range a[base,
+    // base + len) that belong before key: those less
+    // than it, or with a_upper those no greater than it.
+    // The exponential search starts at the left end, or
+    // at the right end with a_from_right, so it costs
+    // O(log d) comparisons for an answer d elements from
+    // where it starts.
+
+    template <class T, class Sequence>
+    size_t tim_sort_gallop(const T & key, Sequence a, size_t base, size_t len, bool a_upper, bool a_from_right)
+    {
+        size_t lo = 0;
+        size_t hi = len;
+        size_t step = 1;
+
+        if (a_from_right)
+        {
+            // back off until an element belongs before the key
+            while ((step <= hi) && !(a_upper ? !(key < a[base + hi - step]) : (a[base + hi - step] < key)))
+            {
+                hi -= step;
+                step *= 2;
+            }
+
+            lo = (step <= hi) ? hi - step + 1 : 0;
+        }
+        else
+        {
+            // advance until an element does not belong before the key
+            while ((lo + step <= len) && (a_upper ? !(key < a[base + lo + step - 1]) : (a[base + lo + step - 1] < key)))
+            {
+                lo += step;
+                step *= 2;
+            }
+
+            hi = min_of(lo + step - 1,len);
+        }
+
+        while (lo < hi)
+        {
+            size_t mid = lo + (hi - lo) / 2;
+
+            if (a_upper ? !(key < a[base + mid]) : (a[base + mid] < key))
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+
+        return lo;
+    }
+
+    //--------------------------------------------------
+    // merge the runs a[lo,mid) and a[mid,hi) when the left
+    // one is no longer: it moves to the buffer, and the
+    // merge proceeds from the front
+
+    template <class T, class Sequence>
+    void tim_sort_merge_lo(Sequence a, size_t lo, size_t mid, size_t hi, T * a_buffer)
+    {
+        size_t len_a = mid - lo;
+
+        for (size_t n = 0; n < len_a; ++n)
+            a_buffer[n] = std::move(a[lo + n]);
+
+        size_t i = 0;
+        size_t j = mid;
+        size_t k = lo;
+        size_t a_wins = 0;
+        size_t b_wins = 0;
+
+        while ((i < len_a) && (j < hi))
+        {
+            // take from the right only when strictly smaller
+            if (a[j] < a_buffer[i])
+            {
+                a[k++] = std::move(a[j++]);
+                ++b_wins;
+                a_wins = 0;
+            }
+            else
+            {
+                a[k++] = std::move(a_buffer[i++]);
+                ++a_wins;
+                b_wins = 0;
+            }
+
+            // once one side dominates, move whole stretches of
+            // each side at a time while that pays off
+            if ((a_wins >= TIM_SORT_GALLOP) || (b_wins >= TIM_SORT_GALLOP))
+            {
+                size_t count_a;
+                size_t count_b;
+
+                do
+                {
+                    count_a = 0;
+                    count_b = 0;
+
+                    if (j < hi)
+                    {
+                        count_a = tim_sort_gallop(a[j],a_buffer,i,len_a - i,true,false);
+
+                        for (size_t n = 0; n < count_a; ++n)
+                            a[k++] = std::move(a_buffer[i++]);
+                    }
+
+                    if (i < len_a)
+                    {
+                        count_b = tim_sort_gallop(a_buffer[i],a,j,hi - j,false,false);
+
+                        for (size_t n = 0; n < count_b; ++n)
+                            a[k++] = std::move(a[j++]);
+                    }
+                }
+                while (((count_a >= TIM_SORT_GALLOP) || (count_b >= TIM_SORT_GALLOP)) && (i < len_a) && (j < hi));
+
+                a_wins = 0;
+                b_wins = 0;
+            }
+        }
+
+        // what remains of the right run is in place already
+        while (i < len_a)
+            a[k++] = std::move(a_buffer[i++]);
+    }
+
+    //--------------------------------------------------
+    // merge the runs a[lo,mid) and a[mid,hi) when the right
+    // one is shorter: it moves to the buffer, and the merge
+    // proceeds from the back
+
+    template <class T, class Sequence>
+    void tim_sort_merge_hi(Sequence a, size_t lo, size_t mid, size_t hi, T * a_buffer)
+    {
+        size_t len_b = hi - mid;
+
+        for (size_t n = 0; n < len_b; ++n)
+            a_buffer[n] = std::move(a[mid + n]);
+
+        size_t i = mid;
+        size_t j = len_b;
+        size_t k = hi;
+        size_t a_wins = 0;
+        size_t b_wins = 0;
+
+        while ((i > lo) && (j > 0))
+        {
+            // take from the left only when strictly greater
+            if (a_buffer[j - 1] < a[i - 1])
+            {
+                a[--k] = std::move(a[--i]);
+                ++a_wins;
+                b_wins = 0;
+            }
+            else
+            {
+                a[--k] = std::move(a_buffer[--j]);
+                ++b_wins;
+                a_wins = 0;
+            }
+
+            if ((a_wins >= TIM_SORT_GALLOP) || (b_wins >= TIM_SORT_GALLOP))
+            {
+                size_t count_a;
+                size_t count_b;
+
+                do
+                {
+                    count_a = 0;
+                    count_b = 0;
+
+                    if (j > 0)
+                    {
+                        count_a = (i - lo) - tim_sort_gallop(a_buffer[j - 1],a,lo,i - lo,true,true);
+
+                        for (size_t n = 0; n < count_a; ++n)
+                            a[--k] = std::move(a[--i]);
+                    }
+
+                    if (i > lo)
+                    {
+                        count_b = j - tim_sort_gallop(a[i - 1],a_buffer,0,j,false,true);
+
+                        for (size_t n = 0; n < count_b; ++n)
+                            a[--k] = std::move(a_buffer[--j]);
+                    }
+                }
+                while (((count_a >= TIM_SORT_GALLOP) || (count_b >= TIM_SORT_GALLOP)) && (i > lo) && (j > 0));
+
+                a_wins = 0;
+                b_wins = 0;
+            }
+        }
+
+        // what remains of the left run is in place already
+        while (j > 0)
+            a[--k] = std::move(a_buffer[--j]);
+    }
+
+    //--------------------------------------------------
+    // merge the adjacent runs a[lo,mid) and a[mid,hi).
+    // Elements of the left run no greater than the right
+    // run's first, and elements of the right run no less
+    // than the left run's last, are in place already, so
+    // only the rest is merged; the buffer must hold the
+    // shorter of the remaining runs.
+
+    template <class T, class Sequence>
+    void tim_sort_merge(Sequence a, size_t lo, size_t mid, size_t hi, T * a_buffer)
+    {
+        lo += tim_sort_gallop(a[mid],a,lo,mid - lo,true,false);
+
+        if (lo == mid)
+            return;
+
+        hi = mid + tim_sort_gallop(a[mid - 1],a,mid,hi - mid,false,true);
+
+        if (mid - lo <= hi - mid)
+            tim_sort_merge_lo(a,lo,mid,hi,a_buffer);
+        else
+            tim_sort_merge_hi(a,lo,mid,hi,a_buffer);
+    }
+
+    //--------------------------------------------------
+    // powersort priority of the boundary between the
+    // adjacent runs [s1,s1 + n1) and [s1 + n1,s1 + n1 + n2)
+    // of n elements: the first bit in which the relative
+    // positions of the runs' midpoints differ
+
+    inline unsigned tim_sort_power(size_t s1, size_t n1, size_t n2, size_t n)
+    {
+        // twice the midpoints, so they stay integral
+        size_t a = 2 * s1 + n1;
+        size_t b = a + n1 + n2;
+        unsigned power = 0;
+
+        while (true)
+        {
+            ++power;
+
+            if (a >= n)
+            {
+                a -= n;
+                b -= n;
+            }
+            else if (b >= n)
+                break;
+
+            a <<= 1;
+            b <<= 1;
+        }
+
+        return power;
+    }
+
+    //--------------------------------------------------
+    // a pending run awaiting its merge
+
+    struct tim_sort_run
+    {
+        size_t   m_start;
+        size_t   m_length;
+        unsigned m_power;
+    };
+
+    //--------------------------------------------------
+    // Tim Sort a sequence in ascending order; Sequence is
+    // a pointer or anything else indexed like one. This
+    // is a stable, adaptive merge sort: it finds the runs
+    // already present (reversing strictly descending
+    // ones), so sorted and nearly sorted input costs
+    // close to O(n), and O(n log n) in the worst case. It
+    // uses only operator <. a_buffer must hold n / 2
+    // elements; when it is NULL, a buffer is allocated
+    // if and when the first merge needs one.
+    template <class T, class Sequence>
+    void tim_sort_sequence(Sequence array, size_t n, T * a_buffer)
+    {
+        if (n < 2)
+            return;
+
+        if (n < 2 * TIM_SORT_MIN_RUN)
+        {
+            pdq_insertion_sort<T>(array,0,n);
+            return;
+        }
+
+        // choose a minimum run length for which n / min_run
+        // is a power of two, or just under one
+        size_t min_run = n;
+        size_t odd     = 0;
+
+        while (min_run >= 2 * TIM_SORT_MIN_RUN)
+        {
+            odd |= min_run & 1;
+            min_run >>= 1;
+        }
+
+        min_run += odd;
+
+        std::vector<T> own_buffer;
+        tim_sort_run pending[TIM_SORT_STACK];
+        size_t depth = 0;
+        size_t lo = 0;
+
+        while (lo < n)
+        {
+            // find the run that starts here
+            size_t hi = lo + 1;
+
+            if ((hi < n) && (array[hi] < array[lo]))
+            {
+                while ((hi < n) && (array[hi] < array[hi - 1]))
+                    ++hi;
+
+                for (size_t i = lo, j = hi - 1; i < j; ++i, --j)
+                    swap_elements<T>(array,i,j);
+            }
+            else
+            {
+                while ((hi < n) && !(array[hi] < array[hi - 1]))
+                    ++hi;
+            }
+
+            // extend a short run to the minimum length
+            if (hi - lo < min_run)
+            {
+                hi = min_of(lo + min_run,n);
+                pdq_insertion_sort<T>(array,lo,hi);
+            }
+
+            // merge pending runs whose boundaries have a higher
+            // priority than the new one
+            if (depth > 0)
+            {
+                tim_sort_run & top = pending[depth - 1];
+                unsigned power = tim_sort_power(top.m_start,top.m_length,hi - lo,n);
+
+                while ((depth > 1) && (pending[depth - 2].m_power > power))
+                {
+                    if (a_buffer == NULL)
+                    {
+                        own_buffer.resize(n / 2);
+                        a_buffer = &own_buffer[0];
+                    }
+
+                    tim_sort_run & left  = pending[depth - 2];
+                    tim_sort_run & right = pending[depth - 1];
+                    tim_sort_merge(array,left.m_start,right.m_start,right.m_start + right.m_length,a_buffer);
+                    left.m_length += right.m_length;
+                    --depth;
+                }
+
+                pending[depth - 1].m_power = power;
+            }
+
+            pending[depth].m_start  = lo;
+            pending[depth].m_length = hi - lo;
+            pending[depth].m_power  = 0;
+            ++depth;
+
+            lo = hi;
+        }
+
+        // merge whatever is still pending, right to left
+        while (depth > 1)
+        {
+            if (a_buffer == NULL)
+            {
+                own_buffer.resize(n / 2);
+                a_buffer = &own_buffer[0];
+            }
+
+            tim_sort_run & left  = pending[depth - 2];
+            tim_sort_run & right = pending[depth - 1];
+            tim_sort_merge(array,left.m_start,right.m_start,right.m_start + right.m_length,a_buffer);
+            left.m_length += right.m_length;
+            --depth;
+        }
+    }
+
+    //--------------------------------------------------
+    // Tim Sort an array in ascending order
+    template <class T>
+    void tim_sort(T * array, size_t n)
+    {
+        tim_sort_sequence<T>(array,n,static_cast<T *>(NULL));
+    }
+
+    //--------------------------------------------------
+    // Tim Sort an array in ascending order, using a
+    // caller's scratch buffer of at least n / 2 elements
+    // instead of allocating one
+    template <class T>
+    void tim_sort(T * array, size_t n, T * a_buffer)
+    {
+        tim_sort_sequence<T>(array,n,a_buffer);
+    }
+
+    //--------------------------------------------------
+    // Tim Sort the elements of a view in ascending order;
+    // a_buffer, if not NULL, holds at least half as many
+    // elements as the view
+    template <class T>
+    void tim_sort(array_view<T> a_view, T * a_buffer = NULL)
+    {
+        if (a_view.is_contiguous())
+            tim_sort_sequence<T>(a_view.data(),a_view.size(),a_buffer);
+        else
+            tim_sort_sequence<T>(a_view,a_view.size(),a_buffer);
+    }
+
+    //--------------------------------------------------
+    // Sequences shorter than PARALLEL_SORT_THRESHOLD are
+    // sorted by a single thread, and each thread of a
+    // parallel sort is given at least half that many
+
+    const size_t PARALLEL_SORT_THRESHOLD = 1 << 16;
+
+    //--------------------------------------------------
+    // Threads to use for n elements: a_threads, or one
+    // per core when it is zero, limited as above. Short
+    // sequences get one thread without asking the system
+    // for the core count, which costs microseconds.
+
+    inline size_t parallel_sort_threads(size_t n, size_t a_threads)
+    {
+        if (n < PARALLEL_SORT_THRESHOLD)
+            return 1;
+
+        size_t threads = (a_threads == 0) ? size_t(std::thread::hardware_concurrency()) : a_threads;
+
+        if (threads > n / (PARALLEL_SORT_THRESHOLD / 2))
+            threads = n / (PARALLEL_SORT_THRESHOLD / 2);
+
+        return (threads > 1) ? threads : 1;
+    }
+
+    //--------------------------------------------------
+    // Samples taken per thread to choose bucket splitters
+
+    const size_t PARALLEL_SORT_OVERSAMPLE = 64;
+
+    //--------------------------------------------------
+    // state shared by the threads of one parallel sort
+
+    template <class T>
+    struct sample_sort_state
+    {
+        T *                   m_array;
+        size_t                m_length;
+        size_t                m_threads;
+        bool                  m_stable;
+        std::vector<T>        m_splitters;
+        std::vector<unsigned> m_bucket_of;
+        std::vector<size_t>   m_counts;
+        std::vector<size_t>   m_bounds;
+        std::vector<T>        m_buffer;
+        std::atomic<size_t>   m_next_bucket;
+    };
+
+    // classify one thread's share of the elements into buckets
+    template <class T>
+    void sample_sort_classify(sample_sort_state<T> * s, size_t t)
+    {
+        size_t first = s->m_length * t / s->m_threads;
+        size_t last  = s->m_length * (t + 1) / s->m_threads;
+        size_t * counts = &s->m_counts[t * s->m_threads];
+        const T * splitters = s->m_splitters.empty() ? NULL : &s->m_splitters[0];
+        size_t num_splitters = s->m_splitters.size();
+
+        for (size_t i = first; i < last; ++i)
+        {
+            // the bucket is the number of splitters no greater
+            // than the element, so equal keys share a bucket
+            size_t lo = 0;
+            size_t hi = num_splitters;
+
+            while (lo < hi)
+            {
+                size_t mid = (lo + hi) / 2;
+
+                if (s->m_array[i] < splitters[mid])
+                    hi = mid;
+                else
+                    lo = mid + 1;
+            }
+
+            s->m_bucket_of[i] = unsigned(lo);
+            ++counts[lo];
+        }
+    }
+
+    // move one thread's share of the elements into their
+    // buckets; m_counts holds each thread's starting offset
+    // in each bucket, so the original order is preserved
+    template <class T>
+    void sample_sort_scatter(sample_sort_state<T> * s, size_t t)
+    {
+        size_t first = s->m_length * t / s->m_threads;
+        size_t last  = s->m_length * (t + 1) / s->m_threads;
+        size_t * offsets = &s->m_counts[t * s->m_threads];
+
+        for (size_t i = first; i < last; ++i)
+            s->m_buffer[offsets[s->m_bucket_of[i]]++] = std::move(s->m_array[i]);
+    }
+
+    // sort buckets, taking the next unsorted bucket until
+    // none remain, and move them back into the array
+    template <class T>
+    void sample_sort_buckets(sample_sort_state<T> * s, size_t)
+    {
+        while (true)
+        {
+            size_t b = s->m_next_bucket++;
+
+            if (b >= s->m_threads)
+                break;
+
+            size_t first  = s->m_bounds[b];
+            size_t length = s->m_bounds[b + 1] - first;
+            T * bucket = &s->m_buffer[0] + first;
+
+            if (s->m_stable)
+                merge_sort_sequence<T>(bucket,length);
+            else
+                quick_sort_sequence<T>(bucket,length);
+
+            for (size_t i = 0; i < length; ++i)
+                s->m_array[first + i] = std::move(bucket[i]);
+        }
+    }
+
+    // run a phase of the parallel sort on every thread
+    template <class T>
+    void sample_sort_phase(sample_sort_state<T> & s, void (*a_phase)(sample_sort_state<T> *, size_t))
+    {
+        std::vector<std::thread> workers;
+
+        for (size_t t = 1; t < s.m_threads; ++t)
+            workers.push_back(std::thread(a_phase,&s,t));
+
+        a_phase(&s,0);
+
+        for (size_t i = 0; i < workers.size(); ++i)
+            workers[i].join();
+    }
+
+    //--------------------------------------------------
+    // Sort an array in ascending order using several
+    // threads. This is a sample sort: splitters chosen
+    // from a sample divide the elements into one bucket
+    // per thread, the buckets are filled in parallel,
+    // and each is then sorted by quick_sort (or, when
+    // a_stable is true, merge_sort). Elements equal to
+    // each other always share a bucket, and buckets are
+    // filled in original order, so the stable variant
+    // keeps equal elements in order. a_threads == 0 uses
+    // every core; short arrays are sorted serially.
+    template <class T>
+    void parallel_sort(T * array, size_t n, size_t a_threads = 0, bool a_stable = false)
+    {
+        size_t threads = parallel_sort_threads(n,a_threads);
+
+        if (threads < 2)
+        {
+            if (a_stable)
+                merge_sort_sequence<T>(array,n);
+            else
+                quick_sort_sequence<T>(array,n);
+
+            return;
+        }
+
+        sample_sort_state<T> s;
+        s.m_array    = array;
+        s.m_length   = n;
+        s.m_threads  = threads;
+        s.m_stable   = a_stable;
+        s.m_next_bucket = 0;
+
+        // choose threads - 1 splitters from an evenly spaced sample
+        size_t sample_size = threads * PARALLEL_SORT_OVERSAMPLE;
+        std::vector<T> sample(sample_size);
+
+        for (size_t i = 0; i < sample_size; ++i)
+            sample[i] = array[(n / sample_size) * i + (n / sample_size) / 2];
+
+        quick_sort_sequence<T>(&sample[0],sample_size);
+
+        for (size_t b = 1; b < threads; ++b)
+            s.m_splitters.push_back(sample[b * PARALLEL_SORT_OVERSAMPLE]);
+
+        // count each thread's elements per bucket
+        s.m_bucket_of.resize(n);
+        s.m_counts.assign(threads * threads,0);
+        sample_sort_phase(s,sample_sort_classify<T>);
+
+        // turn counts into starting offsets, bucket by bucket
+        s.m_bounds.resize(threads + 1);
+        size_t offset = 0;
+
+        for (size_t b = 0; b < threads; ++b)
+        {
+            s.m_bounds[b] = offset;
+
+            for (size_t t = 0; t < threads; ++t)
+            {
+                size_t count = s.m_counts[t * threads + b];
+                s.m_counts[t * threads + b] = offset;
+                offset += count;
+            }
+        }
+
+        s.m_bounds[threads] = offset;
+
+        // distribute, then sort the buckets
+        s.m_buffer.resize(n);
+        sample_sort_phase(s,sample_sort_scatter<T>);
+        sample_sort_phase(s,sample_sort_buckets<T>);
+    }
+
+    //--------------------------------------------------
+    // Sort the elements of a view using several threads;
+    // strided views are sorted serially
+    template <class T>
+    void parallel_sort(array_view<T> a_view, size_t a_threads = 0, bool a_stable = false)
+    {
+        if (a_view.is_contiguous())
+            parallel_sort(a_view.data(),a_view.size(),a_threads,a_stable);
+        else if (a_stable)
+            merge_sort_sequence<T>(a_view,a_view.size());
+        else
+            quick_sort_sequence<T>(a_view,a_view.size());
+    }
+
+    //--------------------------------------------------
+    // Maps a key type onto an unsigned integer type of
+    // the same size whose unsigned order is the key's
+    // order; radix_sort accepts exactly the key types
+    // with a specialization. Signed integers have their
+    // sign bit flipped. IEEE floats have their sign bit
+    // flipped when positive and every bit flipped when
+    // negative, so -0.0 sorts just before +0.0 and NaNs
+    // sort to the end (or, with the sign bit set, to the
+    // beginning).
+
+    template <class T, class Enable = void>
+    struct radix_key_traits;
+
+    template <class T>
+    struct radix_key_traits<T, typename std::enable_if<std::is_integral<T>::value && std::is_unsigned<T>::value>::type>
+    {
+        typedef T bits_type;
+
+        static bits_type encode(T a_key) { return a_key; }
+        static T decode(bits_type a_bits) { return a_bits; }
+    };
+
+    template <class T>
+    struct radix_key_traits<T, typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type>
+    {
+        typedef typename std::make_unsigned<T>::type bits_type;
+
+        static const bits_type SIGN = bits_type(bits_type(1) << (8 * sizeof(T) - 1));
+
+        static bits_type encode(T a_key) { return bits_type(bits_type(a_key) ^ SIGN); }
+        static T decode(bits_type a_bits) { return T(bits_type(a_bits ^ SIGN)); }
+    };
+
+    template <>
+    struct radix_key_traits<float>
+    {
+        typedef uint32_t bits_type;
+
+        static bits_type encode(float a_key)
+        {
+            bits_type bits;
+            memcpy(&bits,&a_key,sizeof(bits));
+            return bits ^ (bits_type(-int32_t(bits >> 31)) | 0x80000000U);
+        }
+
+        static float decode(bits_type a_bits)
+        {
+            a_bits ^= (bits_type((a_bits >> 31) - 1) | 0x80000000U);
+            float key;
+            memcpy(&key,&a_bits,sizeof(key));
+            return key;
+        }
+    };
+
+    template <>
+    struct radix_key_traits<double>
+    {
+        typedef uint64_t bits_type;
+
+        static bits_type encode(double a_key)
+        {
+            bits_type bits;
+            memcpy(&bits,&a_key,sizeof(bits));
+            return bits ^ (bits_type(-int64_t(bits >> 63)) | 0x8000000000000000ULL);
+        }
+
+        static double decode(bits_type a_bits)
+        {
+            a_bits ^= (bits_type((a_bits >> 63) - 1) | 0x8000000000000000ULL);
+            double key;
+            memcpy(&key,&a_bits,sizeof(key));
+            return key;
+        }
+    };
+
+    //--------------------------------------------------
+    // Key types that have radix_key_traits: integers
+    // other than bool, float and double
+
+    template <class T>
+    struct is_radix_sortable
+      : public std::integral_constant<bool, (std::is_integral<T>::value && !std::is_same<T,bool>::value)
+                                         || std::is_same<T,float>::value
+                                         || std::is_same<T,double>::value>
+    {
+    };
+
+    //--------------------------------------------------
+    // Arrays shorter than RADIX_SORT_THRESHOLD are sorted
+    // by quick_sort, which is faster than clearing and
+    // summing the digit histograms. Buckets of at most
+    // RADIX_MSD_CUTOFF keys are small enough to finish
+    // with LSD passes in cache.
+
+    const size_t RADIX_SORT_THRESHOLD = 1024;
+    const size_t RADIX_MSD_CUTOFF     = 1 << 14;
+
+    //--------------------------------------------------
+    // digit layout for the keys of radix_sort: 11-bit
+    // digits (three passes) for 32-bit keys, and 8-bit
+    // digits otherwise
+
+    template <class Bits>
+    struct radix_digits
+    {
+        static const unsigned WIDTH   = (sizeof(Bits) == 4) ? 11 : 8;
+        static const unsigned PASSES  = (8 * sizeof(Bits) + WIDTH - 1) / WIDTH;
+        static const size_t   BUCKETS = size_t(1) << WIDTH;
+        static const Bits     MASK    = Bits((size_t(1) << WIDTH) - 1);
+    };
+
+    // placeholder payload for radix sorts of keys alone
+    struct radix_no_payload
+    {
+    };
+
+    // the arrays of one radix sort: records move between
+    // the caller's keys and payload and a buffer of each;
+    // keys are encoded in the buffer
+    template <class Key, class Payload>
+    struct radix_arrays
+    {
+        typedef radix_key_traits<Key>      traits;
+        typedef typename traits::bits_type bits_type;
+        typedef radix_digits<bits_type>    digits;
+
+        Key *       m_keys;
+        bits_type * m_buffer;
+        Payload *   m_payload;
+        Payload *   m_payload_buffer;
+
+        bool has_payload() const
+        {
+            return !std::is_same<Payload,radix_no_payload>::value && (m_payload != NULL);
+        }
+
+        bits_type bits(size_t i, bool a_in_buffer) const
+        {
+            return a_in_buffer ? m_buffer[i] : traits::encode(m_keys[i]);
+        }
+
+        // move record i from one side to position j on the other
+        void move_record(size_t i, size_t j, bool a_from_buffer)
+        {
+            if (a_from_buffer)
+            {
+                m_keys[j] = traits::decode(m_buffer[i]);
+
+                if (has_payload())
+                    m_payload[j] = std::move(m_payload_buffer[i]);
+            }
+            else
+            {
+                m_buffer[j] = traits::encode(m_keys[i]);
+
+                if (has_payload())
+                    m_payload_buffer[j] = std::move(m_payload[i]);
+            }
+        }
+    };
+
+    //--------------------------------------------------
+    // stable counting pass over one digit of records
+    // [a_first,a_first + n), from one side to the other;
+    // a_count holds the digit's histogram and becomes
+    // scratch. Returns false, moving nothing, when every
+    // record has the same digit.
+
+    template <class Key, class Payload>
+    bool radix_pass(radix_arrays<Key,Payload> & r, size_t a_first, size_t n, unsigned a_digit, size_t * a_count, bool a_in_buffer)
+    {
+        typedef typename radix_arrays<Key,Payload>::bits_type bits_type;
+        typedef typename radix_arrays<Key,Payload>::digits    digits;
+
+        unsigned shift = a_digit * digits::WIDTH;
+
+        if (a_count[(r.bits(a_first,a_in_buffer) >> shift) & digits::MASK] == n)
+            return false;
+
+        size_t offset = a_first;
+
+        for (size_t b = 0; b < digits::BUCKETS; ++b)
+        {
+            size_t c = a_count[b];
+            a_count[b] = offset;
+            offset += c;
+        }
+
+        for (size_t i = a_first; i < a_first + n; ++i)
+        {
+            bits_type bits = r.bits(i,a_in_buffer);
+            r.move_record(i,a_count[(bits >> shift) & digits::MASK]++,a_in_buffer);
+        }
+
+        return true;
+    }
+
+    //--------------------------------------------------
+    // LSD radix sort of records [a_first,a_first + n) on
+    // their lowest a_digits digits. One read counts every
+    // digit at once; each pass scatters by one digit and
+    // is skipped when all records share that digit. The
+    // records start in the buffer when a_in_buffer is
+    // true, and always end in the caller's arrays.
+
+    template <class Key, class Payload>
+    void radix_lsd(radix_arrays<Key,Payload> & r, size_t a_first, size_t n, unsigned a_digits, bool a_in_buffer)
+    {
+        typedef typename radix_arrays<Key,Payload>::bits_type bits_type;
+        typedef typename radix_arrays<Key,Payload>::digits    digits;
+
+        if (n > 1)
+        {
+            std::vector<size_t> counts(a_digits * digits::BUCKETS,0);
+
+            for (size_t i = a_first; i < a_first + n; ++i)
+            {
+                bits_type bits = r.bits(i,a_in_buffer);
+
+                for (unsigned d = 0; d < a_digits; ++d)
+                    ++counts[d * digits::BUCKETS + ((bits >> (d * digits::WIDTH)) & digits::MASK)];
+            }
+
+            for (unsigned d = 0; d < a_digits; ++d)
+            {
+                if (radix_pass(r,a_first,n,d,&counts[d * digits::BUCKETS],a_in_buffer))
+                    a_in_buffer = !a_in_buffer;
+            }
+        }
+
+        if (a_in_buffer)
+        {
+            for (size_t i = a_first; i < a_first + n; ++i)
+                r.move_record(i,i,true);
+        }
+    }
+
+    //--------------------------------------------------
+    // MSD radix sort of records [a_first,a_first + n) on
+    // digits a_digit and below: distributes the records
+    // by their top digit, then sorts each bucket on the
+    // digits below, until buckets fit in cache and are
+    // finished by LSD passes. Used for keys too wide for
+    // a few LSD passes over main memory; each level moves
+    // the data once, and skewed digits (such as the
+    // exponents of doubles in a narrow range) are skipped.
+
+    template <class Key, class Payload>
+    void radix_msd(radix_arrays<Key,Payload> & r, size_t a_first, size_t n, unsigned a_digit, bool a_in_buffer)
+    {
+        typedef typename radix_arrays<Key,Payload>::digits digits;
+
+        typedef typename radix_arrays<Key,Payload>::bits_type bits_type;
+
+        std::vector<size_t> count;
+        std::vector<size_t> next;
+
+        while ((n > RADIX_MSD_CUTOFF) && (a_digit > 0))
+        {
+            unsigned shift = a_digit * digits::WIDTH;
+
+            // count this digit, and the next one in case every
+            // record shares this one; a skipped digit then costs
+            // no extra read
+            if (next.empty())
+            {
+                count.assign(digits::BUCKETS,0);
+                next.assign(digits::BUCKETS,0);
+
+                for (size_t i = a_first; i < a_first + n; ++i)
+                {
+                    bits_type bits = r.bits(i,a_in_buffer);
+                    ++count[(bits >> shift) & digits::MASK];
+                    ++next[(bits >> (shift - digits::WIDTH)) & digits::MASK];
+                }
+            }
+            else
+            {
+                count.swap(next);
+                next.clear();
+            }
+
+            std::vector<size_t> sizes(count);
+
+            if (radix_pass(r,a_first,n,a_digit,&count[0],a_in_buffer))
+            {
+                // sort each bucket on the remaining digits
+                size_t first = a_first;
+
+                for (size_t b = 0; b < digits::BUCKETS; ++b)
+                {
+                    radix_msd(r,first,sizes[b],a_digit - 1,!a_in_buffer);
+                    first += sizes[b];
+                }
+
+                return;
+            }
+
+            // every record shares this digit
+            --a_digit;
+        }
+
+        radix_lsd(r,a_first,n,a_digit + 1,a_in_buffer);
+    }
+
+    //--------------------------------------------------
+    // radix sort keys and an optional payload; LSD for
+    // keys of up to 32 bits, MSD for wider ones
+
+    template <class Key, class Payload>
+    void radix_sort_records(Key * a_keys, Payload * a_payload, size_t n)
+    {
+        typedef radix_arrays<Key,Payload>         arrays;
+        typedef typename arrays::bits_type        bits_type;
+        typedef typename arrays::digits           digits;
+
+        if (n < 2)
+            return;
+
+        std::vector<bits_type> buffer(n);
+        std::vector<Payload>   payload_buffer;
+
+        arrays r;
+        r.m_keys           = a_keys;
+        r.m_buffer         = &buffer[0];
+        r.m_payload        = a_payload;
+        r.m_payload_buffer = NULL;
+
+        if (r.has_payload())
+        {
+            payload_buffer.resize(n);
+            r.m_payload_buffer = &payload_buffer[0];
+        }
+
+        if (digits::PASSES <= 3)
+            radix_lsd(r,0,n,digits::PASSES,false);
+        else
+            radix_msd(r,0,n,digits::PASSES - 1,false);
+    }
+
+    //--------------------------------------------------
+    // Radix Sort an array of integer or floating-point
+    // keys in ascending order. Accepts the key types of
+    // radix_key_traits; short arrays go to quick_sort.
+    template <class Key>
+    void radix_sort(Key * a_keys, size_t n)
+    {
+        if (n < RADIX_SORT_THRESHOLD)
+            quick_sort_sequence<Key>(a_keys,n);
+        else
+            radix_sort_records(a_keys,static_cast<radix_no_payload *>(NULL),n);
+    }
+
+    //--------------------------------------------------
+    // Radix Sort the elements of a view; strided views
+    // go to quick_sort
+    template <class Key>
+    void radix_sort(array_view<Key> a_view)
+    {
+        if (a_view.is_contiguous())
+            radix_sort(a_view.data(),a_view.size());
+        else
+            quick_sort_sequence<Key>(a_view,a_view.size());
+    }
+
+    //--------------------------------------------------
+    // Radix Sort keys in ascending order, applying the
+    // same rearrangement to a parallel array of payload
+    // values (a_payload[i] belongs to a_keys[i]). Stable:
+    // payloads with equal keys keep their order.
+    template <class Key, class Payload>
+    void radix_sort(Key * a_keys, Payload * a_payload, size_t n)
+    {
+        radix_sort_records(a_keys,a_payload,n);
+    }
+
+    //--------------------------------------------------
+    // A key paired with the position it came from; ties
+    // between keys are broken by position, so sorting
+    // keyed indices is stable
+    template <class Key>
+    struct keyed_index
+    {
+        Key    m_key;
+        size_t m_index;
+
+        bool operator < (const keyed_index & a_other) const
+        {
+            return (m_key < a_other.m_key) || (!(a_other.m_key < m_key) && (m_index < a_other.m_index));
+        }
+
+        bool operator > (const keyed_index & a_other) const
+        {
+            return a_other < *this;
+        }
+    };
+
+    // order keys by sorting keyed indices
+
+    template <class Key, class Sequence>
+    void sort_order_keys(Sequence a_keys, size_t n, size_t * a_order, std::false_type)
+    {
+        std::vector< keyed_index<Key> > keyed(n);
+
+        for (size_t i = 0; i < n; ++i)
+        {
+            keyed[i].m_key   = a_keys[i];
+            keyed[i].m_index = i;
+        }
+
+        if (n > 0)
+            quick_sort(&keyed[0],n);
+
+        for (size_t i = 0; i < n; ++i)
+            a_order[i] = keyed[i].m_index;
+    }
+
+    // order keys by radix sorting a contiguous copy of
+    // them, carrying the indices along as payload
+
+    template <class Key, class Sequence>
+    void sort_order_keys(Sequence a_keys, size_t n, size_t * a_order, std::true_type)
+    {
+        if (n < RADIX_SORT_THRESHOLD)
+        {
+            sort_order_keys<Key>(a_keys,n,a_order,std::false_type());
+            return;
+        }
+
+        std::vector<Key> keys(n);
+
+        for (size_t i = 0; i < n; ++i)
+        {
+            keys[i]    = a_keys[i];
+            a_order[i] = i;
+        }
+
+        radix_sort_records(&keys[0],a_order,n);
+    }
+
+    //--------------------------------------------------
+    // Compute the stable ascending order of a sequence
+    // of keys: on return, a_order[0] is the position of
+    // the smallest key, and so on. Only the keys and
+    // their positions move while sorting, so this is
+    // the way to reorder several parallel sequences by
+    // one of them. Long sequences of radix-sortable keys
+    // are radix sorted, which orders -0.0 before +0.0.
+    template <class Key, class Sequence>
+    void sort_order(Sequence a_keys, size_t n, size_t * a_order)
+    {
+        sort_order_keys<Key>(a_keys,n,a_order,typename is_radix_sortable<Key>::type());
+    }
+
+    //--------------------------------------------------
+    // Compute the stable ascending order of an array:
+    // a_order[0] is the index of its smallest element,
+    // and so on. The array is not changed.
+    template <class T>
+    void argsort(const T * array, size_t n, size_t * a_order)
+    {
+        sort_order<T>(array,n,a_order);
+    }
+
+    //--------------------------------------------------
+    // Compute the stable ascending order of a view
+    template <class T>
+    void argsort(array_view<T> a_view, size_t * a_order)
+    {
+        typedef typename std::remove_const<T>::type value_type;
+
+        if (a_view.is_contiguous())
+            sort_order<value_type>(a_view.data(),a_view.size(),a_order);
+        else
+            sort_order<value_type>(a_view,a_view.size(),a_order);
+    }
+
+    //--------------------------------------------------
+    // Reorder a sequence in place so that its element i
+    // becomes the one that was at a_order[i], which must
+    // be a permutation of 0 to n - 1. Following each
+    // cycle of the permutation moves every element once,
+    // with one temporary per cycle and one bit of
+    // bookkeeping per element.
+    template <class T, class Sequence>
+    void apply_permutation_sequence(Sequence array, size_t n, const size_t * a_order)
+    {
+        std::vector<bool> placed(n,false);
+
+        for (size_t start = 0; start < n; ++start)
+        {
+            if (placed[start])
+                continue;
+
+            placed[start] = true;
+
+            if (a_order[start] == start)
+                continue;
+
+            T t(std::move(array[start]));
+            size_t hole = start;
+
+            while (a_order[hole] != start)
+            {
+                size_t next = a_order[hole];
+                array[hole] = std::move(array[next]);
+                placed[next] = true;
+                hole = next;
+            }
+
+            array[hole] = std::move(t);
+        }
+    }
+
+    //--------------------------------------------------
+    // Reorder an array in place by a permutation
+    template <class T>
+    void apply_permutation(T * array, size_t n, const size_t * a_order)
+    {
+        apply_permutation_sequence<T>(array,n,a_order);
+    }
+
+    //--------------------------------------------------
+    // Reorder the elements of a view in place by a
+    // permutation
+    template <class T>
+    void apply_permutation(array_view<T> a_view, const size_t * a_order)
+    {
+        if (a_view.is_contiguous())
+            apply_permutation_sequence<T>(a_view.data(),a_view.size(),a_order);
+        else
+            apply_permutation_sequence<T>(a_view,a_view.size(),a_order);
+    }
+
+    //--------------------------------------------------
+    // Stable sort of a sequence by a key projection:
+    // a_key(element) is called once per element, the
+    // keys are sorted in a contiguous array of their
+    // own, and then every element moves exactly once.
+    // Meant for large elements with small keys, such as
+    // a population sorted by fitness.
+    template <class T, class Sequence, class Projection>
+    void sort_by_key_sequence(Sequence array, size_t n, Projection a_key)
+    {
+        typedef typename std::decay<decltype(a_key(array[0]))>::type key_type;
+
+        if (n < 2)
+            return;
+
+        std::vector<key_type> keys;
+        keys.reserve(n);
+
+        for (size_t i = 0; i < n; ++i)
+            keys.push_back(a_key(array[i]));
+
+        std::vector<size_t> order(n);
+        sort_order<key_type>(&keys[0],n,&order[0]);
+        apply_permutation_sequence<T>(array,n,&order[0]);
+    }
+
+    //--------------------------------------------------
+    // Stable sort of an array by a key projection
+    template <class T, class Projection>
+    void sort_by_key(T * array, size_t n, Projection a_key)
+    {
+        sort_by_key_sequence<T>(array,n,a_key);
+    }
+
+    //--------------------------------------------------
+    // Stable sort of the elements of a view by a key
+    // projection
+    template <class T, class Projection>
+    void sort_by_key(array_view<T> a_view, Projection a_key)
+    {
+        if (a_view.is_contiguous())
+            sort_by_key_sequence<T>(a_view.data(),a_view.size(),a_key);
+        else
+            sort_by_key_sequence<T>(a_view,a_view.size(),a_key);
+    }
+
+    //--------------------------------------------------
+    // A tournament tree of losers over k players, each
+    // offering its current element (or NULL, once it has
+    // none left); the winner is the player with the
+    // smallest element, ties going to the lower player
+    // number, which makes merges through the tree
+    // stable. Replacing the winner's element replays one
+    // path of log2(k) matches from its leaf to the root.
+    // Elements are only referenced, never copied.
+    template <class T>
+    class loser_tree
+    {
+    public:
+        // a tree for a_players players, none holding an element
+        explicit loser_tree(size_t a_players)
+          : m_players(a_players),
+            m_tree(a_players > 0 ? a_players : 1,0),
+            m_elements(a_players,static_cast<const T *>(NULL))
+        {
+            // nada
+        }
+
+        // set a player's element before build
+        void set(size_t a_player, const T * a_element)
+        {
+            m_elements[a_player] = a_element;
+        }
+
+        // play the initial tournament
+        void build()
+        {
+            if (m_players == 0)
+                return;
+
+            // winners of each subtree; leaf p is node m_players + p
+            std::vector<size_t> winners(2 * m_players);
+
+            for (size_t p = 0; p < m_players; ++p)
+                winners[m_players + p] = p;
+
+            for (size_t node = m_players - 1; node > 0; --node)
+            {
+                size_t a = winners[2 * node];
+                size_t b = winners[2 * node + 1];
+
+                if (beats(a,b))
+                {
+                    winners[node] = a;
+                    m_tree[node]  = b;
+                }
+                else
+                {
+                    winners[node] = b;
+                    m_tree[node]  = a;
+                }
+            }
+
+            m_tree[0] = (m_players > 1) ? winners[1] : 0;
+        }
+
+        // the winning player
+        size_t winner() const
+        {
+            return m_tree[0];
+        }
+
+        // the winning element, or NULL when every player is out
+        const T * winner_element() const
+        {
+            return (m_players > 0) ? m_elements[m_tree[0]] : NULL;
+        }
+
+        // true when no player holds an element
+        bool empty() const
+        {
+            return winner_element() == NULL;
+        }
+
+        // give the winner its next element, or NULL if it has
+        // none, and find the new winner
+        void replace(const T * a_element)
+        {
+            size_t winner = m_tree[0];
+            m_elements[winner] = a_element;
+
+            for (size_t node = (winner + m_players) / 2; node > 0; node /= 2)
+            {
+                if (beats(m_tree[node],winner))
+                    std::swap(m_tree[node],winner);
+            }
+
+            m_tree[0] = winner;
+        }
+
+    private:
+        // true if player a wins a match against player b
+        bool beats(size_t a, size_t b) const
+        {
+            const T * x = m_elements[a];
+            const T * y = m_elements[b];
+
+            if (x == NULL)
+                return false;
+
+            if (y == NULL)
+                return true;
+
+            if (*x < *y)
+                return true;
+
+            if (*y < *x)
+                return false;
+
+            return a < b;
+        }
+
+        size_t                  m_players;
+        std::vector<size_t>     m_tree;
+        std::vector<const T *>  m_elements;
+    };
+
+    //--------------------------------------------------
+    // K-way merges of up to KWAY_MERGE_SCAN inputs with
+    // branch-free comparisons scan the inputs' current
+    // elements for the smallest, instead of replaying a
+    // loser tree
+
+    const size_t KWAY_MERGE_SCAN = 8;
+
+    //--------------------------------------------------
+    // merge through a loser tree
+
+    template <class T>
+    void kway_merge_tree(const array_view<const T> * a_inputs, size_t k, T * a_output)
+    {
+        loser_tree<T> tree(k);
+        std::vector<size_t> position(k,0);
+
+        for (size_t p = 0; p < k; ++p)
+            tree.set(p,a_inputs[p].empty() ? NULL : &a_inputs[p][0]);
+
+        tree.build();
+
+        while (!tree.empty())
+        {
+            size_t p = tree.winner();
+            *a_output++ = *tree.winner_element();
+
+            size_t next = ++position[p];
+            tree.replace((next < a_inputs[p].size()) ? &a_inputs[p][next] : NULL);
+        }
+    }
+
+    //--------------------------------------------------
+    // merge at most KWAY_MERGE_SCAN inputs by scanning
+    // copies of their current elements; the selection
+    // compiles to conditional moves. Exhausted inputs
+    // are removed, keeping the rest in order, so ties
+    // still go to the lowest-numbered input.
+
+    template <class T>
+    void kway_merge_scan(const array_view<const T> * a_inputs, size_t k, T * a_output)
+    {
+        T         head[KWAY_MERGE_SCAN];
+        const T * next[KWAY_MERGE_SCAN];
+        ptrdiff_t stride[KWAY_MERGE_SCAN];
+        size_t    left[KWAY_MERGE_SCAN];
+        size_t    active = 0;
+
+        for (size_t p = 0; p < k; ++p)
+        {
+            if (!a_inputs[p].empty())
+            {
+                next[active]   = a_inputs[p].data();
+                head[active]   = *next[active];
+                stride[active] = a_inputs[p].stride();
+                left[active]   = a_inputs[p].size();
+                ++active;
+            }
+        }
+
+        while (active > 1)
+        {
+            size_t best = 0;
+
+            for (size_t p = 1; p < active; ++p)
+                best = (head[p] < head[best]) ? p : best;
+
+            *a_output++ = head[best];
+
+            if (--left[best] > 0)
+            {
+                next[best] += stride[best];
+                head[best]  = *next[best];
+            }
+            else
+            {
+                --active;
+
+                for (size_t p = best; p < active; ++p)
+                {
+                    head[p]   = head[p + 1];
+                    next[p]   = next[p + 1];
+                    stride[p] = stride[p + 1];
+                    left[p]   = left[p + 1];
+                }
+            }
+        }
+
+        // the last input is copied
+        if (active == 1)
+        {
+            for (size_t i = 0; i < left[0]; ++i, next[0] += stride[0])
+                *a_output++ = *next[0];
+        }
+    }
+
+    //--------------------------------------------------
+    // merge on one thread, choosing the scan for a few
+    // inputs with branch-free comparisons
+
+    template <class T>
+    void kway_merge_serial(const array_view<const T> * a_inputs, size_t k, T * a_output, std::true_type)
+    {
+        if (k <= KWAY_MERGE_SCAN)
+            kway_merge_scan(a_inputs,k,a_output);
+        else
+            kway_merge_tree(a_inputs,k,a_output);
+    }
+
+    template <class T>
+    void kway_merge_serial(const array_view<const T> * a_inputs, size_t k, T * a_output, std::false_type)
+    {
+        kway_merge_tree(a_inputs,k,a_output);
+    }
+
+    //--------------------------------------------------
+    // Co-ranking: find how many elements of each input
+    // precede position a_rank of the stable merge of k
+    // sorted inputs, storing the counts in a_counts.
+    // Each input's count lies in a range, initially the
+    // whole input; the middle element of the widest range
+    // is ranked against all inputs (with binary searches
+    // limited to their ranges) and every range narrows to
+    // one side of it, until all are empty.
+    template <class T>
+    void kway_co_rank(const array_view<const T> * a_inputs, size_t k, size_t a_rank, size_t * a_counts)
+    {
+        std::vector<size_t> lo(k,0);
+        std::vector<size_t> hi(k);
+        std::vector<size_t> count(k);
+
+        for (size_t q = 0; q < k; ++q)
+            hi[q] = a_inputs[q].size();
+
+        while (k > 0)
+        {
+            size_t p = 0;
+
+            for (size_t q = 1; q < k; ++q)
+            {
+                if (hi[q] - lo[q] > hi[p] - lo[p])
+                    p = q;
+            }
+
+            if (hi[p] == lo[p])
+                break;
+
+            size_t    m = lo[p] + (hi[p] - lo[p]) / 2;
+            const T & x = a_inputs[p][m];
+            size_t rank = 0;
+
+            // equal elements of earlier inputs precede x, and those
+            // of later inputs follow it
+            for (size_t q = 0; q < k; ++q)
+            {
+                if (q == p)
+                    count[q] = m;
+                else
+                    count[q] = lo[q] + tim_sort_gallop(x,a_inputs[q],lo[q],hi[q] - lo[q],q < p,false);
+
+                rank += count[q];
+            }
+
+            if (rank < a_rank)
+            {
+                lo = count;
+                lo[p] = m + 1;
+            }
+            else
+            {
+                hi = count;
+                hi[p] = m;
+            }
+        }
+
+        for (size_t q = 0; q < k; ++q)
+            a_counts[q] = lo[q];
+    }
+
+    //--------------------------------------------------
+    // shared state of a parallel k-way merge
+
+    template <class T>
+    struct kway_merge_state
+    {
+        const array_view<const T> * m_inputs;
+        size_t                      m_count;
+        T *                         m_output;
+
+        // co-ranks of each part's first element, one row of
+        // m_count per part plus one for the end
+        std::vector<size_t>         m_splits;
+
+        // each part's first output position
+        std::vector<size_t>         m_starts;
+    };
+
+    //--------------------------------------------------
+    // merge part t of a parallel k-way merge
+
+    template <class T>
+    void kway_merge_part(kway_merge_state<T> * s, size_t t)
+    {
+        size_t k = s->m_count;
+        std::vector< array_view<const T> > parts(k);
+
+        for (size_t q = 0; q < k; ++q)
+        {
+            size_t first = s->m_splits[t * k + q];
+            parts[q] = s->m_inputs[q].subview(first,s->m_splits[(t + 1) * k + q] - first);
+        }
+
+        kway_merge_serial(&parts[0],k,s->m_output + s->m_starts[t],typename is_block_partitionable<T>::type());
+    }
+
+    //--------------------------------------------------
+    // Merge k sorted views into a_output, which must hold
+    // their combined length. Stable: equal elements keep
+    // their order within an input, and come from lower-
+    // numbered inputs first. Few inputs of arithmetic
+    // type are merged by a branch-free scan, more by a
+    // loser tree. As with parallel_sort, a_threads of 0
+    // means one per core; co-ranking splits the output
+    // into equal parts, which threads merge independently.
+    template <class T>
+    void kway_merge(const array_view<const T> * a_inputs, size_t k, T * a_output, size_t a_threads = 0)
+    {
+        size_t n = 0;
+
+        for (size_t q = 0; q < k; ++q)
+            n += a_inputs[q].size();
+
+        size_t threads = parallel_sort_threads(n,a_threads);
+
+        if (threads < 2)
+        {
+            kway_merge_serial(a_inputs,k,a_output,typename is_block_partitionable<T>::type());
+            return;
+        }
+
+        kway_merge_state<T> s;
+        s.m_inputs = a_inputs;
+        s.m_count  = k;
+        s.m_output = a_output;
+        s.m_splits.resize((threads + 1) * k);
+        s.m_starts.resize(threads + 1);
+
+        for (size_t t = 0; t <= threads; ++t)
+        {
+            s.m_starts[t] = (n / threads) * t + min_of(t,n % threads);
+            kway_co_rank(a_inputs,k,s.m_starts[t],&s.m_splits[t * k]);
+        }
+
+        std::vector<std::thread> workers;
+
+        for (size_t t = 1; t < threads; ++t)
+            workers.push_back(std::thread(kway_merge_part<T>,&s,t));
+
+        kway_merge_part(&s,0);
+
+        for (size_t i = 0; i < workers.size(); ++i)
+            workers[i].join();
+    }
+
 } // end namespace libcoyotl
 
 #endif
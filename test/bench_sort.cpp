@@ -0,0 +1,552 @@
+#include "../libcoyotl/sortutil.h"
+#include "../libcoyotl/mtwister.h"
+#include "../libcoyotl/command_line.h"
+using namespace libcoyotl;
+
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <algorithm>
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+using namespace std;
+
+// usage: bench_sort [-n max_size] [-m min_size] [-r repeats] [-b memory_MiB]
+//                   [-s seed] [-t type,...] [-d distribution,...]
+//                   [-f csv|json] [-o file] [algorithm ...]
+//
+// times the sorting algorithms (all of them by default) on sizes growing by
+// powers of ten from min_size to max_size, for every element type and input
+// distribution selected; each result is the fastest of "repeats" timings.
+// Every output is compared with std::stable_sort's: by key for every
+// algorithm, and by key and payload for the stable ones, so lost, duplicated
+// or reordered elements are caught. The exit status is 1 if any sort failed.
+
+//--------------------------------------------------------------------------
+// element types; records define > as well as <, for shell_sort
+
+// an integer key with an equally large payload
+struct keyed_record
+{
+    uint64_t m_key;
+    uint64_t m_payload;
+
+    bool operator < (const keyed_record & a_other) const
+    {
+        return m_key < a_other.m_key;
+    }
+
+    bool operator > (const keyed_record & a_other) const
+    {
+        return m_key > a_other.m_key;
+    }
+};
+
+// a key at the head of a 128-byte record
+struct large_record
+{
+    uint32_t m_key;
+    uint32_t m_payload[31];
+
+    bool operator < (const large_record & a_other) const
+    {
+        return m_key < a_other.m_key;
+    }
+
+    bool operator > (const large_record & a_other) const
+    {
+        return m_key > a_other.m_key;
+    }
+};
+
+// convert a 32-bit key to an element, preserving the order of keys
+inline void make_element(int32_t & a_element, uint32_t a_key, size_t)
+{
+    a_element = int32_t(a_key ^ 0x80000000UL);
+}
+
+inline void make_element(double & a_element, uint32_t a_key, size_t)
+{
+    a_element = double(a_key) * 0.001 - 1000000.0;
+}
+
+inline void make_element(keyed_record & a_element, uint32_t a_key, size_t a_index)
+{
+    a_element.m_key     = (uint64_t(a_key) << 32) | (a_key >> 7);
+    a_element.m_payload = a_index;
+}
+
+inline void make_element(large_record & a_element, uint32_t a_key, size_t a_index)
+{
+    a_element.m_key = a_key;
+
+    for (size_t i = 0; i < 31; ++i)
+        a_element.m_payload[i] = uint32_t(a_index + i);
+}
+
+// compare elements by key only
+template <class T>
+inline bool same_key(const T & a_first, const T & a_second)
+{
+    return !(a_first < a_second) && !(a_second < a_first);
+}
+
+// compare whole elements, payloads included
+template <class T>
+inline bool same_element(const T & a_first, const T & a_second)
+{
+    return a_first == a_second;
+}
+
+inline bool same_element(const keyed_record & a_first, const keyed_record & a_second)
+{
+    return (a_first.m_key == a_second.m_key) && (a_first.m_payload == a_second.m_payload);
+}
+
+inline bool same_element(const large_record & a_first, const large_record & a_second)
+{
+    return (a_first.m_key == a_second.m_key)
+        && (memcmp(a_first.m_payload,a_second.m_payload,sizeof(a_first.m_payload)) == 0);
+}
+
+//--------------------------------------------------------------------------
+// input distributions
+
+enum distribution
+{
+    DIST_RANDOM,
+    DIST_SORTED,
+    DIST_REVERSED,
+    DIST_ORGAN_PIPE,
+    DIST_DUPLICATES,
+    DIST_NEARLY_SORTED
+};
+
+static const char * DIST_NAMES[] =
+{
+    "random",
+    "sorted",
+    "reversed",
+    "organ_pipe",
+    "duplicates",
+    "nearly_sorted"
+};
+
+static const size_t NUM_DISTS = sizeof(DIST_NAMES) / sizeof(DIST_NAMES[0]);
+
+// number of distinct keys in the "duplicates" distribution
+static const uint32_t DUPLICATE_KEYS = 16;
+
+// generate n keys with the given distribution
+static void make_keys(vector<uint32_t> & a_keys, size_t n, distribution a_dist, prng & a_rng)
+{
+    a_keys.resize(n);
+
+    for (size_t i = 0; i < n; ++i)
+        a_keys[i] = a_rng.get_rand();
+
+    switch (a_dist)
+    {
+    case DIST_SORTED:
+        sort(a_keys.begin(),a_keys.end());
+        break;
+    case DIST_REVERSED:
+        sort(a_keys.begin(),a_keys.end());
+        reverse(a_keys.begin(),a_keys.end());
+        break;
+    case DIST_ORGAN_PIPE:
+        // ascending to the middle, then descending
+        sort(a_keys.begin(),a_keys.begin() + n / 2);
+        sort(a_keys.begin() + n / 2,a_keys.end());
+        reverse(a_keys.begin() + n / 2,a_keys.end());
+        break;
+    case DIST_DUPLICATES:
+        for (size_t i = 0; i < n; ++i)
+            a_keys[i] %= DUPLICATE_KEYS;
+        break;
+    case DIST_NEARLY_SORTED:
+        // one percent of the elements swapped at random
+        sort(a_keys.begin(),a_keys.end());
+
+        if (n > 1)
+        {
+            for (size_t s = 0; s < n / 100 + 1; ++s)
+                swap(a_keys[a_rng.get_rand_index(n)],a_keys[a_rng.get_rand_index(n)]);
+        }
+
+        break;
+    default:
+        break;
+    }
+}
+
+//--------------------------------------------------------------------------
+// algorithms
+
+template <class T>
+struct algorithm_entry
+{
+    const char * m_name;
+    void (* m_sort)(T * a_array, size_t n);
+
+    // largest size tried, to keep slow algorithms from dominating a run
+    size_t m_max_size;
+
+    // equal keys keep their order, so payloads are verified too
+    bool m_stable;
+};
+
+template <class T> void run_shell_sort(T * a, size_t n)       { shell_sort(a,n); }
+template <class T> void run_quick_sort(T * a, size_t n)       { quick_sort(a,n); }
+template <class T> void run_merge_sort(T * a, size_t n)       { merge_sort(a,n); }
+template <class T> void run_tim_sort(T * a, size_t n)         { tim_sort(a,n); }
+template <class T> void run_parallel_sort(T * a, size_t n)    { parallel_sort(a,n); }
+template <class T> void run_radix_sort(T * a, size_t n)       { radix_sort(a,n); }
+template <class T> void run_std_sort(T * a, size_t n)         { sort(a,a + n); }
+template <class T> void run_std_stable_sort(T * a, size_t n)  { stable_sort(a,a + n); }
+
+template <class T> uint64_t record_key(const T & a_record)    { return a_record.m_key; }
+template <class T> void run_sort_by_key(T * a, size_t n)      { sort_by_key(a,n,record_key<T>); }
+
+static const size_t UNLIMITED = ~size_t(0);
+static const size_t SHELL_SORT_LIMIT = 10000000;
+
+// algorithms for every element type
+template <class T>
+static void common_algorithms(vector< algorithm_entry<T> > & a_table)
+{
+    algorithm_entry<T> entries[] =
+    {
+        { "shell_sort",      run_shell_sort<T>,      SHELL_SORT_LIMIT, false },
+        { "quick_sort",      run_quick_sort<T>,      UNLIMITED,        false },
+        { "merge_sort",      run_merge_sort<T>,      UNLIMITED,        true  },
+        { "tim_sort",        run_tim_sort<T>,        UNLIMITED,        true  },
+        { "parallel_sort",   run_parallel_sort<T>,   UNLIMITED,        false },
+        { "std::sort",       run_std_sort<T>,        UNLIMITED,        false },
+        { "std::stable_sort",run_std_stable_sort<T>, UNLIMITED,        true  }
+    };
+
+    a_table.assign(entries,entries + sizeof(entries) / sizeof(entries[0]));
+}
+
+// arithmetic types add radix_sort, records add sort_by_key
+template <class T>
+static vector< algorithm_entry<T> > algorithms(std::true_type)
+{
+    vector< algorithm_entry<T> > table;
+    common_algorithms(table);
+
+    algorithm_entry<T> radix = { "radix_sort", run_radix_sort<T>, UNLIMITED, true };
+    table.push_back(radix);
+    return table;
+}
+
+template <class T>
+static vector< algorithm_entry<T> > algorithms(std::false_type)
+{
+    vector< algorithm_entry<T> > table;
+    common_algorithms(table);
+
+    algorithm_entry<T> by_key = { "sort_by_key", run_sort_by_key<T>, UNLIMITED, true };
+    table.push_back(by_key);
+    return table;
+}
+
+//--------------------------------------------------------------------------
+// benchmark settings and output
+
+struct bench_settings
+{
+    size_t           m_min_size;
+    size_t           m_max_size;
+    size_t           m_repeats;
+    size_t           m_memory;
+    uint32_t         m_seed;
+    set<string>      m_algorithms;
+    set<string>      m_types;
+    set<string>      m_dists;
+    bool             m_json;
+};
+
+struct bench_output
+{
+    ostream * m_stream;
+    bool      m_json;
+    size_t    m_records;
+    size_t    m_failures;
+};
+
+static void write_header(bench_output & a_out)
+{
+    if (a_out.m_json)
+        *a_out.m_stream << "[";
+    else
+        *a_out.m_stream << "algorithm,type,distribution,size,seconds,ns_per_element,verified" << endl;
+}
+
+static void write_result(bench_output & a_out, const char * a_algorithm, const char * a_type,
+                         const char * a_dist, size_t n, double a_seconds, bool a_verified)
+{
+    ostream & out = *a_out.m_stream;
+    double per_element = a_seconds * 1.0e9 / double(n);
+
+    if (a_out.m_json)
+    {
+        out << ((a_out.m_records == 0) ? "\n" : ",\n")
+            << "  {\"algorithm\": \"" << a_algorithm
+            << "\", \"type\": \"" << a_type
+            << "\", \"distribution\": \"" << a_dist
+            << "\", \"size\": " << n
+            << ", \"seconds\": " << setprecision(9) << a_seconds
+            << ", \"ns_per_element\": " << setprecision(3) << per_element
+            << ", \"verified\": " << (a_verified ? "true" : "false") << "}";
+    }
+    else
+    {
+        out << a_algorithm << "," << a_type << "," << a_dist << "," << n << ","
+            << setprecision(9) << a_seconds << ","
+            << setprecision(3) << per_element << ","
+            << (a_verified ? 1 : 0) << endl;
+    }
+
+    out.flush();
+    ++a_out.m_records;
+
+    if (!a_verified)
+        ++a_out.m_failures;
+}
+
+static void write_footer(bench_output & a_out)
+{
+    if (a_out.m_json)
+        *a_out.m_stream << "\n]" << endl;
+}
+
+static bool selected(const set<string> & a_names, const char * a_name)
+{
+    return a_names.empty() || (a_names.find(a_name) != a_names.end());
+}
+
+// compare a sorted array with the expected result
+template <class T>
+static bool matches(const T * a_sorted, const vector<T> & a_expected, bool a_stable)
+{
+    for (size_t i = 0; i < a_expected.size(); ++i)
+    {
+        if (a_stable ? !same_element(a_sorted[i],a_expected[i]) : !same_key(a_sorted[i],a_expected[i]))
+            return false;
+    }
+
+    return true;
+}
+
+static double elapsed(const struct timespec & a_start, const struct timespec & a_stop)
+{
+    return (a_stop.tv_sec - a_start.tv_sec) + (double)(a_stop.tv_nsec - a_start.tv_nsec) / 1000000000.0;
+}
+
+//--------------------------------------------------------------------------
+// benchmark one element type
+
+// sizes below this are sorted in batches of copies, so that a timing
+// covers enough work to exceed the clock's resolution
+static const size_t BATCH_ELEMENTS = 1 << 16;
+
+template <class T>
+static void bench_type(const char * a_type, const bench_settings & a_settings, bench_output & a_out)
+{
+    if (!selected(a_settings.m_types,a_type))
+        return;
+
+    vector< algorithm_entry<T> > table = algorithms<T>(typename std::is_arithmetic<T>::type());
+    vector<uint32_t> keys;
+    vector<T> input, expected, work;
+
+    for (size_t d = 0; d < NUM_DISTS; ++d)
+    {
+        if (!selected(a_settings.m_dists,DIST_NAMES[d]))
+            continue;
+
+        for (size_t n = a_settings.m_min_size; n <= a_settings.m_max_size; n *= 10)
+        {
+            // input, expected result, working copies and an algorithm's
+            // buffer must fit
+            if (n * sizeof(T) * 4 > a_settings.m_memory)
+            {
+                cerr << "skipping " << a_type << " size " << n << ": exceeds memory limit" << endl;
+                break;
+            }
+
+            // every algorithm sees the same input
+            mtwister rng(a_settings.m_seed + uint32_t(n) + uint32_t(d));
+            make_keys(keys,n,distribution(d),rng);
+
+            input.resize(n);
+
+            for (size_t i = 0; i < n; ++i)
+                make_element(input[i],keys[i],i);
+
+            expected = input;
+            stable_sort(expected.begin(),expected.end());
+
+            size_t batch = (n < BATCH_ELEMENTS) ? BATCH_ELEMENTS / n : 1;
+            work.resize(batch * n);
+
+            for (size_t a = 0; a < table.size(); ++a)
+            {
+                if (!selected(a_settings.m_algorithms,table[a].m_name) || (n > table[a].m_max_size))
+                    continue;
+
+                double best = 0.0;
+                bool verified = true;
+
+                for (size_t r = 0; r < a_settings.m_repeats; ++r)
+                {
+                    for (size_t b = 0; b < batch; ++b)
+                        copy(input.begin(),input.end(),work.begin() + b * n);
+
+                    struct timespec start, stop;
+                    clock_gettime(CLOCK_MONOTONIC,&start);
+
+                    for (size_t b = 0; b < batch; ++b)
+                        table[a].m_sort(&work[b * n],n);
+
+                    clock_gettime(CLOCK_MONOTONIC,&stop);
+
+                    double seconds = elapsed(start,stop) / double(batch);
+
+                    if ((r == 0) || (seconds < best))
+                        best = seconds;
+
+                    for (size_t b = 0; b < batch; ++b)
+                        verified = verified && matches(&work[b * n],expected,table[a].m_stable);
+                }
+
+                write_result(a_out,table[a].m_name,a_type,DIST_NAMES[d],n,best,verified);
+            }
+
+            // stop before overflowing the size
+            if (n > a_settings.m_max_size / 10)
+                break;
+        }
+    }
+}
+
+//--------------------------------------------------------------------------
+// split a comma-separated list into a set of names
+
+static void split_names(const string & a_list, set<string> & a_names)
+{
+    size_t start = 0;
+
+    while (start <= a_list.size())
+    {
+        size_t comma = a_list.find(',',start);
+
+        if (comma == string::npos)
+            comma = a_list.size();
+
+        if (comma > start)
+            a_names.insert(a_list.substr(start,comma - start));
+
+        start = comma + 1;
+    }
+}
+
+int main(int argc, char * argv[])
+{
+    bench_settings settings;
+    settings.m_min_size = 10;
+    settings.m_max_size = 1000000;
+    settings.m_repeats  = 3;
+    settings.m_memory   = size_t(4096) << 20;
+    settings.m_seed     = 19650218UL;
+    settings.m_json     = false;
+
+    string output_name;
+
+    set<string> bool_opts;
+    command_line args(argc,argv,bool_opts);
+
+    for (size_t i = 0; i < args.get_options().size(); ++i)
+    {
+        const command_line::option & opt = args.get_options()[i];
+
+        if (opt.m_name == "n")
+            settings.m_max_size = size_t(strtod(opt.m_value.c_str(),NULL));
+        else if (opt.m_name == "m")
+            settings.m_min_size = size_t(strtod(opt.m_value.c_str(),NULL));
+        else if (opt.m_name == "r")
+            settings.m_repeats = size_t(strtoul(opt.m_value.c_str(),NULL,10));
+        else if (opt.m_name == "b")
+            settings.m_memory = size_t(strtoul(opt.m_value.c_str(),NULL,10)) << 20;
+        else if (opt.m_name == "s")
+            settings.m_seed = uint32_t(strtoul(opt.m_value.c_str(),NULL,10));
+        else if (opt.m_name == "t")
+            split_names(opt.m_value,settings.m_types);
+        else if (opt.m_name == "d")
+            split_names(opt.m_value,settings.m_dists);
+        else if (opt.m_name == "o")
+            output_name = opt.m_value;
+        else if (opt.m_name == "f")
+        {
+            if (opt.m_value == "json")
+                settings.m_json = true;
+            else if (opt.m_value != "csv")
+            {
+                cerr << "unknown format " << opt.m_value << endl;
+                return 2;
+            }
+        }
+        else
+        {
+            cerr << "unknown option -" << opt.m_name << endl;
+            return 2;
+        }
+    }
+
+    if ((settings.m_min_size == 0) || (settings.m_repeats == 0))
+    {
+        cerr << "sizes and repeats must be positive" << endl;
+        return 2;
+    }
+
+    for (size_t i = 0; i < args.get_inputs().size(); ++i)
+        settings.m_algorithms.insert(args.get_inputs()[i]);
+
+    ofstream file;
+    bench_output out;
+    out.m_stream   = &cout;
+    out.m_json     = settings.m_json;
+    out.m_records  = 0;
+    out.m_failures = 0;
+
+    if (!output_name.empty())
+    {
+        file.open(output_name.c_str());
+
+        if (!file)
+        {
+            cerr << "cannot open " << output_name << endl;
+            return 2;
+        }
+
+        out.m_stream = &file;
+    }
+
+    out.m_stream->setf(ios::fixed);
+
+    write_header(out);
+    bench_type<int32_t>("int",settings,out);
+    bench_type<double>("double",settings,out);
+    bench_type<keyed_record>("keyed_record",settings,out);
+    bench_type<large_record>("large_record",settings,out);
+    write_footer(out);
+
+    if (out.m_failures > 0)
+        cerr << out.m_failures << " sorts produced wrong output" << endl;
+
+    return (out.m_failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,143 @@
+#include "../libcoyotl/mtwister.h"
+#include "../libcoyotl/mwc1038.h"
+#include "../libcoyotl/kissrng.h"
+#include "../libcoyotl/mwc256.h"
+#include "../libcoyotl/cmwc4096.h"
+#include "../libcoyotl/prng_quality.h"
+#include "../libcoyotl/command_line.h"
+#include "../libcoyotl/cpu_features.h"
+using namespace libcoyotl;
+
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <ctime>
+using namespace std;
+
+// usage: prng_quality [-n samples] [-t threads] [-s seed] [generator ...]
+//
+// runs the statistical battery on the named generators (all of them by
+// default); each test consumes "samples" 32-bit values
+
+struct generator_entry
+{
+    const char *          m_name;
+    prng_battery::factory m_factory;
+};
+
+static const generator_entry GENERATORS[] =
+{
+    { "mtwister", create_prng<mtwister> },
+    { "mwc1038",  create_prng<mwc1038>  },
+    { "kissrng",  create_prng<kissrng>  },
+    { "mwc256",   create_prng<mwc256>   },
+    { "cmwc4096", create_prng<cmwc4096> }
+};
+
+static const size_t NUM_GENERATORS = sizeof(GENERATORS) / sizeof(GENERATORS[0]);
+
+static const size_t DEFAULT_SAMPLES = 1 << 24;
+
+// smallest sample count giving every chi-square category an expected
+// count of at least five; the birthday spacings test sets the bound,
+// with one observation per 512 values and a rarest category of 1.7%
+static const size_t MIN_SAMPLES = 1 << 18;
+
+int main(int argc, char * argv[])
+{
+    size_t   samples = DEFAULT_SAMPLES;
+    size_t   threads = 0;
+    uint32_t seed    = 19650218UL;
+
+    set<string> bool_opts;
+    command_line args(argc,argv,bool_opts);
+
+    for (size_t i = 0; i < args.get_options().size(); ++i)
+    {
+        const command_line::option & opt = args.get_options()[i];
+
+        if (opt.m_name == "n")
+            samples = size_t(strtoul(opt.m_value.c_str(),NULL,10));
+        else if (opt.m_name == "t")
+            threads = size_t(strtoul(opt.m_value.c_str(),NULL,10));
+        else if (opt.m_name == "s")
+            seed = uint32_t(strtoul(opt.m_value.c_str(),NULL,10));
+        else
+        {
+            cerr << "unknown option -" << opt.m_name << endl;
+            return 2;
+        }
+    }
+
+    if (samples < MIN_SAMPLES)
+    {
+        cerr << "samples must be at least " << MIN_SAMPLES << endl;
+        return 2;
+    }
+
+    vector<const generator_entry *> selected;
+
+    for (size_t i = 0; i < args.get_inputs().size(); ++i)
+    {
+        size_t g;
+
+        for (g = 0; g < NUM_GENERATORS; ++g)
+        {
+            if (args.get_inputs()[i] == GENERATORS[g].m_name)
+                break;
+        }
+
+        if (g == NUM_GENERATORS)
+        {
+            cerr << "unknown generator " << args.get_inputs()[i] << endl;
+            return 2;
+        }
+
+        selected.push_back(&GENERATORS[g]);
+    }
+
+    if (selected.empty())
+    {
+        for (size_t g = 0; g < NUM_GENERATORS; ++g)
+            selected.push_back(&GENERATORS[g]);
+    }
+
+    int failures = 0;
+
+    cout.setf(ios::showpoint | ios::fixed);
+    cout << "vector level: " << cpu_features::level_name(cpu_features::get().get_level()) << endl;
+
+    for (size_t i = 0; i < selected.size(); ++i)
+    {
+        prng_battery battery(selected[i]->m_factory,samples,seed,threads);
+
+        cout << "\n" << selected[i]->m_name << " (" << samples << " values per test, "
+             << battery.get_threads() << " threads)" << endl;
+
+        // get starting time
+        struct timespec start, stop;
+        clock_gettime(CLOCK_REALTIME,&start);
+
+        vector<prng_test_result> results = battery.run();
+
+        clock_gettime(CLOCK_REALTIME,&stop);
+
+        for (size_t r = 0; r < results.size(); ++r)
+        {
+            cout << setw(20) << right << results[r].m_name
+                 << "  chi2 = " << setprecision(2) << setw(10) << results[r].m_chi_square
+                 << "  df = "   << setw(3) << results[r].m_degrees
+                 << "  p = "    << setprecision(6) << results[r].m_p_value
+                 << (results[r].passed() ? "" : "  ** FAIL **") << endl;
+
+            if (!results[r].passed())
+                ++failures;
+        }
+
+        cout << setprecision(2) << "   elapsed = "
+             << ((stop.tv_sec - start.tv_sec) + (double)(stop.tv_nsec - start.tv_nsec) / 1000000000.0)
+             << " seconds" << endl;
+    }
+
+    return (failures == 0) ? 0 : 1;
+}